@@ -8,6 +8,7 @@
 #include "../include/gpsd_config.h"   // must be before all includes
 
 #include <assert.h>
+#include <ctype.h>
 #include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -25,6 +26,28 @@
 static char *control_socket = DEFAULT_GPSD_SOCKET;
 static char *gpsd_options = "";
 
+/* true if udev variable name is set, at most len characters, all of
+ * them hex digits, or, if !hex, printable and not space
+ */
+static bool udev_id(const char *name, size_t len, bool hex)
+{
+    const char *value = getenv(name);
+    size_t i;
+
+    if (NULL == value ||
+        '\0' == value[0]) {
+        return false;
+    }
+    for (i = 0; '\0' != value[i]; i++) {
+        if (len <= i ||
+            (hex && !isxdigit((unsigned char)value[i])) ||
+            !isgraph((unsigned char)value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // pass a command to gpsd; start the daemon if not already running
 static int gpsd_control(const char *action, const char *argument)
 {
@@ -76,7 +99,18 @@ static int gpsd_control(const char *action, const char *argument)
         if (1 != stat(argument, &sb)) {
             (void)chmod(argument, sb.st_mode | S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP);
         }
-        len = snprintf(buf, sizeof(buf), "+%s\r\n", argument);
+        if (udev_id("ID_VENDOR_ID", 4, true) &&
+            udev_id("ID_MODEL_ID", 4, true)) {
+            /* when udev runs us, say what the device is, so gpsd can
+             * skip the hunt.  Older gpsd ignores it. */
+            len = snprintf(buf, sizeof(buf), "+%s %s:%s%s%s\r\n", argument,
+                           getenv("ID_VENDOR_ID"), getenv("ID_MODEL_ID"),
+                           udev_id("ID_SERIAL_SHORT", 64, false) ? ":" : "",
+                           udev_id("ID_SERIAL_SHORT", 64, false) ?
+                               getenv("ID_SERIAL_SHORT") : "");
+        } else {
+            len = snprintf(buf, sizeof(buf), "+%s\r\n", argument);
+        }
         if (3 < len) {
             status = (int)write(connect, buf, len);
             // FIXME: return never checked
@@ -26,6 +26,7 @@ static bool json = true;
 static bool pseudonmea = false;
 static bool split24 = false;
 static bool minlength = false;
+static bool lexstats = false;
 static unsigned int ntypes = 0;
 static unsigned int typelist[32];
 static struct gps_context_t context;
@@ -695,10 +696,18 @@ static void decode(FILE *fpin, FILE *fpout)
             }
         }
     }
+    if (lexstats) {
+        char sbuf[BUFSIZ];
+
+        (void)fprintf(fpout, "%s\n",
+                      packet_stats_dump(&session.lexer, sbuf, sizeof(sbuf)));
+    }
 }
 
 #ifdef SOCKET_EXPORT_ENABLE
-// JSON format on fpin to JSON on fpout - idempotency test
+/* JSON format on fpin to JSON on fpout - idempotency test
+ * With -n, AIS JSON on fpin to AIVDM on fpout, in bulk - test feeds.
+ */
 static void encode(FILE *fpin, FILE *fpout)
 {
     char inbuf[BUFSIZ];
@@ -719,6 +728,10 @@ static void encode(FILE *fpin, FILE *fpout)
     /* Parsing is always made in unscaled mode,
      * this policy applies to the dumping */
     policy.scaled = scaled;
+    if (pseudonmea) {
+        // generated feeds run to millions of lines, write in big blocks
+        (void)setvbuf(fpout, NULL, _IOFBF, 1 << 16);
+    }
 
     while (NULL != fgets(inbuf, (int)sizeof(inbuf), fpin)) {
         int status;
@@ -734,6 +747,18 @@ static void encode(FILE *fpin, FILE *fpout)
                           status, json_error_string(status), lineno);
             exit(EXIT_FAILURE);
         }
+        if (pseudonmea) {
+#ifdef AIVDM_ENABLE
+            // only AIS has a faithful NMEA form, skip everything else
+            if (0 != (session.gpsdata.set & AIS_SET)) {
+                nmea_ais_dump(&session, inbuf, sizeof(inbuf));
+                (void)fputs(inbuf, fpout);
+            }
+#endif  // AIVDM_ENABLE
+            // so a line of another class does not repeat the last AIS
+            session.gpsdata.set = 0;
+            continue;
+        }
         json_data_report(session.gpsdata.set, &session, &policy,
                          inbuf, sizeof(inbuf));
         (void)fputs(inbuf, fpout);
@@ -753,9 +778,10 @@ static void usage(void)
           "  --ais              AIS dump format with an ASCII pipe separator.\n"
           "  --debug DEBUG      Set debug level.\n"
           "  --decode           Decode\n"
-          "  --encode           Encode\n"
+          "  --encode           Encode JSON, to AIVDM with --nmea\n"
           "  --help             Show this help, then exit\n"
           "  --json             JSON.\n"
+          "  --lexer            Lexer counters at the end.\n"
           "  --minlength        Minimum length, no JSON.\n"
           "  --nmea             pseudo NMEA\n"
           "  --split24          split24\n"
@@ -768,9 +794,10 @@ static void usage(void)
           "  -c                 AIS dump format with an ASCII pipe separator.\n"
           "  -D DEBUG           Set debug level.\n"
           "  -d                 Decode \n"
-          "  -e                 Encode\n"
+          "  -e                 Encode JSON, to AIVDM with -n\n"
           "  -h                 Show this help, then exit\n"
           "  -j                 JSON.\n"
+          "  -l                 Lexer counters at the end.\n"
           "  -m                 Minimum length, no JSON\n"
           "  -n                 pseudo NMEA\n"
           "  -s                 split24 \n"
@@ -784,7 +811,7 @@ static void usage(void)
 
 int main(int argc, char **argv)
 {
-    const char *optstring = "?cdehjmnst:uvVD:";
+    const char *optstring = "?cdehjlmnst:uvVD:";
     enum { doencode, dodecode } mode = dodecode;
 #ifdef HAVE_GETOPT_LONG
     int option_index = 0;
@@ -794,6 +821,7 @@ int main(int argc, char **argv)
         {"encode", no_argument, NULL, 'e'},
         {"help", no_argument, NULL, 'h'},
         {"json", no_argument, NULL, 'j'},
+        {"lexer", no_argument, NULL, 'l'},
         {"minlength", no_argument, NULL, 'm'},
         {"nmea", no_argument, NULL, 'n'},
         {"nojson", no_argument, NULL, 'c'},
@@ -842,6 +870,10 @@ int main(int argc, char **argv)
             json = true;
             break;
 
+        case 'l':
+            lexstats = true;
+            break;
+
         case 'm':
             minlength = true;
             json = false;
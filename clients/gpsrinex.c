@@ -867,21 +867,24 @@ static void print_raw(struct gps_data_t *gpsdata)
      * record in RINEX
      */
 
-    // go through list three times, first just to get a count for sort
-    for (i = 0; i < MAXCHANNELS; i++) {
-        if (0 == gpsdata->raw.meas[i].svid) {
-            // bad svid, end of list
-            break;
-        }
-        nrec++;
+    nrec = gpsdata->raw.nmeas;
+    if (MAXCHANNELS < nrec) {
+        nrec = MAXCHANNELS;
     }
-
     if (0 == nrec) {
         // nothing to do
         return;
     }
-    qsort(gpsdata->raw.meas, nrec, sizeof(gpsdata->raw.meas[0]),
-          compare_meas);
+
+    // go through list three times, first to see if it needs a sort
+    for (i = 1; i < nrec; i++) {
+        if (0 < compare_meas(&gpsdata->raw.meas[i - 1],
+                             &gpsdata->raw.meas[i])) {
+            qsort(gpsdata->raw.meas, nrec, sizeof(gpsdata->raw.meas[0]),
+                  compare_meas);
+            break;
+        }
+    }
 
     // second just to get a count, needed for epoch header
     for (i = 0; i < nrec; i++) {
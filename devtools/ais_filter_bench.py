@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Benchmark server side AIS filtering in ?WATCH.
+
+Amplifies test/sample.aivdm into a large synthetic feed, each copy
+with the MMSIs shifted so the feed looks like a big fleet, then
+pushes it through gpsd on a pty twice: once with plain AIS watchers,
+once with watchers that send an AIS filter.  For each run it reports
+the CPU time gpsd used and how much each client received.
+
+Example:
+
+    devtools/ais_filter_bench.py --gpsd ./gpsd/gpsd -n 200 -c 4 \\
+        --filter '"aiscircle":[43.08,-70.76,20000]'
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import argparse
+import os
+import pty
+import select
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+ARMOR = '0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVW`abcdefghijklmnopqrstuvw'
+
+
+def nmea_checksum(body):
+    """XOR checksum of the text between ! and *."""
+    csum = 0
+    for char in body:
+        csum ^= ord(char)
+    return '%02X' % csum
+
+
+def shift_mmsi(sentence, shift):
+    """Return an AIVDM sentence with its MMSI moved by shift.
+
+    Only the first fragment carries the MMSI, others are returned as is.
+    """
+    body = sentence[1:sentence.index('*')]
+    fields = body.split(',')
+    if 7 > len(fields) or '1' != fields[2] or 7 > len(fields[5]):
+        return sentence
+    payload = fields[5]
+    bits = 0
+    for char in payload[:7]:
+        bits = (bits << 6) | ARMOR.index(char)
+    # 42 bits: 6 type, 2 repeat, 30 MMSI, 4 more
+    mmsi = (bits >> 4) & 0x3fffffff
+    mmsi = (mmsi + shift) % 1000000000
+    bits = (bits & ~(0x3fffffff << 4)) | (mmsi << 4)
+    head = ''.join(ARMOR[(bits >> (6 * (6 - i))) & 0x3f] for i in range(7))
+    fields[5] = head + payload[7:]
+    body = ','.join(fields)
+    return '!%s*%s' % (body, nmea_checksum(body))
+
+
+def amplify(path, copies):
+    """Read an AIVDM log and return copies of it, MMSIs shifted per copy."""
+    lines = []
+    with open(path) as logfile:
+        for line in logfile:
+            line = line.strip()
+            if line.startswith('!') and '*' in line:
+                lines.append(line)
+    feed = []
+    for copy in range(copies):
+        feed.extend(shift_mmsi(line, copy) for line in lines)
+    return feed
+
+
+def drain(sock, stats, stop):
+    """Count lines and bytes a client receives until stop is set."""
+    sock.setblocking(False)
+    while not stop.is_set():
+        ready, _, _ = select.select([sock], [], [], 0.2)
+        if not ready:
+            continue
+        try:
+            data = sock.recv(65536)
+        except BlockingIOError:
+            continue
+        if not data:
+            break
+        stats[0] += len(data)
+        stats[1] += data.count(b'"class":"AIS"')
+
+
+def run(options, feed, watch_extra):
+    """Run one pass, return (cpu_seconds, [(bytes, ais_msgs)...])."""
+    master, slave = pty.openpty()
+    gpsd = subprocess.Popen([options.gpsd, '-N', '-n', '-S',
+                             str(options.port), os.ttyname(slave)])
+    time.sleep(1)
+    stop = threading.Event()
+    threads = []
+    results = []
+    socks = []
+    for _ in range(options.clients):
+        sock = socket.create_connection(('127.0.0.1', options.port))
+        watch = '?WATCH={"enable":true,"json":true%s};\n' % watch_extra
+        sock.sendall(watch.encode('ascii'))
+        stats = [0, 0]
+        results.append(stats)
+        socks.append(sock)
+        thread = threading.Thread(target=drain, args=(sock, stats, stop))
+        thread.start()
+        threads.append(thread)
+    time.sleep(0.5)
+    for i in range(0, len(feed), options.batch):
+        chunk = '\r\n'.join(feed[i:i + options.batch]) + '\r\n'
+        os.write(master, chunk.encode('ascii'))
+        time.sleep(options.pause)
+    time.sleep(1)
+    stop.set()
+    for thread in threads:
+        thread.join()
+    for sock in socks:
+        sock.close()
+    gpsd.terminate()
+    _, _, usage = os.wait4(gpsd.pid, 0)
+    gpsd.returncode = 0         # reaped by wait4(), tell Popen
+    os.close(master)
+    os.close(slave)
+    return usage.ru_utime + usage.ru_stime, results
+
+
+def main():
+    """Run an unfiltered and a filtered pass, print a comparison."""
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--gpsd', default='gpsd',
+                        help='gpsd binary to run [Default %(default)s]')
+    parser.add_argument('-f', '--file', default='test/sample.aivdm',
+                        help='AIVDM log to amplify [Default %(default)s]')
+    parser.add_argument('-n', '--copies', type=int, default=100,
+                        help='copies of the log to feed [Default %(default)s]')
+    parser.add_argument('-c', '--clients', type=int, default=4,
+                        help='watching clients [Default %(default)s]')
+    parser.add_argument('-p', '--port', type=int, default=29470,
+                        help='gpsd port to use [Default %(default)s]')
+    parser.add_argument('-b', '--batch', type=int, default=20,
+                        help='sentences per pty write [Default %(default)s]')
+    parser.add_argument('--pause', type=float, default=0.002,
+                        help='seconds between writes [Default %(default)s]')
+    parser.add_argument('--filter', default='"aistype":[1,2,3,18,19]',
+                        help='AIS filter keys to add to ?WATCH '
+                             '[Default %(default)s]')
+    options = parser.parse_args()
+
+    feed = amplify(options.file, options.copies)
+    print("feeding %d sentences to %d clients" % (len(feed), options.clients))
+    for label, extra in (('unfiltered', ''), ('filtered', ',' + options.filter)):
+        cpu, results = run(options, feed, extra)
+        nbytes = sum(r[0] for r in results) / len(results)
+        msgs = sum(r[1] for r in results) / len(results)
+        print("%-10s gpsd cpu %6.3fs  per client: %8d AIS %10d bytes" %
+              (label, cpu, msgs, nbytes))
+    sys.exit(0)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Load test for gpsd client accept handling.
+
+Opens many client connections to a running gpsd at once, as happens
+when a network blip drops every client and they all reconnect, then
+reports how long it took for each to be greeted with a VERSION
+response.  Repeats for several rounds.
+
+gpsd only has max_clients subscriber slots (64 unless built with
+max_clients=NNN), clients beyond that are accepted and then closed.
+Those are counted as "refused".  To really push a thousand clients
+through, build with max_clients=1024 and raise the file descriptor
+limit of both gpsd and this script.
+
+Example:
+
+    gpsd -N -n /dev/ttyUSB0 &
+    devtools/reconnect_storm.py -n 1000 -r 5
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import argparse
+import errno
+import select
+import socket
+import sys
+import time
+
+
+def storm(host, port, count, timeout):
+    """Connect count clients at once, wait for their VERSION greetings.
+
+    Return (greeted_latencies, refused, failed)
+    """
+    pending = {}
+    failed = 0
+    start = time.time()
+    for _ in range(count):
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.setblocking(False)
+        err = sock.connect_ex((host, port))
+        if err not in (0, errno.EINPROGRESS):
+            failed += 1
+            sock.close()
+            continue
+        pending[sock.fileno()] = [sock, b'']
+
+    latencies = []
+    refused = 0
+    poller = select.poll()
+    for fd in pending:
+        poller.register(fd, select.POLLIN)
+    deadline = start + timeout
+    while pending and time.time() < deadline:
+        remaining = max(0, deadline - time.time())
+        for fd, _ in poller.poll(remaining * 1000):
+            sock, buf = pending[fd]
+            try:
+                data = sock.recv(4096)
+            except (ConnectionResetError, ConnectionRefusedError):
+                data = b''
+            if data:
+                buf += data
+                pending[fd][1] = buf
+                if b'\n' not in buf:
+                    continue
+                if b'"class":"VERSION"' in buf:
+                    latencies.append(time.time() - start)
+                else:
+                    failed += 1
+            else:
+                refused += 1
+            poller.unregister(fd)
+            sock.close()
+            del pending[fd]
+
+    failed += len(pending)
+    for sock, _ in pending.values():
+        sock.close()
+    return latencies, refused, failed
+
+
+def percentile(values, pct):
+    """Simple nearest rank percentile."""
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * pct / 100.0))]
+
+
+def main():
+    """Run the storm rounds, print a summary line per round."""
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('-H', '--host', default='127.0.0.1',
+                        help='gpsd host [Default %(default)s]')
+    parser.add_argument('-p', '--port', type=int, default=2947,
+                        help='gpsd port [Default %(default)s]')
+    parser.add_argument('-n', '--clients', type=int, default=1000,
+                        help='clients per round [Default %(default)s]')
+    parser.add_argument('-r', '--rounds', type=int, default=3,
+                        help='reconnect rounds [Default %(default)s]')
+    parser.add_argument('-t', '--timeout', type=float, default=10.0,
+                        help='seconds to wait per round [Default %(default)s]')
+    options = parser.parse_args()
+
+    failures = 0
+    for rnd in range(options.rounds):
+        lat, refused, failed = storm(options.host, options.port,
+                                     options.clients, options.timeout)
+        failures += failed
+        print("round %d: greeted %d refused %d failed %d  "
+              "latency p50 %.3fs p99 %.3fs max %.3fs" %
+              (rnd, len(lat), refused, failed, percentile(lat, 50),
+               percentile(lat, 99), max(lat) if lat else 0.0))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4
@@ -74,6 +74,115 @@ static void from_sixbit(const unsigned char *bitvec, unsigned int start,
        trim_spaces_on_right_end(to, count);
 }
 
+/* clear the bits of the last byte of data past bitcount, where the
+ * copy of a binary payload picked up the fields after it */
+static void clear_tail(char *data, size_t bitcount)
+{
+    unsigned char *last = (unsigned char *)data + bitcount / 8;
+
+    if (0 != bitcount % 8) {
+        *last &= (unsigned char)(0xff << (8 - bitcount % 8));
+    }
+}
+
+/* Type 24 pairing.  A 24A goes in the first free, expired or matching
+ * slot of a short probe window starting at its MMSI's hash.  With none
+ * of those, the oldest 24A in the window makes room.  A 24B looks in
+ * the same window only, so both stay O(1) however busy the feed.
+ */
+static unsigned int type24_home(unsigned int mmsi)
+{
+    // Knuth multiplicative hash, MMSIs are far from random
+    return (mmsi * 2654435761U) % MAX_TYPE24_PENDING;
+}
+
+static bool type24_expired(const struct ais_type24a_t *ship, time_t now)
+{
+    return AIS_TYPE24_AGE < now - ship->stashed;
+}
+
+// save an incoming 24A shipname until the 24B from mmsi arrives
+void ais_type24a_stash(const struct gpsd_errout_t *errout,
+                       struct ais_type24_table_t *table,
+                       unsigned int mmsi, const char *shipname)
+{
+    unsigned int slot = type24_home(mmsi);
+    struct ais_type24a_t *saveptr = NULL;
+    struct ais_type24a_t *oldest = NULL;
+    time_t now = time(NULL);
+    int n;
+
+    for (n = 0; n < TYPE24_PROBE; n++) {
+        struct ais_type24a_t *ship = &table->ships[slot];
+
+        if (mmsi == ship->mmsi) {
+            // repeated 24A, refresh it
+            saveptr = ship;
+            break;
+        }
+        if (NULL == saveptr &&
+            (0 == ship->mmsi ||
+             type24_expired(ship, now))) {
+            saveptr = ship;
+        }
+        if (NULL == oldest ||
+            oldest->stashed > ship->stashed) {
+            oldest = ship;
+        }
+        slot = (slot + 1) % MAX_TYPE24_PENDING;
+    }
+    if (NULL == saveptr) {
+        table->evicted++;
+        GPSD_LOG(LOG_INF, errout,
+                 "AIVDM: 24A from %09u dropped unmatched for %09u, "
+                 "%lu so far, consider a larger max_type24_pending.\n",
+                 oldest->mmsi, mmsi, table->evicted);
+        saveptr = oldest;
+    }
+    GPSD_LOG(LOG_PROG, errout, "AIVDM: 24A from %09u stashed.\n", mmsi);
+    saveptr->mmsi = mmsi;
+    saveptr->stashed = now;
+    (void)strlcpy(saveptr->shipname, shipname, sizeof(saveptr->shipname));
+}
+
+/* find the 24A from mmsi, copy its shipname and free its slot
+ *
+ * Return: True when the 24A was found
+ *         False otherwise
+ */
+bool ais_type24a_match(const struct gpsd_errout_t *errout,
+                       struct ais_type24_table_t *table,
+                       unsigned int mmsi, char *shipname, size_t len)
+{
+    unsigned int slot = type24_home(mmsi);
+    time_t now = time(NULL);
+    int n;
+
+    for (n = 0; n < TYPE24_PROBE; n++) {
+        struct ais_type24a_t *ship = &table->ships[slot];
+
+        if (mmsi == ship->mmsi &&
+            !type24_expired(ship, now)) {
+            (void)strlcpy(shipname, ship->shipname, len);
+            // prevent false match if a 24B is repeated
+            ship->mmsi = 0;
+            table->hits++;
+            GPSD_LOG(LOG_PROG, errout,
+                     "AIVDM: 24B from %09u matches a 24A, "
+                     "hits %lu misses %lu evicted %lu.\n",
+                     mmsi, table->hits, table->misses, table->evicted);
+            return true;
+        }
+        slot = (slot + 1) % MAX_TYPE24_PENDING;
+    }
+    table->misses++;
+    GPSD_LOG(LOG_PROG, errout,
+             "AIVDM: 24B from %09u has no 24A, "
+             "hits %lu misses %lu evicted %lu.\n",
+             mmsi, table->hits, table->misses, table->evicted);
+    return false;
+}
+
 /* decode an AIS binary packet
  *
  * Return: True on success
@@ -82,7 +191,7 @@ static void from_sixbit(const unsigned char *bitvec, unsigned int start,
 bool ais_binary_decode(const struct gpsd_errout_t *errout,
                        struct ais_t *ais,
                        const unsigned char *bits, size_t bitlen,
-                       struct ais_type24_queue_t *type24_queue)
+                       struct ais_type24_table_t *type24)
 {
     unsigned int u; int i;
 
@@ -1001,21 +1110,11 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
         switch (UBITS(38, 2)) {
         case 0:
             RANGE_CHECK(160, 168);
-            // save incoming 24A shipname/MMSI pairs in a circular queue
-            {
-                struct ais_type24a_t *saveptr =
-                        &type24_queue->ships[type24_queue->index];
-
-                GPSD_LOG(LOG_PROG, errout, "AIVDM: 24A from %09u stashed.\n",
-                         ais->mmsi);
-                saveptr->mmsi = ais->mmsi;
-                UCHARS(40, saveptr->shipname);
-                ++type24_queue->index;
-                type24_queue->index %= MAX_TYPE24_INTERLEAVE;
-            }
+            UCHARS(40, ais->type24.shipname);
+            ais_type24a_stash(errout, type24, ais->mmsi,
+                              ais->type24.shipname);
             //ais->type24.a.spare       = UBITS(160, 8);
 
-            UCHARS(40, ais->type24.shipname);
             ais->type24.part = part_a;
             return true;
         case 1:
@@ -1046,20 +1145,12 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
             }
             //ais->type24.b.spare           = UBITS(162, 8);
 
-            // search the 24A queue for a matching MMSI
-            for (i = 0; i < MAX_TYPE24_INTERLEAVE; i++) {
-                if (type24_queue->ships[i].mmsi == ais->mmsi) {
-                    (void)strlcpy(ais->type24.shipname,
-                                  type24_queue->ships[i].shipname,
-                                  sizeof(ais->type24.shipname));
-                    GPSD_LOG(LOG_PROG, errout,
-                             "AIVDM 24B from %09u matches a 24A.\n",
-                             ais->mmsi);
-                    // prevent false match if a 24B is repeated
-                    type24_queue->ships[i].mmsi = 0;
-                    ais->type24.part = both;
-                    return true;
-                }
+            // search the 24A table for a matching MMSI
+            if (ais_type24a_match(errout, type24, ais->mmsi,
+                                  ais->type24.shipname,
+                                  sizeof(ais->type24.shipname))) {
+                ais->type24.part = both;
+                return true;
             }
 
             // no match, return Part B
@@ -1105,6 +1196,7 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
                       ais->type25.bitcount, 30);
             ais->type25.bitcount -= 30;
         }
+        clear_tail(ais->type25.bitdata, ais->type25.bitcount);
         break;
     case 26:    // Binary Message, Multiple Slot
         RANGE_CHECK(60, 1004);
@@ -1132,6 +1224,9 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
                       ais->type26.bitcount, 30);
             ais->type26.bitcount -= 30;
         }
+        clear_tail(ais->type26.bitdata, ais->type26.bitcount);
+        // radio status, in the last 20 bits whatever the length
+        ais->type26.radio         = UBITS(bitlen - 20, 20);
         break;
     case 27:    // Long Range AIS Broadcast message
         if (96 != bitlen &&
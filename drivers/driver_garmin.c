@@ -1032,11 +1032,14 @@ gps_mask_t garmin_ser_parse(struct gps_device_t *session)
     unsigned char *buf = session->lexer.outbuffer;
     size_t len = session->lexer.outbuflen;
     unsigned char data_buf[MAX_BUFFER_SIZE];
+    unsigned char *payload;
     unsigned char c;
     int i = 0;
+    int j = 0;
     size_t n = 0;
     int data_index = 0;
     int got_dle = 0;
+    bool stuffed = false;
     unsigned char pkt_id = 0;
     unsigned char pkt_len = 0;
     unsigned char chksum = 0;
@@ -1053,10 +1056,12 @@ gps_mask_t garmin_ser_parse(struct gps_device_t *session)
                  "Garmin: serial too short: %zd\n", len);
         return 0;
     }
-    // debug
-    for (i = 0; i < (int)len; i++) {
+    if (LOG_RAW <= session->context->errout.debug) {
+        char scratchbuf[MAX_PACKET_LENGTH * 2 + 1];
+
         GPSD_LOG(LOG_RAW, &session->context->errout,
-                 "Garmin: Char: %#02x\n", buf[i]);
+                 "Garmin: packet %s\n",
+                 gpsd_packetdump(scratchbuf, sizeof(scratchbuf), buf, len));
     }
 
     if ('\x10' != buf[0]) {
@@ -1087,6 +1092,9 @@ gps_mask_t garmin_ser_parse(struct gps_device_t *session)
             return 0;
         }
     }
+    /* The payload is decoded where the lexer left it.  Only a payload
+     * holding a DLE, stuffed to DLE DLE, is copied out to data_buf. */
+    payload = &buf[n];
     data_index = 0;
     for (i = 0; i < 256; i++) {
 
@@ -1112,9 +1120,10 @@ gps_mask_t garmin_ser_parse(struct gps_device_t *session)
             }
         } else {
             chksum += c;
-            data_buf[data_index++] = c;
+            data_index++;
             if ('\x10' == c) {
                 got_dle = 1;
+                stuffed = true;
             }
         }
     }
@@ -1160,17 +1169,21 @@ gps_mask_t garmin_ser_parse(struct gps_device_t *session)
         return 0;
     }
 
-    /* debug */
-    for (i = 0; i < data_index; i++) {
-        GPSD_LOG(LOG_RAW, &session->context->errout,
-                 "Garmin: Char %#02x\n", data_buf[i]);
+    if (stuffed) {
+        // drop the second DLE of each pair
+        for (i = 0, j = 0; j < data_index; i++) {
+            data_buf[j++] = payload[i];
+            if ('\x10' == payload[i]) {
+                i++;
+            }
+        }
+        payload = data_buf;
     }
 
-
     GPSD_LOG(LOG_DATA, &session->context->errout,
              "Garmin: garmin_ser_parse() Type %#02x Len %#02x chksum %#02x\n",
              pkt_id, pkt_len, chksum);
-    mask = PrintSERPacket(session, pkt_id, pkt_len, data_buf);
+    mask = PrintSERPacket(session, pkt_id, pkt_len, payload);
 
     /* sending ACK too soon might hang the session
      * so send ACK last, after a pause, then wait 300 uSec */
@@ -28,10 +28,12 @@ http://www.javad.com/downloads/javadgnss/manuals/GREIS/GREIS_Reference_Guide.pdf
 #include <stdlib.h>       // for abs()
 #include <string.h>
 #include <sys/select.h>
+#include <time.h>
 
 #include "../include/bits.h"
 #include "../include/driver_greis.h"
 #include "../include/gpsd.h"
+#include "../include/strfuncs.h"
 #include "../include/timespec.h"
 
 #if defined(GREIS_ENABLE)
@@ -368,6 +370,10 @@ static gps_mask_t greis_msg_SI(struct gps_device_t *session,
     gpsd_zero_satellites(&session->gpsdata);
     // FIXME: check against MAXCHANNELS?
     session->gpsdata.satellites_visible = len - 1;
+    session->gpsdata.raw.nmeas = (unsigned)(len - 1);
+    if (MAXCHANNELS < session->gpsdata.raw.nmeas) {
+        session->gpsdata.raw.nmeas = MAXCHANNELS;
+    }
     for (i = 0; i < session->gpsdata.satellites_visible; i++) {
         // This isn't really PRN, this is USI.  Convert it.
         unsigned short PRN = getub(buf, i);
@@ -857,35 +863,60 @@ static gps_mask_t greis_msg_ET(struct gps_device_t *session,
     return mask | REPORT_IS | STATUS_SET;
 }
 
-struct dispatch_table_entry {
-    char id0;
-    char id1;
-    gps_mask_t (*handler)(struct gps_device_t *, unsigned char *, size_t);
+// indexed by enum greis_msg, see greis_id_table[]
+static gps_mask_t (*const greis_handlers[GREIS_MSGS])(struct gps_device_t *,
+                                                      unsigned char *,
+                                                      size_t) = {
+    [GREIS_MSG_ET] = greis_msg_ET,
+    [GREIS_MSG_AZ] = greis_msg_AZ,
+    [GREIS_MSG_DC] = greis_msg_DC,
+    [GREIS_MSG_DP] = greis_msg_DP,
+    [GREIS_MSG_EC] = greis_msg_EC,
+    [GREIS_MSG_ER] = greis_msg_ER,
+    [GREIS_MSG_EL] = greis_msg_EL,
+    [GREIS_MSG_GT] = greis_msg_GT,
+    [GREIS_MSG_R3] = greis_msg_R3,
+    [GREIS_MSG_RC] = greis_msg_RC,
+    [GREIS_MSG_P3] = greis_msg_P3,
+    [GREIS_MSG_PC] = greis_msg_PC,
+    [GREIS_MSG_PV] = greis_msg_PV,
+    [GREIS_MSG_RE] = greis_msg_RE,
+    [GREIS_MSG_SG] = greis_msg_SG,
+    [GREIS_MSG_SI] = greis_msg_SI,
+    [GREIS_MSG_SS] = greis_msg_SS,
+    [GREIS_MSG_UO] = greis_msg_UO,
+    [GREIS_MSG_RT] = greis_msg_RT,
 };
 
-static struct dispatch_table_entry dispatch_table[] = {
-    {':', ':', greis_msg_ET},
-    {'A', 'Z', greis_msg_AZ},
-    {'D', 'C', greis_msg_DC},
-    {'D', 'P', greis_msg_DP},
-    {'E', 'C', greis_msg_EC},
-    {'E', 'R', greis_msg_ER},
-    {'E', 'L', greis_msg_EL},
-    {'G', 'T', greis_msg_GT},
-    {'R', '3', greis_msg_R3},
-    {'R', 'C', greis_msg_RC},
-    {'P', '3', greis_msg_P3},
-    {'P', 'C', greis_msg_PC},
-    {'P', 'V', greis_msg_PV},
-    {'R', 'E', greis_msg_RE},
-    {'S', 'G', greis_msg_SG},
-    {'S', 'I', greis_msg_SI},
-    {'S', 'S', greis_msg_SS},
-    {'U', 'O', greis_msg_UO},
-    {'~', '~', greis_msg_RT},
+// for the rate report, "??" counts the messages with no decoder
+static const char greis_msg_names[GREIS_MSGS][3] = {
+    "??", "::", "AZ", "DC", "DP", "EC", "ER", "EL", "GT", "R3",
+    "RC", "P3", "PC", "PV", "RE", "SG", "SI", "SS", "UO", "~~",
 };
 
-#define dispatch_table_size (sizeof(dispatch_table) / sizeof(dispatch_table[0]))
+// seconds between per-message rate reports
+#define GREIS_RATE_PERIOD       60
+
+// log messages/s of each type since rate_start, then start over
+static void greis_report_rates(struct gps_device_t *session, time_t now)
+{
+    unsigned long *count = session->driver.greis.msg_count;
+    double period = (double)(now - session->driver.greis.rate_start);
+    char buf[GREIS_MSGS * 14];
+    unsigned i;
+
+    buf[0] = '\0';
+    for (i = 0; i < GREIS_MSGS; i++) {
+        if (0 < count[i]) {
+            str_appendf(buf, sizeof(buf), " %s %.1f",
+                        greis_msg_names[i], count[i] / period);
+        }
+    }
+    GPSD_LOG(LOG_INF, &session->context->errout,
+             "GREIS: messages/s over %.0f s:%s\n", period, buf);
+    memset(count, 0, sizeof(session->driver.greis.msg_count));
+    session->driver.greis.rate_start = now;
+}
 
 /**
  * Parse the data from the device
@@ -893,8 +924,7 @@ static struct dispatch_table_entry dispatch_table[] = {
 static gps_mask_t greis_dispatch(struct gps_device_t *session,
                                  unsigned char *buf, size_t len)
 {
-    size_t i;
-    char id0, id1;
+    unsigned msg;
 
     if (len == 0)
         return 0;
@@ -917,22 +947,28 @@ static gps_mask_t greis_dispatch(struct gps_device_t *session,
     GPSD_LOG(LOG_RAW, &session->context->errout,
              "GREIS: raw packet id '%c%c'\n", buf[0], buf[1]);
 
-    id0 = buf[0];
-    id1 = buf[1];
-    len -= HEADER_LENGTH;
-    buf += HEADER_LENGTH;
-
-    for (i = 0; i < dispatch_table_size; i++) {
-        struct dispatch_table_entry *entry = &dispatch_table[i];
-
-        if (id0 == entry->id0 && id1 == entry->id1) {
-            return entry->handler(session, buf, len);
+    msg = greis_msg_of(buf);
+    session->driver.greis.msg_count[msg]++;
+    if (GREIS_MSG_ET == msg) {
+        // once an epoch is often enough to look at the clock
+        time_t now = time(NULL);
+
+        if (0 == session->driver.greis.rate_start) {
+            session->driver.greis.rate_start = now;
+        } else if (GREIS_RATE_PERIOD <=
+                   now - session->driver.greis.rate_start) {
+            greis_report_rates(session, now);
         }
     }
 
-    GPSD_LOG(LOG_WARN, &session->context->errout,
-             "GREIS: unknown packet id '%c%c' length %zu\n", id0, id1, len);
-    return 0;
+    if (GREIS_MSG_NONE == msg) {
+        GPSD_LOG(LOG_WARN, &session->context->errout,
+                 "GREIS: unknown packet id '%c%c' length %zu\n",
+                 buf[0], buf[1], len - HEADER_LENGTH);
+        return 0;
+    }
+    return greis_handlers[msg](session, buf + HEADER_LENGTH,
+                               len - HEADER_LENGTH);
 }
 
 /**********************************************************
@@ -1,5 +1,7 @@
 /*
- * Checksum for the GNSS Receiver External Interface Specification (GREIS).
+ * Checksum and message ID table for the GNSS Receiver External
+ * Interface Specification (GREIS).  Shared by the packet lexer and
+ * the driver.
  *
  * This file is Copyright 2017 Virgin Orbit
  * This file is Copyright 2017 the GPSD project
@@ -9,6 +11,8 @@
 #include "../include/gpsd_config.h"  // must be before all includes
 
 #include <limits.h>
+#include <stdint.h>
+#include <string.h>             // for memcpy()
 
 #include "../include/driver_greis.h"
 
@@ -23,13 +27,64 @@ static inline unsigned char greis_rotate_left(unsigned char val)
     return (val << 2) | (val >> (CHAR_BIT - 2));
 }
 
+/* The byte at src[i] of count ends up rotated left by 2 * (count - i)
+ * bits, and four 2 bit rotations of a byte are no rotation at all.
+ * So bytes in the same phase, (count - i) % 4, can be XORed together
+ * first and rotated once after.  Lane i % 8 of a 64 bit word always
+ * holds the same phase, so XOR the message 8 bytes at a time. */
 unsigned char greis_checksum(const unsigned char *src, int count)
 {
+    uint64_t acc = 0;
+    unsigned char lane[sizeof(acc)];
     unsigned char res = 0;
+    int i;
 
-    while (count--) {
-        res = greis_rotate_left(res) ^ *src++;
+    for (i = 0; i + (int)sizeof(acc) <= count; i += sizeof(acc)) {
+        uint64_t word;
+
+        // memcpy(), src need not be aligned
+        memcpy(&word, src + i, sizeof(word));
+        acc ^= word;
+    }
+    // lanes in memory order, whatever the byte order
+    memcpy(lane, &acc, sizeof(lane));
+    for (; i < count; i++) {
+        lane[i % sizeof(lane)] ^= src[i];
+    }
+
+    for (i = 0; i < (int)sizeof(lane); i++) {
+        unsigned char val = lane[i];
+        unsigned phase;
+
+        for (phase = (unsigned)(count - i) % 4; 0 < phase; phase--) {
+            val = greis_rotate_left(val);
+        }
+        res ^= val;
     }
-    return greis_rotate_left(res);
+    return res;
 }
+#define GREIS_ID(c0, c1) [(c0) - GREIS_ID_FIRST][(c1) - GREIS_ID_FIRST]
+
+// two character message ID to enum greis_msg, one lookup per packet
+const unsigned char greis_id_table[GREIS_ID_SPAN][GREIS_ID_SPAN] = {
+    GREIS_ID(':', ':') = GREIS_MSG_ET,
+    GREIS_ID('A', 'Z') = GREIS_MSG_AZ,
+    GREIS_ID('D', 'C') = GREIS_MSG_DC,
+    GREIS_ID('D', 'P') = GREIS_MSG_DP,
+    GREIS_ID('E', 'C') = GREIS_MSG_EC,
+    GREIS_ID('E', 'R') = GREIS_MSG_ER,
+    GREIS_ID('E', 'L') = GREIS_MSG_EL,
+    GREIS_ID('G', 'T') = GREIS_MSG_GT,
+    GREIS_ID('R', '3') = GREIS_MSG_R3,
+    GREIS_ID('R', 'C') = GREIS_MSG_RC,
+    GREIS_ID('P', '3') = GREIS_MSG_P3,
+    GREIS_ID('P', 'C') = GREIS_MSG_PC,
+    GREIS_ID('P', 'V') = GREIS_MSG_PV,
+    GREIS_ID('R', 'E') = GREIS_MSG_RE,
+    GREIS_ID('S', 'G') = GREIS_MSG_SG,
+    GREIS_ID('S', 'I') = GREIS_MSG_SI,
+    GREIS_ID('S', 'S') = GREIS_MSG_SS,
+    GREIS_ID('U', 'O') = GREIS_MSG_UO,
+    GREIS_ID('~', '~') = GREIS_MSG_RT,
+};
 // vim: set expandtab shiftwidth=4
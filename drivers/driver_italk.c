@@ -305,6 +305,7 @@ static gps_mask_t decode_itk_pseudo(struct gps_device_t *session,
     for (i = 0; i < MAXCHANNELS; i++) {
         session->gpsdata.raw.meas[i].svid = 0;
     }
+    session->gpsdata.raw.nmeas = n;
     for (i = 0; i < n; i++){
         session->gpsdata.skyview[i].PRN =
             getleu16(buf, 7 + 26 + (i*36)) & 0xff;
@@ -1071,26 +1071,15 @@ static gps_mask_t hnd_129809(unsigned char *bu, int len, PGN *pgn,
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
         int l;
-        int index   = session->driver.aivdm.context[0].type24_queue.index;
-        struct ais_type24a_t *saveptr =
-            &session->driver.aivdm.context[0].type24_queue.ships[index];
-
-        GPSD_LOG(LOG_PROG, &session->context->errout,
-                 "NMEA2000: AIS message 24A from %09u stashed.\n",
-                 ais->mmsi);
 
         for (l=0;l<AIS_SHIPNAME_MAXLEN;l++) {
             ais->type24.shipname[l] = (char) bu[ 5+l];
-            saveptr->shipname[l] = (char) bu[ 5+l];
         }
         ais->type24.shipname[AIS_SHIPNAME_MAXLEN] = (char) 0;
-        saveptr->shipname[AIS_SHIPNAME_MAXLEN] = (char) 0;
-
-        saveptr->mmsi = ais->mmsi;
 
-        index += 1;
-        index %= MAX_TYPE24_INTERLEAVE;
-        session->driver.aivdm.context[0].type24_queue.index = index;
+        ais_type24a_stash(&session->context->errout,
+                          &session->driver.aivdm.type24,
+                          ais->mmsi, ais->type24.shipname);
 
         decode_ais_channel_info(bu, len, 200, session);
 
@@ -1115,7 +1104,7 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, PGN *pgn,
              "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
-        int l, i;
+        int l;
 
         ais->type24.shiptype = (unsigned int) ((bu[ 5] >> 0) & 0xff);
 
@@ -1155,37 +1144,26 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, PGN *pgn,
             ais->type24.dim.to_starboard  = (unsigned int) (to_starboard/10);
         }
 
-        for (i = 0; i < MAX_TYPE24_INTERLEAVE; i++) {
-            if (session->driver.aivdm.context[0].type24_queue.ships[i].mmsi ==
-                ais->mmsi) {
-                for (l=0;l<AIS_SHIPNAME_MAXLEN;l++) {
-                    ais->type24.shipname[l] =
-  (char)(session->driver.aivdm.context[0].type24_queue.ships[i].shipname[l]);
-                }
-                ais->type24.shipname[AIS_SHIPNAME_MAXLEN] = (char) 0;
-
-                GPSD_LOG(LOG_PROG, &session->context->errout,
-                         "NMEA2000: AIS 24B from %09u matches a 24A.\n",
-                            ais->mmsi);
-                /* prevent false match if a 24B is repeated */
-                session->driver.aivdm.context[0].type24_queue.ships[i].mmsi = 0;
+        if (ais_type24a_match(&session->context->errout,
+                              &session->driver.aivdm.type24, ais->mmsi,
+                              ais->type24.shipname,
+                              sizeof(ais->type24.shipname))) {
 #if NMEA2000_DEBUG_AIS
-                printf("AIS: MMSI:  %09u\n", ais->mmsi);
-                printf("AIS: name:  %-20.20s v:%-8.8s c:%-8.8s b:%6u "
-                       "s:%6u p:%6u s:%6u\n",
-                       ais->type24.shipname,
-                       ais->type24.vendorid,
-                       ais->type24.callsign,
-                       ais->type24.dim.to_bow,
-                       ais->type24.dim.to_stern,
-                       ais->type24.dim.to_port,
-                       ais->type24.dim.to_starboard);
+            printf("AIS: MMSI:  %09u\n", ais->mmsi);
+            printf("AIS: name:  %-20.20s v:%-8.8s c:%-8.8s b:%6u "
+                   "s:%6u p:%6u s:%6u\n",
+                   ais->type24.shipname,
+                   ais->type24.vendorid,
+                   ais->type24.callsign,
+                   ais->type24.dim.to_bow,
+                   ais->type24.dim.to_stern,
+                   ais->type24.dim.to_port,
+                   ais->type24.dim.to_starboard);
 #endif /* of #if NMEA2000_DEBUG_AIS */
 
-                decode_ais_channel_info(bu, len, 264, session);
-                ais->type24.part = both;
-                return(ONLINE_SET | AIS_SET);
-            }
+            decode_ais_channel_info(bu, len, 264, session);
+            ais->type24.part = both;
+            return(ONLINE_SET | AIS_SET);
         }
 #if NMEA2000_DEBUG_AIS
         printf("AIS: MMSI  :  %09u\n", ais->mmsi);
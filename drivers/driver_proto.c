@@ -278,6 +278,7 @@ static gps_mask_t _proto__msg_raw(struct gps_device_t *session,
     /* this is so we can tell which never got set */
     for (i = 0; i < MAXCHANNELS; i++)
         session->gpsdata.raw.meas[i].svid = 0;
+    session->gpsdata.raw.nmeas = n;
     for (i = 0; i < n; i++){
         session->gpsdata.PRN[i] = GET_PRN();
         session->gpsdata.ss[i] = GET_SIGNAL()
@@ -403,15 +404,13 @@ static void _proto__event_hook(struct gps_device_t *session, event_t event)
     if (event == EVENT_CONFIGURE) {
         /*
          * Change sentence mix and set reporting modes as needed.
-         * Called immediately after EVENT_IDENTIFIED fires, then just
-         * after every packet received thereafter, but you probably
-         * only want to take actions on the first few packets after
-         * the session.lexer counter has been zeroed,
-         *
-         * Remember that session->lexer.counter is available when you
-         * write this hook; you can use this fact to interleave configuration
-         * sends with the first few packet reads, which is useful for
-         * devices with small receive buffers.
+         * Called by gpsd_configure() once for each of the driver's
+         * config_steps, with the step number in session->cfg_stage,
+         * starting when the driver is selected.  Send one step's worth
+         * at a time; that paces configuration for devices with small
+         * receive buffers.  Set session->cfg_wait if the step should
+         * wait for an ACK/NAK, and call gpsd_config_ack() when one
+         * arrives.
          */
     } else if (event == EVENT_DRIVER_SWITCH) {
         /*
@@ -541,6 +540,8 @@ const struct gps_type_t driver__proto__binary = {
     /* Control string sender - should provide checksum and headers/trailer */
     .control_send   = _proto__control_send,
     .time_offset     = _proto_time_offset,
+    /* EVENT_CONFIGURE steps to run after the driver is selected */
+    .config_steps     = 0,
 /* *INDENT-ON* */
 };
 #endif  // defined(_PROTO__ENABLE)
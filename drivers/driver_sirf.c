@@ -429,8 +429,7 @@ static void sirfbin_mode(struct gps_device_t *session, int mode)
                         9 - session->gpsdata.dev.stopbits,
                         session->gpsdata.dev.stopbits, parity);
         // reset binary init steps
-        session->cfg_stage = 0;
-        session->cfg_step = 0;
+        gpsd_config_start(session);
     }
 }
 
@@ -2366,6 +2365,7 @@ gps_mask_t sirf_parse(struct gps_device_t * session, unsigned char *buf,
                      getub(buf, 1), getub(buf, 2));
         }
         session->driver.sirf.need_ack = 0;
+        gpsd_config_ack(session);
         return 0;
 
     case 0x0c:                  // Command NAcknowledgement MID 12
@@ -2383,6 +2383,7 @@ gps_mask_t sirf_parse(struct gps_device_t * session, unsigned char *buf,
         }
         // ugh -- there's no alternative but silent failure here
         session->driver.sirf.need_ack = 0;
+        gpsd_config_ack(session);
         return 0;
 
     case 0x0d:                  // Visible List MID 13
@@ -2539,8 +2540,7 @@ static void sirfbin_init_query(struct gps_device_t *session)
              "SiRF: Probing for firmware version.\n");
 
     // reset binary init steps
-    session->cfg_stage = 0;
-    session->cfg_step = 0;
+    gpsd_config_start(session);
 
     // MID 132
     (void)sirf_write(session, versionprobe, sizeof(versionprobe));
@@ -2585,38 +2585,20 @@ static void sirfbin_event_hook(struct gps_device_t *session, event_t event)
         break;
 
     case EVENT_CONFIGURE:
-        /* This wakes up on every received packet.
-         * Use this hook to step, slowly, through the init messages.
-         * We try, but not always succeed, to wait for the ACK/NACK.
-         * Send a message only every 15 times so we get an ACK/NACK
-         * before next one.
+        /* gpsd_configure() steps us, slowly, through the init messages.
+         * Each step waits for its ACK/NACK, or CONFIG_ACK_WAIT, before
+         * the next one goes.
          *
          * This tries to avoid overrunning the input buffer, and makes
          * it much easier to identify which messages get a NACK
          */
-
-
-        if (UINT_MAX == session->cfg_stage) {
-            // init done
-            return;
-        }
-        session->cfg_step++;
-
-        if ((0 < session->driver.sirf.need_ack) &&
-            (15 > session->cfg_step)) {
-            // we are waiting for ACK, just wait for 15 messages
-            return;
-        }
-        session->cfg_step = 0;
-        session->cfg_stage++;
         GPSD_LOG(LOG_PROG, &session->context->errout, "stage: %d\n",
                  session->cfg_stage);
 
-
         switch (session->cfg_stage) {
         case 0:
-            // this slot used by EVENT_IDENTIFIED
-            return;
+            // this slot used by EVENT_IDENTIFIED, wait for its ACK
+            break;
 
         case 1:
             (void)sirf_write(session, versionprobe, sizeof(versionprobe));
@@ -2717,11 +2699,10 @@ static void sirfbin_event_hook(struct gps_device_t *session, event_t event)
             break;
 
         default:
-            // initialization is done
-            session->cfg_stage = UINT_MAX;
-            session->cfg_step = 0;
+            // past config_steps, initialization is done
             return;
         }
+        session->cfg_wait = (0 < session->driver.sirf.need_ack);
         break;
 
     case EVENT_DEACTIVATE:
@@ -2774,6 +2755,7 @@ const struct gps_type_t driver_sirf =
     .min_cycle.tv_nsec = 0,                 // not relevant, no rate switch
     .control_send   = sirf_control_send,    // how to send a control string
     .time_offset    = sirf_time_offset,
+    .config_steps   = 13,                   // binary init messages
 };
 // *INDENT-ON*
 #endif // defined(SIRF_ENABLE)
@@ -1041,58 +1041,37 @@ static gps_mask_t sky_msg_DC(struct gps_device_t *session,
     return 0;
 }
 
-/*
- * decode MID 0xDD, Raw Measurements
- *
- */
-static gps_mask_t sky_msg_DD(struct gps_device_t *session,
-                             unsigned char *buf, size_t len UNUSED)
-{
-    unsigned iod;   // Issue of data 0 - 255
-    unsigned nmeas; // number of measurements
-    unsigned i;     // generic loop variable
-
-    iod = (unsigned)getub(buf, 1);
-    nmeas = (unsigned)getub(buf, 2);
+// one 0xDD measurement, as the receiver sent it
+struct sky_meas_t {
+    double prMes;               // pseudorange in meters
+    double cpMes;               // carrier phase in cycles
+    float doMes;                // doppler in Hz, positive towards sat
+    uint8_t PRN;
+    uint8_t cno;                // carrier-to-noise density ratio dB-Hz
+    uint8_t trkStat;            // tracking stat
+};
 
-    GPSD_LOG(LOG_DATA, &session->context->errout,
-             "Skytraq 0xDD: iod=%u, nmeas=%u\n",
-             iod, nmeas);
+// what a PRN means in RAW, svid 0 for no satellite
+struct sky_prn_t {
+    uint8_t gnssid;
+    uint8_t svid;               // RINEX 3 svid
+    char obs_code[4];
+};
 
-    // check IOD?
-    session->gpsdata.raw.mtime = session->gpsdata.skyview_time;
+static struct sky_prn_t sky_prn[256];
+static bool sky_prn_ready = false;
 
-    /* zero the measurement data
-     * so we can tell which meas never got set */
-    memset(session->gpsdata.raw.meas, 0, sizeof(session->gpsdata.raw.meas));
+// fill sky_prn[], once
+static void sky_prn_init(void)
+{
+    int PRN;
 
-    for (i = 0; i < nmeas; i++) {
+    for (PRN = 0; PRN < 256; PRN++) {
         const char *obs_code;
-        int off = 3 + (23 * i);
-
-        uint8_t PRN = getub(buf, off + 0);
-        // carrier-to-noise density ratio dB-Hz
-        uint8_t cno = getub(buf, off + 1);
-        // pseudorange in meters
-        double prMes = getbed64((const char *)buf, off + 2);
-        // carrier phase in cycles
-        double cpMes = getbed64((const char *)buf, off + 10);
-        // doppler in Hz, positive towards sat
-        double doMes = getbef32((const char *)buf, off + 18);
-
-        /* tracking stat
-         * bit 0 - prMes valid
-         * bit 1 - doppler valid
-         * bit 2 - cpMes valid
-         * bit 3 - cp slip
-         * bit 4 - Coherent integration time?
-         */
-        uint8_t trkStat = getub(buf, off + 22);
         uint8_t gnssId = 0;
         uint8_t svId = 0;
-        PRN2_gnssId_svId(PRN, &gnssId, &svId);
 
-        session->gpsdata.raw.meas[i].gnssid = gnssId;
+        PRN2_gnssId_svId(PRN, &gnssId, &svId);
         switch (gnssId) {
         case 0:       // GPS
             FALLTHROUGH
@@ -1120,45 +1099,124 @@ static gps_mask_t sky_msg_DD(struct gps_device_t *session,
             obs_code = "L1C";       // u-blox calls this L1OF
             break;
         }
-        (void)strlcpy(session->gpsdata.raw.meas[i].obs_code, obs_code,
-                      sizeof(session->gpsdata.raw.meas[i].obs_code));
-
-        session->gpsdata.raw.meas[i].svid = svId;
-        session->gpsdata.raw.meas[i].snr = cno;
-        session->gpsdata.raw.meas[i].satstat = trkStat;
-        if (trkStat & 1) {
-            // prMes valid
-            session->gpsdata.raw.meas[i].pseudorange = prMes;
-        } else {
-            session->gpsdata.raw.meas[i].pseudorange = NAN;
-        }
-        if (trkStat & 2) {
-            // doppler valid
-            session->gpsdata.raw.meas[i].doppler = doMes;
-        } else {
-            session->gpsdata.raw.meas[i].doppler = NAN;
-        }
-        if (trkStat & 4) {
-            // cpMes valid
-            session->gpsdata.raw.meas[i].carrierphase = cpMes;
-        } else {
-            session->gpsdata.raw.meas[i].carrierphase = NAN;
-        }
-        session->gpsdata.raw.meas[i].codephase = NAN;
-        session->gpsdata.raw.meas[i].deltarange = NAN;
-        // skytraq does not report locktime, so assume max
-        session->gpsdata.raw.meas[i].locktime = LOCKMAX;
-        if (trkStat & 8) {
-            // possible slip
-            session->gpsdata.raw.meas[i].lli = 2;
-        }
+        sky_prn[PRN].gnssid = gnssId;
+        sky_prn[PRN].svid = svId;
+        (void)strlcpy(sky_prn[PRN].obs_code, obs_code,
+                      sizeof(sky_prn[PRN].obs_code));
+    }
+    sky_prn_ready = true;
+}
+
+/*
+ * decode MID 0xDD, Raw Measurements
+ *
+ * 3 + (nmeas * 23) bytes
+ *
+ * The block is read in one pass into meas[], then copied into
+ * gpsdata.raw.  Only the slots in use are written.  Measurements
+ * with no satellite are dropped, so the used slots come first.
+ */
+static gps_mask_t sky_msg_DD(struct gps_device_t *session,
+                             unsigned char *buf, size_t len)
+{
+    struct sky_meas_t meas[MAXCHANNELS];
+    struct meas_t *raw = session->gpsdata.raw.meas;
+    unsigned iod;   // Issue of data 0 - 255
+    unsigned nmeas; // number of measurements
+    unsigned used = 0;
+    unsigned i;     // generic loop variable
+
+    if (3 > len) {
+        return 0;
+    }
+    iod = (unsigned)getub(buf, 1);
+    nmeas = (unsigned)getub(buf, 2);
+
+    GPSD_LOG(LOG_DATA, &session->context->errout,
+             "Skytraq 0xDD: iod=%u, nmeas=%u\n",
+             iod, nmeas);
+
+    if ((len - 3) / 23 < nmeas) {
+        GPSD_LOG(LOG_WARN, &session->context->errout,
+                 "Skytraq 0xDD: %u measurements in %zd bytes\n",
+                 nmeas, len);
+        nmeas = (unsigned)((len - 3) / 23);
+    }
+    if (MAXCHANNELS < nmeas) {
+        nmeas = MAXCHANNELS;
+    }
+
+    for (i = 0; i < nmeas; i++) {
+        const unsigned char *m = &buf[3 + (23 * i)];
+        // getbed64() and getbef32(), without the calls
+        union { int64_t l; double d; } u64;
+        union { int32_t i; float f; } u32;
+
+        meas[i].PRN = m[0];
+        meas[i].cno = m[1];
+        u64.l = getbes64(m, 2);
+        meas[i].prMes = u64.d;
+        u64.l = getbes64(m, 10);
+        meas[i].cpMes = u64.d;
+        u32.i = getbes32(m, 18);
+        meas[i].doMes = u32.f;
+        meas[i].trkStat = m[22];
+    }
+
+    if (!sky_prn_ready) {
+        sky_prn_init();
+    }
+
+    // check IOD?
+    session->gpsdata.raw.mtime = session->gpsdata.skyview_time;
+
+    for (i = 0; i < nmeas; i++) {
+        const struct sky_meas_t *m = &meas[i];
+        const struct sky_prn_t *prn = &sky_prn[m->PRN];
+        struct meas_t *out;
+
         GPSD_LOG(LOG_DATA, &session->context->errout,
                  "PRN %u (%u:%u) prMes %f cpMes %f doMes %f\n"
-                 "cno %u  rtkStat %u\n", PRN,
-                 gnssId, svId, prMes, cpMes, doMes, cno, trkStat);
+                 "cno %u  rtkStat %u\n", m->PRN,
+                 prn->gnssid, prn->svid, m->prMes, m->cpMes, m->doMes,
+                 m->cno, m->trkStat);
+        if (0 == prn->svid) {
+            // PRN 0, or one we can not place
+            continue;
+        }
 
+        // every field, a memset() of the slot first costs more
+        out = &raw[used++];
+        out->gnssid = prn->gnssid;
+        out->svid = prn->svid;
+        out->sigid = 0;
+        out->snr = m->cno;
+        out->freqid = 0;
+        memcpy(out->obs_code, prn->obs_code, sizeof(out->obs_code));
+        out->satstat = m->trkStat;
+        /* tracking stat
+         * bit 0 - prMes valid
+         * bit 1 - doppler valid
+         * bit 2 - cpMes valid
+         * bit 3 - cp slip
+         * bit 4 - Coherent integration time?
+         */
+        out->pseudorange = (m->trkStat & 1) ? m->prMes : NAN;
+        out->doppler = (m->trkStat & 2) ? m->doMes : NAN;
+        out->carrierphase = (m->trkStat & 4) ? m->cpMes : NAN;
+        out->codephase = NAN;
+        out->deltarange = NAN;
+        out->l2c = 0.0;
+        out->c2c = 0.0;
+        // skytraq does not report locktime, so assume max
+        out->locktime = LOCKMAX;
+        // bit 3, possible slip
+        out->lli = (m->trkStat & 8) ? 2 : 0;
     }
 
+    // gpsdata.raw shares a union, consumers stop at nmeas
+    session->gpsdata.raw.nmeas = used;
+
     // return RAW_IS;  // WIP
     return 0;
 }
@@ -1508,6 +1566,7 @@ static gps_mask_t sky_parse(struct gps_device_t * session, unsigned char *buf,
             GPSD_LOG(LOG_PROG, &session->context->errout,
                      "Skytraq 0x83: ACK\n");
         }
+        gpsd_config_ack(session);
         break;
     case 0x84:
         // 132 - NACK
@@ -1525,6 +1584,7 @@ static gps_mask_t sky_parse(struct gps_device_t * session, unsigned char *buf,
             GPSD_LOG(LOG_INF, &session->context->errout,
                      "Skytraq 0x84: NACK\n");
         }
+        gpsd_config_ack(session);
         break;
     case 0x86:
         // 134 Position Update Rate
@@ -1628,270 +1688,267 @@ static gps_mask_t sky_parse(struct gps_device_t * session, unsigned char *buf,
     return mask;
 }
 
-static gps_mask_t skybin_parse_input(struct gps_device_t *session)
+static void skybin_event_hook(struct gps_device_t *session, event_t event)
 {
+    if (EVENT_CONFIGURE != event) {
+        return;
+    }
     /*
-     * Use this hook to step, slowly, through the init messages.
-     * By sending only one for each three received we try
-     * to avoid overrunning the receiver input buffer.
+     * gpsd_configure() steps us, slowly, through the init messages.
+     * By waiting for the ACK of each before sending the next one we
+     * try to avoid overrunning the receiver input buffer.
      */
 
-    if (UINT_MAX != session->cfg_stage) {
-        session->cfg_step++;
-    }
-
-    if (UINT_MAX != session->cfg_stage &&
-        3 <= session->cfg_step) {
-        // more init to do
-
-        session->cfg_stage++;
-        session->cfg_step = 0;
-
-        // Note: the checksums in the Skytaq doc are sometimes wrong...
+    // Note: the checksums in the Skytaq doc are sometimes wrong...
 
-        // drivers/driver_nmea0183.c send 0x04 to get MID 0x80 on detect
+    // drivers/driver_nmea0183.c send 0x04 to get MID 0x80 on detect
 
-        // FIXME: make a table
-        switch (session->cfg_stage) {
-        case 1:
-            // Send MID 0x3, to get back MID 0x81 Software CRC
-            (void)sky_write(session, "\xA0\xA1\x00\x02\x03\x00\x03\x0d\x0a",
-                            9);
-            break;
-        case 2:
-            // Send MID 0x10, to get back MID 0x86 (Position Update Rate)
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x10\x10\x0d\x0a", 8);
-            break;
-        case 3:
-            // Send MID 0x15, to get back MID 0xB9 (Power Mode Status)
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x15\x15\x0d\x0a", 8);
-            break;
-        case 4:
-            // Send MID 0x1f, to get back MID 0x89 Measurement data statuS
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x1f\x1f\x0d\x0a", 8);
-            break;
-        case 5:
-            // Send MID 0x21, to get back MID 0x8a  RTCM Data output status
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x21\x21\x0d\x0a", 8);
-            break;
-        case 6:
-            // Send MID 0x23, to get back MID 0x8B (Base Position)
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x23\x23\x0d\x0a", 8);
-            break;
-        case 7:
-            // Send MID 0x2d, to get back MID 0xAE (GNSS Datum)
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x2d\x2d\x0d\x0a", 8);
-            break;
-        case 8:
-            // Send MID 0x2E, to get back MID 0xAF (DOP Mask)
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x2e\x2e\x0d\x0a", 8);
-            break;
-        case 9:
-            // Send MID 0x2F, to get back MID 0x80 Elevation and SNR mask
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x2f\x2f\x0d\x0a", 8);
-            break;
-        case 10:
-            // Send MID 0x3a, to get back MID 0xb4 Position Pinning
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x3a\x3a\x0d\x0a", 8);
-            break;
-        case 11:
-            // Send MID 0x44, to get back MID 0xc2 1PPS timing
-            // Timing mode versions only
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x44\x44\x0d\x0a", 8);
-            break;
-        case 12:
-            // Send MID 0x46, to get back MID 0xbb 1PPS delay
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x46\x46\x0d\x0a", 8);
-            break;
-        case 13:
-            // Send MID 0x4f, to get back MID 0x93 NMEA talker ID
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x4f\x4f\x0d\x0a", 8);
-            break;
-        case 14:
-            // Send MID 0x56, to get back MID 0xc3 1PPS Output Mode
-            // Timing mode versions only
-            (void)sky_write(session, "\xA0\xA1\x00\x01\x56\x56\x0d\x0a", 8);
-            break;
-        case 15:
-            // Send MID 0x62/02, to get back MID 0x62/80 SBAS status
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x62\x02\x60\x0d\x0a", 9);
-            break;
-        case 16:
-            // Send MID 0x62/04, to get back MID 0x62/81 QZSS status
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x62\x04\x66\x0d\x0a", 9);
-            break;
-        case 17:
-            // Send MID 0x62/06, to get back MID 0x62/82 SBAS Advanced status
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x62\x06\x64\x0d\x0a", 9);
-            break;
-        case 18:
-            // Send MID 0x63/02, to get back MID 0x62/80 SAEE Status
-            // not on PX1172RH_DS
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x63\x02\x61\x0d\x0a", 9);
-            break;
-        case 19:
-            // Send MID 0x64/01, to get back MID 0x64/80
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x01\x65\x0d\x0a", 9);
-            break;
-        case 20:
-            // Send MID 0x64/03, to get back MID 0x64/81
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x03\x67\x0d\x0a", 9);
-            break;
-        case 21:
-            // Send MID 0x64/07, to get back MID 0x64/83
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x07\x63\x0d\x0a", 9);
-            break;
-        case 22:
-            // Send MID 0x64/0b, to get back MID 0x64/85
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x0b\x6f\x0d\x0a", 9);
-            break;
-        case 23:
-            // Send MID 0x64/12, to get back MID 0x64/88
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x12\x76\x0d\x0a", 9);
-            break;
-        case 24:
-            // Send MID 0x64/16, to get back MID 0x64/8a
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x16\x72\x0d\x0a", 9);
-            break;
-        case 25:
-            // Send MID 0x64/18, to get back MID 0x64/8b
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x18\x7c\x0d\x0a", 9);
-            break;
-        case 26:
-            // Send MID 0x64/1a, to get back MID 0x64/8c
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x1a\x7e\x0d\x0a", 9);
-            break;
-        case 27:
-            // Send MID 0x64/20, to get back MID 0x64/8e
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x20\x44\x0d\x0a", 9);
-            break;
-        case 28:
-            // Send MID 0x64/22, to get back MID 0x64/8f
-            // not on PX1172RH_DS
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x22\x46\x0d\x0a", 9);
-            break;
-        case 29:
-            // Send MID 0x64/28, to get back MID 0x64/92
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x28\x4c\x0d\x0a", 9);
-            break;
-        case 30:
-            // Send MID 0x64/30, to get back MID 0x64/98
-            // not on PX1172RH_DS
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x30\x54\x0d\x0a", 9);
-            break;
-        case 31:
-            // Send MID 0x64/31, to get back MID 0x64/
-            // not on PX1172RH_DS
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x31\x55\x0d\x0a", 9);
-            break;
-        case 32:
-            // Send MID 0x64/7d, to get back MID 0x64/fe
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x7d\x19\x0d\x0a", 9);
-            break;
-        case 33:
-            // Send MID 0x64/35, to get back MID 0x64/99
-            // not on PX1172RH_DS
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x03\x64\x35\x01\x50\x0d\x0a", 10);
-            break;
-        case 34:
-            // Send MID 0x64/36, to get back MID 0x64/9a
-            // not on PX1172RH_DS
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x64\x36\x52\x0d\x0a", 9);
-            break;
-        case 35:
-            // Send MID 0x64/3c, to get back MID 0x64/99
-            // not on PX1172RH_DS
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x04\x64\x3c\x47\x47\x19\x0d\x0a",
-                            11);
-            break;
-        case 36:
-            // Send MID 0x65/02, to get back MID 0x64/80
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x65\x02\x67\x0d\x0a", 9);
-            break;
-        case 37:
-            // Send MID 0x65/04, to get back MID 0x64/8f
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x65\x04\x61\x0d\x0a", 9);
-            break;
-        case 38:
-            // Send MID 0x6a/02, to get back MID 0x6a/83
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x6a\x02\x68\x0d\x0a", 9);
-            break;
-        case 39:
-            // Send MID 0x6a/07, to get back MID 0x6a/83
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x6a\x07\x6d\x0d\x0a", 9);
-            break;
-        case 40:
-            // Send MID 0x6a/0d, to get back MID 0x6a/85
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x6a\x0d\x67\x0d\x0a", 9);
-            break;
-        case 41:
-            // Send MID 0x6a/14, to get back MID 0x6a/86
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x6a\x14\xfd\x0d\x0a", 9);
-            break;
-        case 42:
-            // Send MID 0x6a/16, to get back MID 0x6a/89
-            // not on PX1172RH_DS ?
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x02\x6a\x16\x7c\x0d\x0a", 9);
-            break;
-        case 43:
-            // Send MID 0x7a/0e/01, to get back MID 0x7a/0e/80
-            // not on PX1172RH_DS ?
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x03\x7a\x0e\x01\x75\x0d\x0a", 10);
-            break;
-        case 44:
-            // Send MID 0x7a/0e/02, to get back MID 0x7a/0e/81
-            // not on PX1172RH_DS ?
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x03\x7a\x0e\x02\x76\x0d\x0a", 10);
-            break;
-        case 45:
-            // Send MID 0x7a/0e/03, to get back MID 0x7a/0e/82
-            // not on PX1172RH_DS ?
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x03\x7a\x0e\x03\x77\x0d\x0a", 10);
-            break;
-        case 46:
-            // Send MID 0x7a/0e/05, to get back MID 0x7a/0e/83
-            // not on PX1172RH_DS ?
-            (void)sky_write(session,
-                            "\xA0\xA1\x00\x03\x7a\x0e\x05\x71\x0d\x0a", 10);
-            break;
-        default:
-            // Done
-            session->cfg_stage = UINT_MAX;
-            break;
-        }
+    // FIXME: make a table
+    switch (session->cfg_stage) {
+    case 0:
+        // let the receiver settle after the switch
+        return;
+    case 1:
+        // Send MID 0x3, to get back MID 0x81 Software CRC
+        (void)sky_write(session, "\xA0\xA1\x00\x02\x03\x00\x03\x0d\x0a",
+                        9);
+        break;
+    case 2:
+        // Send MID 0x10, to get back MID 0x86 (Position Update Rate)
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x10\x10\x0d\x0a", 8);
+        break;
+    case 3:
+        // Send MID 0x15, to get back MID 0xB9 (Power Mode Status)
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x15\x15\x0d\x0a", 8);
+        break;
+    case 4:
+        // Send MID 0x1f, to get back MID 0x89 Measurement data statuS
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x1f\x1f\x0d\x0a", 8);
+        break;
+    case 5:
+        // Send MID 0x21, to get back MID 0x8a  RTCM Data output status
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x21\x21\x0d\x0a", 8);
+        break;
+    case 6:
+        // Send MID 0x23, to get back MID 0x8B (Base Position)
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x23\x23\x0d\x0a", 8);
+        break;
+    case 7:
+        // Send MID 0x2d, to get back MID 0xAE (GNSS Datum)
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x2d\x2d\x0d\x0a", 8);
+        break;
+    case 8:
+        // Send MID 0x2E, to get back MID 0xAF (DOP Mask)
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x2e\x2e\x0d\x0a", 8);
+        break;
+    case 9:
+        // Send MID 0x2F, to get back MID 0x80 Elevation and SNR mask
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x2f\x2f\x0d\x0a", 8);
+        break;
+    case 10:
+        // Send MID 0x3a, to get back MID 0xb4 Position Pinning
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x3a\x3a\x0d\x0a", 8);
+        break;
+    case 11:
+        // Send MID 0x44, to get back MID 0xc2 1PPS timing
+        // Timing mode versions only
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x44\x44\x0d\x0a", 8);
+        break;
+    case 12:
+        // Send MID 0x46, to get back MID 0xbb 1PPS delay
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x46\x46\x0d\x0a", 8);
+        break;
+    case 13:
+        // Send MID 0x4f, to get back MID 0x93 NMEA talker ID
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x4f\x4f\x0d\x0a", 8);
+        break;
+    case 14:
+        // Send MID 0x56, to get back MID 0xc3 1PPS Output Mode
+        // Timing mode versions only
+        (void)sky_write(session, "\xA0\xA1\x00\x01\x56\x56\x0d\x0a", 8);
+        break;
+    case 15:
+        // Send MID 0x62/02, to get back MID 0x62/80 SBAS status
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x62\x02\x60\x0d\x0a", 9);
+        break;
+    case 16:
+        // Send MID 0x62/04, to get back MID 0x62/81 QZSS status
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x62\x04\x66\x0d\x0a", 9);
+        break;
+    case 17:
+        // Send MID 0x62/06, to get back MID 0x62/82 SBAS Advanced status
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x62\x06\x64\x0d\x0a", 9);
+        break;
+    case 18:
+        // Send MID 0x63/02, to get back MID 0x62/80 SAEE Status
+        // not on PX1172RH_DS
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x63\x02\x61\x0d\x0a", 9);
+        break;
+    case 19:
+        // Send MID 0x64/01, to get back MID 0x64/80
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x01\x65\x0d\x0a", 9);
+        break;
+    case 20:
+        // Send MID 0x64/03, to get back MID 0x64/81
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x03\x67\x0d\x0a", 9);
+        break;
+    case 21:
+        // Send MID 0x64/07, to get back MID 0x64/83
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x07\x63\x0d\x0a", 9);
+        break;
+    case 22:
+        // Send MID 0x64/0b, to get back MID 0x64/85
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x0b\x6f\x0d\x0a", 9);
+        break;
+    case 23:
+        // Send MID 0x64/12, to get back MID 0x64/88
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x12\x76\x0d\x0a", 9);
+        break;
+    case 24:
+        // Send MID 0x64/16, to get back MID 0x64/8a
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x16\x72\x0d\x0a", 9);
+        break;
+    case 25:
+        // Send MID 0x64/18, to get back MID 0x64/8b
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x18\x7c\x0d\x0a", 9);
+        break;
+    case 26:
+        // Send MID 0x64/1a, to get back MID 0x64/8c
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x1a\x7e\x0d\x0a", 9);
+        break;
+    case 27:
+        // Send MID 0x64/20, to get back MID 0x64/8e
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x20\x44\x0d\x0a", 9);
+        break;
+    case 28:
+        // Send MID 0x64/22, to get back MID 0x64/8f
+        // not on PX1172RH_DS
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x22\x46\x0d\x0a", 9);
+        break;
+    case 29:
+        // Send MID 0x64/28, to get back MID 0x64/92
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x28\x4c\x0d\x0a", 9);
+        break;
+    case 30:
+        // Send MID 0x64/30, to get back MID 0x64/98
+        // not on PX1172RH_DS
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x30\x54\x0d\x0a", 9);
+        break;
+    case 31:
+        // Send MID 0x64/31, to get back MID 0x64/
+        // not on PX1172RH_DS
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x31\x55\x0d\x0a", 9);
+        break;
+    case 32:
+        // Send MID 0x64/7d, to get back MID 0x64/fe
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x7d\x19\x0d\x0a", 9);
+        break;
+    case 33:
+        // Send MID 0x64/35, to get back MID 0x64/99
+        // not on PX1172RH_DS
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x03\x64\x35\x01\x50\x0d\x0a", 10);
+        break;
+    case 34:
+        // Send MID 0x64/36, to get back MID 0x64/9a
+        // not on PX1172RH_DS
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x64\x36\x52\x0d\x0a", 9);
+        break;
+    case 35:
+        // Send MID 0x64/3c, to get back MID 0x64/99
+        // not on PX1172RH_DS
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x04\x64\x3c\x47\x47\x19\x0d\x0a",
+                        11);
+        break;
+    case 36:
+        // Send MID 0x65/02, to get back MID 0x64/80
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x65\x02\x67\x0d\x0a", 9);
+        break;
+    case 37:
+        // Send MID 0x65/04, to get back MID 0x64/8f
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x65\x04\x61\x0d\x0a", 9);
+        break;
+    case 38:
+        // Send MID 0x6a/02, to get back MID 0x6a/83
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x6a\x02\x68\x0d\x0a", 9);
+        break;
+    case 39:
+        // Send MID 0x6a/07, to get back MID 0x6a/83
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x6a\x07\x6d\x0d\x0a", 9);
+        break;
+    case 40:
+        // Send MID 0x6a/0d, to get back MID 0x6a/85
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x6a\x0d\x67\x0d\x0a", 9);
+        break;
+    case 41:
+        // Send MID 0x6a/14, to get back MID 0x6a/86
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x6a\x14\xfd\x0d\x0a", 9);
+        break;
+    case 42:
+        // Send MID 0x6a/16, to get back MID 0x6a/89
+        // not on PX1172RH_DS ?
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x02\x6a\x16\x7c\x0d\x0a", 9);
+        break;
+    case 43:
+        // Send MID 0x7a/0e/01, to get back MID 0x7a/0e/80
+        // not on PX1172RH_DS ?
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x03\x7a\x0e\x01\x75\x0d\x0a", 10);
+        break;
+    case 44:
+        // Send MID 0x7a/0e/02, to get back MID 0x7a/0e/81
+        // not on PX1172RH_DS ?
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x03\x7a\x0e\x02\x76\x0d\x0a", 10);
+        break;
+    case 45:
+        // Send MID 0x7a/0e/03, to get back MID 0x7a/0e/82
+        // not on PX1172RH_DS ?
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x03\x7a\x0e\x03\x77\x0d\x0a", 10);
+        break;
+    case 46:
+        // Send MID 0x7a/0e/05, to get back MID 0x7a/0e/83
+        // not on PX1172RH_DS ?
+        (void)sky_write(session,
+                        "\xA0\xA1\x00\x03\x7a\x0e\x05\x71\x0d\x0a", 10);
+        break;
+    default:
+        // Done, past config_steps
+        return;
     }
+    session->cfg_wait = true;
+}
 
+static gps_mask_t skybin_parse_input(struct gps_device_t *session)
+{
     if (SKY_PACKET == session->lexer.type) {
         return  sky_parse(session, session->lexer.outbuffer,
                         session->lexer.outbuflen);
@@ -1910,7 +1967,7 @@ const struct gps_type_t driver_skytraq =
 {
     .channels       = SKY_CHANNELS,          // consumer-grade GPS
     .control_send   = sky_write,             // how to send a control string
-    .event_hook     = NULL,                  // lifetime event handler
+    .event_hook     = skybin_event_hook,     // lifetime event handler
     .flags          = DRIVER_STICKY,         // remember this
     .get_packet     = packet_get1,           // be prepared for Skytraq or NMEA
     .init_query     = NULL,                  // non-perturbing initial qury
@@ -1921,6 +1978,7 @@ const struct gps_type_t driver_skytraq =
     .rtcm_writer    = gpsd_write,            // send RTCM data straight
     .trigger        = NULL,                  // no trigger
     .type_name      = "Skytraq",             // full name of type
+    .config_steps   = 47,                    // init queries
 };
 // *INDENT-ON*
 #endif  // defined SKYTRAQ_ENABLE)
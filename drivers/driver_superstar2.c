@@ -308,6 +308,7 @@ superstar2_msg_measurement(struct gps_device_t *session, unsigned char *buf,
     /* this is so we can tell which never got set */
     for (i = 0; i < MAXCHANNELS; i++)
         session->gpsdata.raw.meas[i].svid = 0;
+    session->gpsdata.raw.nmeas = n;
     for (i = 0; i < n; i++) {
         unsigned long ul;
         session->gpsdata.skyview[i].PRN =
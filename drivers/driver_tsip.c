@@ -6010,14 +6010,6 @@ static void tsip_event_hook(struct gps_device_t *session, event_t event)
          * Once we have the x45, we can decide how to configure */
         (void)tsip_write1(session, "\x1f", 1);
         break;
-    case EVENT_CONFIGURE:
-        // this seems to get called on every packet...
-        if (0 == session->lexer.counter) {
-            /* but the above if() makes it never execute
-             * formerely tried to force 801 here, but luckily it
-             * never fired as some Trimble are 8N1 */
-        }
-        break;
     case EVENT_DEACTIVATE:
         // used to revert serial port parms here.  No need for that.
         FALLTHROUGH
@@ -3992,16 +3992,19 @@ static gps_mask_t ubx_msg_rxm_rawx(struct gps_device_t *session,
     // RINEX 3 "GPS time", not UTC, no leap seconds
     session->gpsdata.raw.mtime = gpsd_gpstime(session, week, ts_tow);
 
-    /* zero the measurement data
-     * so we can tell which meas never got set */
-    memset(session->gpsdata.raw.meas, 0, sizeof(session->gpsdata.raw.meas));
-
     if (numMeas > MAXCHANNELS) {
         GPSD_LOG(LOG_WARN, &session->context->errout,
                  "UBX: RXM-RAWX: too many measurements (%u)",
                  numMeas);
+        session->gpsdata.raw.nmeas = 0;
         return 0;
     }
+
+    /* zero the measurement data, only the slots this epoch uses,
+     * so we can tell which meas never got set */
+    memset(session->gpsdata.raw.meas, 0,
+           numMeas * sizeof(session->gpsdata.raw.meas[0]));
+    session->gpsdata.raw.nmeas = numMeas;
     for (i = 0; i < numMeas; i++) {
         int off = 32 * i;
         // pseudorange in meters
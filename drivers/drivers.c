@@ -125,10 +125,10 @@ static void nmea_event_hook(struct gps_device_t *session, event_t event)
      */
     if (event == EVENT_CONFIGURE) {
         /*
-         * The reason for splitting these probes up by packet sequence
-         * number, interleaving them with the first few packet receives,
-         * is because many generic-NMEA devices get confused if you send
-         * too much at them in one go.
+         * The reason for splitting these probes up into configuration
+         * steps, paced out by gpsd_configure(), is because many
+         * generic-NMEA devices get confused if you send too much at
+         * them in one go.
          *
          * A fast response to an early probe will change drivers so the
          * later ones won't be sent at all.  Thus, for best overall
@@ -141,7 +141,7 @@ static void nmea_event_hook(struct gps_device_t *session, event_t event)
          * a comma to the trigger, because that won't be in the response
          * unless there is actual following data.
          */
-        switch (session->lexer.counter) {
+        switch (session->cfg_stage) {
         case 0:
             // probe for Garmin serial GPS -- expect $PGRMC followed by data
             GPSD_LOG(LOG_PROG, &session->context->errout,
@@ -274,6 +274,7 @@ const struct gps_type_t driver_nmea0183 = {
     .min_cycle.tv_nsec = 0,             // not relevant, no rate switch
     .control_send   = nmea_write,       // how to send control strings
     .time_offset     = NULL,            // no method for NTP fudge factor
+    .config_steps   = 11,               // subtype probes
 };
 // *INDENT-ON*
 
@@ -306,20 +307,17 @@ static void garmin_nmea_event_hook(struct gps_device_t *session,
         return;
     }
 
-    if (event == EVENT_DRIVER_SWITCH) {
-        // forces a reconfigure as the following packets come in
-        session->lexer.counter = 0;
-    }
     if (session->context->passive) {
         return;
     }
     if (event == EVENT_CONFIGURE) {
         /*
-         * And here's that reconfigure.  It's split up like this because
+         * The driver switch restarts the configuration sequence, and
+         * here's that reconfigure.  It's split up like this because
          * receivers like the Garmin GPS-10 don't handle having having a lot of
          * probes shoved at them very well.
          */
-        switch (session->lexer.counter) {
+        switch (session->cfg_stage) {
         case 0:
             /* reset some config, AutoFix, WGS84, PPS
              * Set the PPS pulse length to 40ms which leaves the Garmin 18-5hz
@@ -378,6 +376,7 @@ const struct gps_type_t driver_garmin = {
     .min_cycle.tv_nsec = 0,             // not relevant, no rate switch
     .control_send   = nmea_write,       // how to send control strings
     .time_offset     = NULL,            // no method for NTP fudge factor
+    .config_steps   = 8,                // reset, then choose sentences
 };
 // *INDENT-ON*
 #endif  // GARMIN_ENABLE
@@ -1129,12 +1128,8 @@ static void isync_event_hook(struct gps_device_t *session, event_t event)
         return;
     }
 
-    if (event == EVENT_DRIVER_SWITCH) {
-        session->lexer.counter = 0;
-    }
-
     if (event == EVENT_CONFIGURE) {
-        switch (session->lexer.counter) {
+        switch (session->cfg_stage) {
         case 1:
             /* Configure timing and frequency flags:
              *  - Thermal compensation active
@@ -1231,6 +1226,7 @@ const struct gps_type_t driver_isync = {
     .min_cycle.tv_nsec = 0,             // not relevant, no rate switch
     .control_send   = nmea_write,       // how to send control strings
     .time_offset     = NULL,            // no method for NTP fudge factor
+    .config_steps   = 7,                // step 0 lets the switch settle
 };
 // *INDENT-ON*
 #endif  // ISYNC_ENABLE
@@ -1442,7 +1438,7 @@ static bool aivdm_decode(unsigned char *buf, size_t buflen,
                                  ais,
                                  ais_context->bits,
                                  ais_context->bitlen,
-                                 &ais_context->type24_queue);
+                                 &session->driver.aivdm.type24);
     }
 
     // we're still waiting on another sentence
@@ -1634,6 +1630,7 @@ const struct gps_type_t driver_pps = {
 
 extern const struct gps_type_t driver_allystar;
 extern const struct gps_type_t driver_evermore;
+extern const struct gps_type_t driver_federation;
 extern const struct gps_type_t driver_garmin_ser_binary;
 extern const struct gps_type_t driver_garmin_usb_binary;
 extern const struct gps_type_t driver_geostar;
@@ -1735,9 +1732,45 @@ static const struct gps_type_t *gpsd_driver_array[] = {
 #endif  // GARMINTXT_ENABLE
 
     &driver_json_passthrough,
+    // after json_passthrough, only fed_open() selects it
+    &driver_federation,
     &driver_pps,
     NULL,
 };
 
 const struct gps_type_t **gpsd_drivers = &gpsd_driver_array[0];
+
+/*
+ * USB IDs that are always a GPS, so hotplug can say what to open.
+ * Not the USB-serial bridges (pl2303, cp210x, ...) in gpsd.rules,
+ * anything at all might be behind those.  The speed is the receiver's
+ * factory default; a CDC ACM port ignores it, but opening at it
+ * saves hunting when the tty was left at some other speed.
+ */
+static const struct device_profile_t device_profiles[] = {
+#ifdef GARMIN_ENABLE
+    {0x091e, 0x0003, &driver_garmin_usb_binary, 9600},  // Garmin USB
+#endif  // GARMIN_ENABLE
+    {0x0e8d, 0x3329, &driver_mtk3301, 9600},            // MediaTek, ACM
+    {0x1546, 0x01a5, &driver_ubx, 9600},                // u-blox 5, ACM
+    {0x1546, 0x01a6, &driver_ubx, 9600},                // u-blox 6, ACM
+    {0x1546, 0x01a7, &driver_ubx, 9600},                // u-blox 7, ACM
+    {0x1546, 0x01a8, &driver_ubx, 9600},                // u-blox 8, ACM
+    {0x1546, 0x01a9, &driver_ubx, 9600},                // u-blox 9, ACM
+};
+
+// the profile for USB vendor:product, NULL if none
+const struct device_profile_t *gpsd_device_profile(unsigned int vendor,
+                                                   unsigned int product)
+{
+    unsigned i;
+
+    for (i = 0; i < ROWS(device_profiles); i++) {
+        if (vendor == device_profiles[i].vendor &&
+            product == device_profiles[i].product) {
+            return &device_profiles[i];
+        }
+    }
+    return NULL;
+}
 // vim: set expandtab shiftwidth=4
@@ -808,7 +808,7 @@ int main(int argc, char **argv)
             }
 
             switch(gpsd_multipoll(FD_ISSET(session.gpsdata.gps_fd, &rfds),
-                                           &session, ctlhook, 0)) {
+                                           &session, ctlhook, 0, 0)) {
             case DEVICE_READY:
                 FD_SET(session.gpsdata.gps_fd, &all_fds);
                 break;
@@ -0,0 +1,446 @@
+/****************************************************************************
+
+NAME
+   ais_vessels.c - the daemon's picture of the AIS traffic it has heard
+
+DESCRIPTION
+   AIS decoding is stateless, every message is reported on its own.  A
+client that connects late has to listen for minutes before it has seen
+a position and the static data of every vessel around.  This module
+keeps the latest position message and the static and voyage data
+(type 5 and type 24 parts A and B, merged field by field) for each
+MMSI, so ?AIS can hand a new client the whole picture at once.  Only
+the message type's own member of the struct ais_t union is kept, not
+the whole union.
+
+   Vessels live in a fixed array of MAX_AIS_VESSELS entries, found
+through an open addressing (linear probing) hash on the MMSI.  Vessels
+not heard from for AIS_VESSEL_AGE seconds are dropped, a few on each
+update.  When the table is full the vessel heard from longest ago makes
+room.
+
+PERMISSIONS
+   This file is Copyright by the GPSD project
+   SPDX-License-Identifier: BSD-2-clause
+
+***************************************************************************/
+
+#include "../include/gpsd_config.h"  // must be before all includes
+
+#include <string.h>
+
+#include "../include/gpsd.h"
+#include "../include/strfuncs.h"
+#include "../include/timespec.h"
+
+#ifdef AIS_VESSELS_ENABLE
+
+#ifndef AIS_VESSEL_AGE
+#define AIS_VESSEL_AGE  600             // seconds
+#endif
+
+// twice the vessels, so probe chains stay short
+#define VESSEL_HASH_SIZE        (2 * MAX_AIS_VESSELS)
+#define EMPTY                   -1
+
+static struct ais_vessel_t vessels[MAX_AIS_VESSELS];
+static int nvessels;
+// index into vessels[], or EMPTY
+static int vessel_hash[VESSEL_HASH_SIZE];
+static bool initialized;
+static int sweep;                       // next vessel to check for age
+
+static unsigned int home_slot(unsigned int mmsi)
+{
+    // Knuth multiplicative hash, MMSIs are far from random
+    return (mmsi * 2654435761U) % VESSEL_HASH_SIZE;
+}
+
+static void vessels_init(void)
+{
+    int i;
+
+    for (i = 0; i < VESSEL_HASH_SIZE; i++) {
+        vessel_hash[i] = EMPTY;
+    }
+    nvessels = 0;
+    sweep = 0;
+    initialized = true;
+}
+
+// return the hash slot of mmsi, or of the empty slot that ends its chain
+static unsigned int find_slot(unsigned int mmsi)
+{
+    unsigned int slot = home_slot(mmsi);
+
+    while (EMPTY != vessel_hash[slot] &&
+           vessels[vessel_hash[slot]].mmsi != mmsi) {
+        slot = (slot + 1) % VESSEL_HASH_SIZE;
+    }
+    return slot;
+}
+
+/* Remove vessels[idx].  The last vessel moves into its place, so
+ * vessels[] stays dense, and the hash chain is closed up by shifting
+ * back later entries (no tombstones).
+ */
+static void vessel_remove(int idx)
+{
+    unsigned int hole = find_slot(vessels[idx].mmsi);
+    unsigned int next = hole;
+
+    for (;;) {
+        unsigned int home;
+
+        next = (next + 1) % VESSEL_HASH_SIZE;
+        if (EMPTY == vessel_hash[next]) {
+            break;
+        }
+        home = home_slot(vessels[vessel_hash[next]].mmsi);
+        // leave it if home is cyclically in (hole, next]
+        if (hole <= next ? (hole < home && home <= next)
+                         : (hole < home || home <= next)) {
+            continue;
+        }
+        vessel_hash[hole] = vessel_hash[next];
+        hole = next;
+    }
+    vessel_hash[hole] = EMPTY;
+
+    nvessels--;
+    if (idx != nvessels) {
+        vessels[idx] = vessels[nvessels];
+        vessel_hash[find_slot(vessels[idx].mmsi)] = idx;
+    }
+}
+
+static bool vessel_stale(const struct ais_vessel_t *vessel,
+                         const timespec_t *now)
+{
+    return AIS_VESSEL_AGE < now->tv_sec - vessel->seen.tv_sec;
+}
+
+// make room for one more vessel, dropping the one heard from longest ago
+static void vessel_evict(void)
+{
+    int oldest = 0;
+    int i;
+
+    for (i = 1; i < nvessels; i++) {
+        if (TS_GT(&vessels[oldest].seen, &vessels[i].seen)) {
+            oldest = i;
+        }
+    }
+    vessel_remove(oldest);
+}
+
+// size of the struct ais_t union member of type, 0 if not kept
+static size_t body_size(unsigned int type)
+{
+    switch (type) {
+    case 1:
+        FALLTHROUGH
+    case 2:
+        FALLTHROUGH
+    case 3:
+        return AIS_BODY_SIZE(type1);
+    case 4:
+        FALLTHROUGH
+    case 11:
+        return AIS_BODY_SIZE(type4);
+    case 5:
+        return AIS_BODY_SIZE(type5);
+    case 9:
+        return AIS_BODY_SIZE(type9);
+    case 18:
+        return AIS_BODY_SIZE(type18);
+    case 19:
+        return AIS_BODY_SIZE(type19);
+    case 21:
+        return AIS_BODY_SIZE(type21);
+    case 24:
+        return AIS_BODY_SIZE(type24);
+    case 27:
+        return AIS_BODY_SIZE(type27);
+    default:
+        return 0;
+    }
+}
+
+// all members of the struct ais_t union start where type1 does
+static void vessel_store(unsigned char *type, unsigned char *repeat,
+                         unsigned char *body, const struct ais_t *ais)
+{
+    *type = (unsigned char)ais->type;
+    *repeat = (unsigned char)ais->repeat;
+    memcpy(body, &ais->type1, body_size(ais->type));
+}
+
+/* Rebuild the vessel's latest position report, or with info its
+ * static data, into *ais.  False, and *ais type 0, if there is none.
+ */
+bool ais_vessel_message(const struct ais_vessel_t *vessel, bool info,
+                        struct ais_t *ais)
+{
+    unsigned int type = info ? vessel->info_type : vessel->position_type;
+
+    memset(ais, 0, sizeof(*ais));
+    if (0 == type) {
+        return false;
+    }
+    ais->type = type;
+    ais->repeat = info ? vessel->info_repeat : vessel->position_repeat;
+    ais->mmsi = vessel->mmsi;
+    memcpy(&ais->type1, info ? vessel->info : vessel->position,
+           body_size(type));
+    return true;
+}
+
+static bool no_dimensions(unsigned int to_bow, unsigned int to_stern,
+                          unsigned int to_port, unsigned int to_starboard)
+{
+    return 0 == to_bow && 0 == to_stern &&
+           0 == to_port && 0 == to_starboard;
+}
+
+/* Merge a type 5 into the vessel's static data.  Its fields win, but
+ * an empty name, callsign, ship type or dimensions keeps what an
+ * earlier type 5 or type 24 said.
+ */
+static void merge_type5(struct ais_t *info, const struct ais_t *ais)
+{
+    struct ais_t old = *info;
+
+    *info = *ais;
+    if (5 == old.type) {
+        if ('\0' == info->type5.shipname[0]) {
+            (void)strlcpy(info->type5.shipname, old.type5.shipname,
+                          sizeof(info->type5.shipname));
+        }
+        if ('\0' == info->type5.callsign[0]) {
+            (void)strlcpy(info->type5.callsign, old.type5.callsign,
+                          sizeof(info->type5.callsign));
+        }
+        if ('\0' == info->type5.destination[0]) {
+            (void)strlcpy(info->type5.destination, old.type5.destination,
+                          sizeof(info->type5.destination));
+        }
+        if (0 == info->type5.imo) {
+            info->type5.imo = old.type5.imo;
+        }
+        if (0 == info->type5.shiptype) {
+            info->type5.shiptype = old.type5.shiptype;
+        }
+        if (no_dimensions(info->type5.to_bow, info->type5.to_stern,
+                          info->type5.to_port, info->type5.to_starboard)) {
+            info->type5.to_bow = old.type5.to_bow;
+            info->type5.to_stern = old.type5.to_stern;
+            info->type5.to_port = old.type5.to_port;
+            info->type5.to_starboard = old.type5.to_starboard;
+        }
+    } else if (24 == old.type) {
+        if ('\0' == info->type5.shipname[0]) {
+            (void)strlcpy(info->type5.shipname, old.type24.shipname,
+                          sizeof(info->type5.shipname));
+        }
+        if ('\0' == info->type5.callsign[0]) {
+            (void)strlcpy(info->type5.callsign, old.type24.callsign,
+                          sizeof(info->type5.callsign));
+        }
+        if (0 == info->type5.shiptype) {
+            info->type5.shiptype = old.type24.shiptype;
+        }
+        if (!AIS_AUXILIARY_MMSI(old.mmsi) &&
+            no_dimensions(info->type5.to_bow, info->type5.to_stern,
+                          info->type5.to_port, info->type5.to_starboard)) {
+            info->type5.to_bow = old.type24.dim.to_bow;
+            info->type5.to_stern = old.type24.dim.to_stern;
+            info->type5.to_port = old.type24.dim.to_port;
+            info->type5.to_starboard = old.type24.dim.to_starboard;
+        }
+    }
+}
+
+/* Merge a type 24 part into the vessel's static data.  Parts A and B
+ * are combined.  A vessel that also sends type 5 stays a type 5, with
+ * the newer name, callsign, ship type and dimensions of the type 24
+ * folded in.  Either way an empty field never wipes a known one.
+ */
+static void merge_type24(struct ais_t *info, const struct ais_t *ais)
+{
+    bool part_a_in = part_b != ais->type24.part;
+    bool part_b_in = part_a != ais->type24.part;
+
+    if (5 == info->type) {
+        if (part_a_in &&
+            '\0' != ais->type24.shipname[0]) {
+            (void)strlcpy(info->type5.shipname, ais->type24.shipname,
+                          sizeof(info->type5.shipname));
+        }
+        if (!part_b_in) {
+            return;
+        }
+        if ('\0' != ais->type24.callsign[0]) {
+            (void)strlcpy(info->type5.callsign, ais->type24.callsign,
+                          sizeof(info->type5.callsign));
+        }
+        if (0 != ais->type24.shiptype) {
+            info->type5.shiptype = ais->type24.shiptype;
+        }
+        if (!AIS_AUXILIARY_MMSI(ais->mmsi) &&
+            !no_dimensions(ais->type24.dim.to_bow, ais->type24.dim.to_stern,
+                           ais->type24.dim.to_port,
+                           ais->type24.dim.to_starboard)) {
+            info->type5.to_bow = ais->type24.dim.to_bow;
+            info->type5.to_stern = ais->type24.dim.to_stern;
+            info->type5.to_port = ais->type24.dim.to_port;
+            info->type5.to_starboard = ais->type24.dim.to_starboard;
+        }
+        return;
+    }
+    if (24 != info->type) {
+        *info = *ais;
+        return;
+    }
+
+    info->repeat = ais->repeat;
+    if (ais->type24.part != info->type24.part) {
+        info->type24.part = both;
+    }
+    if (part_a_in &&
+        '\0' != ais->type24.shipname[0]) {
+        (void)strlcpy(info->type24.shipname, ais->type24.shipname,
+                      sizeof(info->type24.shipname));
+    }
+    if (!part_b_in) {
+        return;
+    }
+    info->type24.shiptype = ais->type24.shiptype;
+    (void)strlcpy(info->type24.vendorid, ais->type24.vendorid,
+                  sizeof(info->type24.vendorid));
+    info->type24.model = ais->type24.model;
+    info->type24.serial = ais->type24.serial;
+    if ('\0' != ais->type24.callsign[0]) {
+        (void)strlcpy(info->type24.callsign, ais->type24.callsign,
+                      sizeof(info->type24.callsign));
+    }
+    if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
+        info->type24.mothership_mmsi = ais->type24.mothership_mmsi;
+    } else {
+        info->type24.dim = ais->type24.dim;
+    }
+}
+
+// fold one decoded AIS message, heard at now, into the vessel table
+void ais_vessel_update(const struct ais_t *ais, const timespec_t *now)
+{
+    struct ais_vessel_t *vessel;
+    unsigned int slot;
+
+    if (0 == ais->mmsi) {
+        return;
+    }
+    if (!initialized) {
+        vessels_init();
+    }
+
+    // age out a couple of vessels per message, cheap and steady
+    if (0 < nvessels) {
+        int n;
+
+        for (n = 0; n < 2 && 0 < nvessels; n++) {
+            if (sweep >= nvessels) {
+                sweep = 0;
+            }
+            if (vessel_stale(&vessels[sweep], now)) {
+                vessel_remove(sweep);
+            } else {
+                sweep++;
+            }
+        }
+    }
+
+    slot = find_slot(ais->mmsi);
+    if (EMPTY == vessel_hash[slot]) {
+        if (MAX_AIS_VESSELS <= nvessels) {
+            vessel_evict();
+            slot = find_slot(ais->mmsi);
+        }
+        vessel_hash[slot] = nvessels;
+        vessel = &vessels[nvessels++];
+        memset(vessel, 0, sizeof(*vessel));
+        vessel->mmsi = ais->mmsi;
+    } else {
+        vessel = &vessels[vessel_hash[slot]];
+    }
+    vessel->seen = *now;
+
+    switch (ais->type) {
+    case 1:
+        FALLTHROUGH
+    case 2:
+        FALLTHROUGH
+    case 3:
+        FALLTHROUGH
+    case 4:
+        FALLTHROUGH
+    case 9:
+        FALLTHROUGH
+    case 11:
+        FALLTHROUGH
+    case 18:
+        FALLTHROUGH
+    case 19:
+        FALLTHROUGH
+    case 21:
+        FALLTHROUGH
+    case 27:
+        vessel_store(&vessel->position_type, &vessel->position_repeat,
+                     vessel->position, ais);
+        break;
+    case 5:
+        FALLTHROUGH
+    case 24:
+        {
+            struct ais_t info;
+
+            (void)ais_vessel_message(vessel, true, &info);
+            if (5 == ais->type) {
+                merge_type5(&info, ais);
+            } else {
+                merge_type24(&info, ais);
+            }
+            vessel_store(&vessel->info_type, &vessel->info_repeat,
+                         vessel->info, &info);
+        }
+        break;
+    default:
+        // nothing about the vessel itself
+        break;
+    }
+}
+
+/* Iterate over the vessels heard from within AIS_VESSEL_AGE before
+ * now.  Start with *cursor zero, each call returns the next vessel and
+ * advances *cursor, NULL at the end.  The table may change between
+ * calls, so a vessel added or removed meanwhile can be missed.
+ */
+const struct ais_vessel_t *ais_vessel_next(int *cursor,
+                                           const timespec_t *now)
+{
+    if (!initialized) {
+        return NULL;
+    }
+    while (*cursor < nvessels) {
+        const struct ais_vessel_t *vessel = &vessels[(*cursor)++];
+
+        if (!vessel_stale(vessel, now)) {
+            return vessel;
+        }
+    }
+    return NULL;
+}
+
+#endif  // AIS_VESSELS_ENABLE
+
+// vim: set expandtab shiftwidth=4
@@ -37,6 +37,13 @@
 #include <sys/un.h>
 #include <time.h>
 #include <unistd.h>                  // for setgroups()
+#ifdef HAVE_ZLIB
+    #define ZLIB_CONST               // const input, for deflate()
+    #include <zlib.h>                // for deflate()
+    #ifndef z_const
+        #define z_const              // zlib before 1.2.5.2
+    #endif  // z_const
+#endif  // HAVE_ZLIB
 
 #ifndef AF_UNSPEC
     #include <sys/socket.h>
@@ -102,7 +109,25 @@
 #define DEVICE_REAWAKE          0.01
 #define DEVICE_RECONNECT        2
 
-#define QLEN                    5
+/*
+ * QLEN is the listen() backlog.  It needs to be deep enough that a
+ * burst of clients reconnecting after a network outage is queued by
+ * the kernel rather than refused and left to SYN retry timers.
+ *
+ * ACCEPT_BUDGET caps how many pending connections are accepted from
+ * one listening socket per pass through the main loop, so an accept
+ * storm can not starve the devices.
+ */
+#define QLEN                    64
+#define ACCEPT_BUDGET           16
+
+/*
+ * DEVICE_BUDGET caps how many packets are taken from one device per
+ * pass through the main loop, so a firehose NTRIP or AIS feed can not
+ * hold up the others.  Devices feeding ntpd or chrony are not capped,
+ * and go first, their time hints are only good while fresh.
+ */
+#define DEVICE_BUDGET           32
 
 /*
  * If ntpshm is enabled, we renice the process to this priority level.
@@ -248,6 +273,7 @@ static void usage(void)
   -r, --badtime             = use GPS time even if no fix\n\
   -S, --port PORT           = set port for daemon, default %s\n\
   -s, --speed SPEED         = fix device speed to SPEED, default none\n\
+  -U, --datasock sockfile   = specify local data socket location, default none\n\
   -V, --version             = emit version and exit.\n"
 "\nA device may be a local serial device for GNSS input, plus an optional\n\
 PPS device, or a URL in one of the following forms:\n\
@@ -255,6 +281,7 @@ PPS device, or a URL in one of the following forms:\n\
      udp://host[:port]\n\
      {dgpsip|ntrip}://[user:passwd@]host[:port][/stream]\n\
      gpsd://host[:port][:/device]\n\
+     fed://host[:port][:/device]\n\
 in which case it specifies an input source for device, DGPS or ntrip data.\n"
 "\n\
 The following driver types are compiled into this gpsd instance:\n",
@@ -267,15 +294,20 @@ The following driver types are compiled into this gpsd instance:\n",
 
 }
 
-#ifdef CONTROL_SOCKET_ENABLE
-static socket_t filesock(char *filename)
+#if defined(CONTROL_SOCKET_ENABLE) || defined(SOCKET_EXPORT_ENABLE)
+/* bind a Unix-domain listening socket
+ *
+ * socktype is SOCK_STREAM for the control socket, SOCK_SEQPACKET
+ * for the local data socket.
+ */
+static socket_t filesock(char *filename, int socktype)
 {
     struct sockaddr_un addr;
     socket_t sock;
 
-    if (BAD_SOCKET(sock = socket(AF_UNIX, SOCK_STREAM, 0))) {
+    if (BAD_SOCKET(sock = socket(AF_UNIX, socktype, 0))) {
         GPSD_LOG(LOG_ERROR, &context.errout,
-                 "Can't create device-control socket. %s(%d)\n",
+                 "Can't create local socket. %s(%d)\n",
                  strerror(errno), errno);
         return -1;
     }
@@ -299,7 +331,7 @@ static socket_t filesock(char *filename)
     // coverity[leaked_handle] This is an intentional allocation
     return sock;
 }
-#endif  // CONTROL_SOCKET_ENABLE
+#endif  // CONTROL_SOCKET_ENABLE || SOCKET_EXPORT_ENABLE
 
 #define sub_index(s) (int)((s) - subscribers)
 #define allocated_device(devp)   ('\0' != (devp)->gpsdata.dev.path[0])
@@ -544,18 +576,68 @@ static int passivesocks(char *service, char *tcp_or_udp,
     return numsocks;
 }
 
+#ifdef AIVDM_ENABLE
+/* What a client's AIS filter remembers about a vessel: only those whose
+ * last position passed its area filter, or all with a position when it
+ * has none.  An open addressing (linear probing) hash on the MMSI, that
+ * starts small and doubles as vessels come in, up to AIS_SEEN_MAX
+ * slots.  Then the vessel heard from longest ago makes room. */
+#define AIS_SEEN_MIN    64      // slots, a power of 2
+#if defined(MAX_AIS_VESSELS) && 0 < MAX_AIS_VESSELS
+#define AIS_SEEN_MAX    (2 * MAX_AIS_VESSELS)
+#else
+#define AIS_SEEN_MAX    2048
+#endif
+struct ais_seen_t
+{
+    unsigned int mmsi;          // 0 if the slot is empty
+    timespec_t heard;           // its last position
+    timespec_t sent;            // when its last position was sent
+};
+#endif  // AIVDM_ENABLE
+
+// send buffer of a "latest" client, about one large report
+#define LATEST_SNDBUF   GPS_JSON_RESPONSE_MAX
+
 struct subscriber_t
 {
     int fd;                       // client file descriptor. -1 if unused
     time_t active;                // when subscriber last polled for data
     struct gps_policy_t policy;   // configurable bits
     pthread_mutex_t mutex;        // serialize access to fd
+    struct watch_rate_t rates;    // decimation, from ?WATCH
+    timespec_t rate_due[RATE_CLASSES];  // next report of each class due
+    bool backlog;                 // a write found the socket full
+    bool sndbuf_cut;              // SO_SNDBUF shrunk for "latest"
+    char *held;                   // rest of a report cut short, or NULL
+    size_t held_len;              // bytes in held
+    struct delta_t delta;         // what TPV and SKY deltas build on
+#ifdef HAVE_ZLIB
+    z_stream *deflate;            // compressed stream, NULL if plain
+    bool zstart;                  // compress after the ?WATCH reply
+    bool zhold;                   // do not flush, the epoch goes on
+    bool zheld;                   // output held back since the last flush
+#endif  // HAVE_ZLIB
+#ifdef AIVDM_ENABLE
+    struct ais_filter_t aisfilter;      // from ?WATCH
+    struct ais_seen_t *aisseen;         // aisfilter state, or NULL
+    unsigned int aisseen_size;          // slots in aisseen
+    unsigned int aisseen_count;         // vessels in aisseen
+#endif  // AIVDM_ENABLE
+#ifdef AIS_VESSELS_ENABLE
+    bool aissnap;                 // ?AIS snapshot being sent
+    int aissnap_cursor;           // next vessel of it
+    int aissnap_count;            // vessels sent so far
+#endif  // AIS_VESSELS_ENABLE
 };
 
 #define subscribed(sub, devp)    (sub->policy.watcher && (sub->policy.devpath[0]=='\0' || strcmp(sub->policy.devpath, devp->gpsdata.dev.path)==0))
 
 // indexed by client file descriptor
 static struct subscriber_t subscribers[MAX_CLIENTS];
+#ifdef AIS_VESSELS_ENABLE
+static bool ais_snap_pending;     // some client has an ?AIS snapshot going
+#endif  // AIS_VESSELS_ENABLE
 
 static void lock_subscriber(struct subscriber_t *sub)
 {
@@ -567,6 +649,153 @@ static void unlock_subscriber(struct subscriber_t *sub)
     (void)pthread_mutex_unlock(&sub->mutex);
 }
 
+#ifdef AIVDM_ENABLE
+static unsigned int ais_seen_home(const struct subscriber_t *sub,
+                                  unsigned int mmsi)
+{
+    // Knuth multiplicative hash, MMSIs are far from random
+    return (mmsi * 2654435761U) % sub->aisseen_size;
+}
+
+// return the slot of mmsi, or of the empty slot that ends its chain
+static struct ais_seen_t *ais_seen_slot(const struct subscriber_t *sub,
+                                        unsigned int mmsi)
+{
+    unsigned int slot = ais_seen_home(sub, mmsi);
+
+    while (0 != sub->aisseen[slot].mmsi &&
+           mmsi != sub->aisseen[slot].mmsi) {
+        slot = (slot + 1) % sub->aisseen_size;
+    }
+    return &sub->aisseen[slot];
+}
+
+// return what the client's filter remembers of mmsi, NULL if nothing
+static struct ais_seen_t *ais_seen_find(const struct subscriber_t *sub,
+                                        unsigned int mmsi)
+{
+    struct ais_seen_t *seen;
+
+    if (NULL == sub->aisseen ||
+        0 == mmsi) {
+        return NULL;
+    }
+    seen = ais_seen_slot(sub, mmsi);
+    return 0 == seen->mmsi ? NULL : seen;
+}
+
+/* Forget a vessel.  The hash chain is closed up by shifting back later
+ * entries (no tombstones). */
+static void ais_seen_remove(struct subscriber_t *sub,
+                            struct ais_seen_t *seen)
+{
+    unsigned int hole = (unsigned int)(seen - sub->aisseen);
+    unsigned int next = hole;
+
+    for (;;) {
+        unsigned int home;
+
+        next = (next + 1) % sub->aisseen_size;
+        if (0 == sub->aisseen[next].mmsi) {
+            break;
+        }
+        home = ais_seen_home(sub, sub->aisseen[next].mmsi);
+        // leave it if home is cyclically in (hole, next]
+        if (hole <= next ? (hole < home && home <= next)
+                         : (hole < home || home <= next)) {
+            continue;
+        }
+        sub->aisseen[hole] = sub->aisseen[next];
+        hole = next;
+    }
+    memset(&sub->aisseen[hole], 0, sizeof(sub->aisseen[hole]));
+    sub->aisseen_count--;
+}
+
+// rehash into size slots, false if out of memory
+static bool ais_seen_resize(struct subscriber_t *sub, unsigned int size)
+{
+    struct ais_seen_t *old = sub->aisseen;
+    unsigned int oldsize = sub->aisseen_size;
+    unsigned int i;
+
+    sub->aisseen = (struct ais_seen_t *)calloc(size,
+                                               sizeof(struct ais_seen_t));
+    if (NULL == sub->aisseen) {
+        GPSD_LOG(LOG_WARN, &context.errout,
+                 "client(%d) AIS filter table: %s(%d)\n",
+                 sub_index(sub), strerror(errno), errno);
+        sub->aisseen = old;
+        return false;
+    }
+    sub->aisseen_size = size;
+    for (i = 0; i < oldsize; i++) {
+        if (0 != old[i].mmsi) {
+            *ais_seen_slot(sub, old[i].mmsi) = old[i];
+        }
+    }
+    free(old);
+    return true;
+}
+
+/* Remember vessel mmsi, heard at now.  NULL if it can not be, then the
+ * filter lets its messages through. */
+static struct ais_seen_t *ais_seen_add(struct subscriber_t *sub,
+                                       unsigned int mmsi,
+                                       const timespec_t *now)
+{
+    struct ais_seen_t *seen;
+
+    if (0 == mmsi) {
+        // 0 marks the empty slots
+        return NULL;
+    }
+    // at most half full, so probe chains stay short
+    if (sub->aisseen_size < 2 * (sub->aisseen_count + 1) &&
+        AIS_SEEN_MAX > sub->aisseen_size) {
+        unsigned int size = 2 * sub->aisseen_size;
+
+        if (AIS_SEEN_MIN > size) {
+            size = AIS_SEEN_MIN;
+        }
+        if (AIS_SEEN_MAX < size) {
+            size = AIS_SEEN_MAX;
+        }
+        if (!ais_seen_resize(sub, size)) {
+            return NULL;
+        }
+    }
+    if (sub->aisseen_size < 2 * (sub->aisseen_count + 1)) {
+        struct ais_seen_t *oldest = NULL;
+        unsigned int i;
+
+        for (i = 0; i < sub->aisseen_size; i++) {
+            if (0 != sub->aisseen[i].mmsi &&
+                (NULL == oldest ||
+                 TS_GT(&oldest->heard, &sub->aisseen[i].heard))) {
+                oldest = &sub->aisseen[i];
+            }
+        }
+        ais_seen_remove(sub, oldest);
+    }
+    seen = ais_seen_slot(sub, mmsi);
+    memset(seen, 0, sizeof(*seen));
+    seen->mmsi = mmsi;
+    seen->heard = *now;
+    sub->aisseen_count++;
+    return seen;
+}
+
+// forget all vessels, for a new filter or the end of the session
+static void ais_seen_free(struct subscriber_t *sub)
+{
+    free(sub->aisseen);
+    sub->aisseen = NULL;
+    sub->aisseen_size = 0;
+    sub->aisseen_count = 0;
+}
+#endif  // AIVDM_ENABLE
+
 // return the address of a subscriber structure allocated for a new session
 static struct subscriber_t *allocate_client(void)
 {
@@ -613,41 +842,79 @@ static void detach_client(struct subscriber_t *sub)
     sub->policy.timing = false;
     sub->policy.split24 = false;
     sub->policy.devpath[0] = '\0';
+    memset(&sub->rates, 0, sizeof(sub->rates));
+    memset(&sub->delta, 0, sizeof(sub->delta));
+    sub->backlog = false;
+    sub->sndbuf_cut = false;
+    free(sub->held);
+    sub->held = NULL;
+    sub->held_len = 0;
+#ifdef HAVE_ZLIB
+    if (NULL != sub->deflate) {
+        (void)deflateEnd(sub->deflate);
+        free(sub->deflate);
+        sub->deflate = NULL;
+    }
+    sub->zstart = false;
+    sub->zhold = false;
+    sub->zheld = false;
+#endif  // HAVE_ZLIB
+#ifdef AIVDM_ENABLE
+    memset(&sub->aisfilter, 0, sizeof(sub->aisfilter));
+    ais_seen_free(sub);
+#endif  // AIVDM_ENABLE
+#ifdef AIS_VESSELS_ENABLE
+    sub->aissnap = false;
+#endif  // AIS_VESSELS_ENABLE
     sub->fd = UNALLOCATED_FD;
     unlock_subscriber(sub);
 }
 
-/* write to client -- throttle if it's gone or we're close to buffer overrun
- *
- * Call detach_client() is full string not written.
+/* write the rest of a report the client's socket took only part of,
+ * detach the client on error
  *
- * Return: On success -0 number of bytes written
- *         On shrot write -- zero
- *         On error -- less then zero.
+ * Return: true if all of it is out
  */
-static ssize_t throttled_write(struct subscriber_t *sub, const char *buf,
-                               const size_t len)
+static bool client_write_held(struct subscriber_t *sub)
 {
     ssize_t status;
 
-    if (LOG_CLIENT <= context.errout.debug) {
-        if (isprint((unsigned char) buf[0])) {
-            GPSD_LOG(LOG_CLIENT, &context.errout,
-                     "=> client(%d) len %zu: %s\n",
-                     sub_index(sub), len, buf);
-        } else {
-            const char *cp;
-            char buf2[MAX_PACKET_LENGTH * 3];
+    gpsd_acquire_reporting_lock();
+    status = write(sub->fd, sub->held, sub->held_len);
+    gpsd_release_reporting_lock();
 
-            buf2[0] = '\0';
-            for (cp = buf; cp < buf + len; cp++) {
-                str_appendf(buf2, sizeof(buf2),
-                               "%02x", (unsigned int)(*cp & 0xff));
-            }
-            GPSD_LOG(LOG_CLIENT, &context.errout,
-                     "=> client(%d) len %zu: =%s\n",
-                     sub_index(sub), len, buf2);
+    if (0 > status) {
+        if (EAGAIN != errno &&
+            EINTR != errno) {
+            GPSD_LOG(LOG_INF, &context.errout, "client(%d) write: %s(%d)\n",
+                     sub_index(sub), strerror(errno), errno);
+            detach_client(sub);
         }
+        return false;
+    }
+    sub->held_len -= (size_t)status;
+    if (0 < sub->held_len) {
+        memmove(sub->held, sub->held + status, sub->held_len);
+        return false;
+    }
+    free(sub->held);
+    sub->held = NULL;
+    return true;
+}
+
+/* write buf to the client as it is, detach it on error
+ *
+ * Return: as throttled_write()
+ */
+static ssize_t client_write(struct subscriber_t *sub, const char *buf,
+                            const size_t len)
+{
+    ssize_t status;
+
+    if (NULL != sub->held &&
+        !client_write_held(sub)) {
+        // the stream must stay whole, so this one is lost
+        return UNALLOCATED_FD == sub->fd ? -1 : 0;
     }
 
     gpsd_acquire_reporting_lock();
@@ -661,6 +928,17 @@ static ssize_t throttled_write(struct subscriber_t *sub, const char *buf,
     if ((ssize_t)len == status) {
         return status;
     }
+    if (-1 < status &&
+        sub->sndbuf_cut) {
+        // "latest" expects this, the rest goes out before anything else
+        sub->held = (char *)malloc(len - (size_t)status);
+        if (NULL != sub->held) {
+            memcpy(sub->held, buf + status, len - (size_t)status);
+            sub->held_len = len - (size_t)status;
+            sub->backlog = true;
+            return (ssize_t)len;
+        }
+    }
     if (-1 < status) {
         GPSD_LOG(LOG_INF, &context.errout,
                  "short write disconnecting client(%d), %s(%d)\n",
@@ -673,6 +951,7 @@ static ssize_t throttled_write(struct subscriber_t *sub, const char *buf,
         // no data written, and errno says to retry
         GPSD_LOG(LOG_INF, &context.errout, "client(%d) write: %s(%d)\n",
                  sub_index(sub), strerror(errno), errno);
+        sub->backlog = EAGAIN == errno;
         return 0;
     }
     if (EBADF == errno) {
@@ -690,6 +969,223 @@ static ssize_t throttled_write(struct subscriber_t *sub, const char *buf,
     return status;
 }
 
+#ifdef HAVE_ZLIB
+/* Compress buf into the client's deflate stream and write what comes
+ * out.  Flush, so the client can decode all of it, unless zhold says
+ * more of the same epoch follows.  len may be zero, just to flush.
+ *
+ * Return: as throttled_write()
+ */
+static ssize_t deflate_write(struct subscriber_t *sub, const char *buf,
+                             const size_t len)
+{
+    unsigned char out[GPS_JSON_RESPONSE_MAX];
+    z_stream *zs = sub->deflate;
+    int flush = sub->zhold ? Z_NO_FLUSH : Z_SYNC_FLUSH;
+
+    if (0 == len &&
+        !sub->zheld) {
+        return 0;
+    }
+    zs->next_in = (z_const Bytef *)buf;
+    zs->avail_in = (uInt)len;
+    do {
+        size_t have;
+
+        zs->next_out = out;
+        zs->avail_out = sizeof(out);
+        if (Z_STREAM_ERROR == deflate(zs, flush)) {
+            GPSD_LOG(LOG_ERROR, &context.errout,
+                     "client(%d) deflate failed\n", sub_index(sub));
+            detach_client(sub);
+            return -1;
+        }
+        have = sizeof(out) - zs->avail_out;
+        if (0 < have) {
+            ssize_t status = client_write(sub, (const char *)out, have);
+
+            if ((ssize_t)have != status) {
+                // a gap in the stream would garble the rest of it
+                if (UNALLOCATED_FD != sub->fd) {
+                    detach_client(sub);
+                }
+                return 0 > status ? status : 0;
+            }
+        }
+    } while (0 == zs->avail_out);
+    sub->zheld = Z_NO_FLUSH == flush;
+    return (ssize_t)len;
+}
+
+/* Set up the client's deflate stream, on its ?WATCH.  It is used once
+ * the ?WATCH reply is out, see handle_gpsd_request().
+ *
+ * Return: false if zlib could not start one
+ */
+static bool deflate_start(struct subscriber_t *sub)
+{
+    sub->deflate = calloc(1, sizeof(z_stream));
+    if (NULL == sub->deflate) {
+        return false;
+    }
+    if (Z_OK != deflateInit(sub->deflate, Z_DEFAULT_COMPRESSION)) {
+        free(sub->deflate);
+        sub->deflate = NULL;
+        return false;
+    }
+    GPSD_LOG(LOG_INF, &context.errout, "client(%d) stream compressed\n",
+             sub_index(sub));
+    return true;
+}
+#endif  // HAVE_ZLIB
+
+/* Shrink the client's send buffer for "latest", so a client that stops
+ * reading stalls gpsd's writes after a report or two, not after all
+ * that the kernel would queue.  client_write() then holds the rest of
+ * a report the socket took only part of.  Stream sockets only: the
+ * local SOCK_SEQPACKET one would refuse reports larger than it.  The
+ * buffer stays small for the session.
+ */
+static void latest_start(struct subscriber_t *sub)
+{
+    int type = SOCK_STREAM;
+    socklen_t typelen = sizeof(type);
+    int size = LATEST_SNDBUF;
+
+    if (sub->sndbuf_cut) {
+        return;
+    }
+    (void)getsockopt(sub->fd, SOL_SOCKET, SO_TYPE, &type, &typelen);
+    if (SOCK_STREAM != type) {
+        return;
+    }
+    if (0 != setsockopt(sub->fd, SOL_SOCKET, SO_SNDBUF, &size,
+                        sizeof(size))) {
+        GPSD_LOG(LOG_WARN, &context.errout,
+                 "client(%d) SO_SNDBUF: %s(%d)\n",
+                 sub_index(sub), strerror(errno), errno);
+        return;
+    }
+    sub->sndbuf_cut = true;
+}
+
+/* write to client -- throttle if it's gone or we're close to buffer overrun
+ *
+ * Call detach_client() is full string not written.
+ *
+ * Return: On success -0 number of bytes written
+ *         On shrot write -- zero
+ *         On error -- less then zero.
+ */
+static ssize_t throttled_write(struct subscriber_t *sub, const char *buf,
+                               const size_t len)
+{
+    if (LOG_CLIENT <= context.errout.debug) {
+        if (isprint((unsigned char) buf[0])) {
+            GPSD_LOG(LOG_CLIENT, &context.errout,
+                     "=> client(%d) len %zu: %s\n",
+                     sub_index(sub), len, buf);
+        } else {
+            const char *cp;
+            char buf2[MAX_PACKET_LENGTH * 3];
+
+            buf2[0] = '\0';
+            for (cp = buf; cp < buf + len; cp++) {
+                str_appendf(buf2, sizeof(buf2),
+                               "%02x", (unsigned int)(*cp & 0xff));
+            }
+            GPSD_LOG(LOG_CLIENT, &context.errout,
+                     "=> client(%d) len %zu: =%s\n",
+                     sub_index(sub), len, buf2);
+        }
+    }
+
+#ifdef HAVE_ZLIB
+    if (NULL != sub->deflate &&
+        !sub->zstart) {
+        return deflate_write(sub, buf, len);
+    }
+#endif  // HAVE_ZLIB
+    return client_write(sub, buf, len);
+}
+
+/* accept one pending connection on a listening socket, and greet it
+ *
+ * Return: true if the listen queue may hold more connections
+ *         false if it is empty, or accept() failed
+ */
+static bool accept_client(socket_t msock)
+{
+    sockaddr_t fsin;
+    socklen_t alen = (socklen_t)sizeof(fsin);
+    struct subscriber_t *client;
+    static struct linger linger = { 1, RELEASE_TIMEOUT };
+    char announce[GPS_JSON_RESPONSE_MAX];
+    char *c_ip;
+    socket_t ssock;
+
+#ifdef HAVE_ACCEPT4
+    // one syscall instead of three
+    ssock = accept4(msock, (struct sockaddr *)&fsin, &alen,
+                    SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    ssock = accept(msock, (struct sockaddr *)&fsin, &alen);
+#endif  // HAVE_ACCEPT4
+
+    if (BAD_SOCKET(ssock)) {
+        if (EAGAIN != errno &&
+            EWOULDBLOCK != errno &&
+            EINTR != errno) {
+            GPSD_LOG(LOG_ERROR, &context.errout,
+                     "accept: fail: %s(%d)\n", strerror(errno), errno);
+        }
+        return false;
+    }
+#ifndef HAVE_ACCEPT4
+    {
+        int opts = fcntl(ssock, F_GETFL);
+
+        if (0 <= opts) {
+            (void)fcntl(ssock, F_SETFL, opts | O_NONBLOCK);
+        }
+    }
+#endif  // HAVE_ACCEPT4
+
+    c_ip = netlib_sock2ip(ssock);
+    client = allocate_client();
+    if (NULL == client) {
+        // cast for 32-bit intptr_t
+        GPSD_LOG(LOG_ERROR, &context.errout,
+                 "Client %s connect on fd %ld -"
+                 "no subscriber slots available\n", c_ip,
+                  (long)ssock);
+        (void)close(ssock);
+        // keep draining, the rest of the queue gets the same answer
+        return true;
+    }
+    if (-1 == setsockopt(ssock, SOL_SOCKET, SO_LINGER, (char *)&linger,
+                         (int)sizeof(struct linger))) {
+        GPSD_LOG(LOG_ERROR, &context.errout,
+                 "Error: SETSOCKOPT SO_LINGER. %s(%d)\n",
+                 strerror(errno), errno);
+        (void)close(ssock);
+        client->fd = UNALLOCATED_FD;
+        return true;
+    }
+    FD_SET(ssock, &all_fds);
+    adjust_max_fd(ssock, true);
+    client->fd = ssock;
+    client->active = time(NULL);
+    // cast for 32-bit intptr_t
+    GPSD_LOG(LOG_SPIN, &context.errout,
+             "client %s (%d) connect on fd %ld\n", c_ip,
+             sub_index(client), (long)ssock);
+    json_version_dump(announce, sizeof(announce));
+    (void)throttled_write(client, announce,
+                          strnlen(announce, sizeof(announce)));
+    return true;
+}
+
 // notify all JSON-watching clients of a given device about an event
 static void notify_watchers(struct gps_device_t *device,
                             bool onjson, bool onpps,
@@ -837,10 +1333,12 @@ static bool open_device( struct gps_device_t *device)
 }
 
 /* add a device to the pool; open it right away if in nowait mode
+ * profile, from hotplug, may be NULL
  * return: false on failure
  *         true on success
  */
-bool gpsd_add_device(const char *device_name, bool flag_nowait)
+static bool add_device(const char *device_name, bool flag_nowait,
+                       const struct device_profile_t *profile)
 {
     struct gps_device_t *devp;
     bool ret = false;
@@ -861,6 +1359,9 @@ bool gpsd_add_device(const char *device_name, bool flag_nowait)
         if (!allocated_device(devp)) {
             gpsd_init(devp, &context, device_name);
             devp->gpsdata.update_fd = device_update_fd;
+            // gpsd_serial_open() takes its speed, unless -s
+            devp->profile = profile;
+            (void)clock_gettime(CLOCK_MONOTONIC, &devp->attach_time);
             ntpshm_session_init(devp);
             GPSD_LOG(LOG_INF, &context.errout,
                      "stashing device %s at slot %d\n",
@@ -884,6 +1385,11 @@ bool gpsd_add_device(const char *device_name, bool flag_nowait)
     return ret;
 }
 
+bool gpsd_add_device(const char *device_name, bool flag_nowait)
+{
+    return add_device(device_name, flag_nowait, NULL);
+}
+
 #if defined(SOCKET_EXPORT_ENABLE) || defined(CONTROL_SOCKET_ENABLE)
 /* convert hex, with length len, to binary, write it, unchanged, to GPS
  * Returns: NULL, or pointer to error string
@@ -969,8 +1475,21 @@ static void handle_control(int sfd, char *buf)
         } else
             ignore_return(write(sfd, ERROR, sizeof(ERROR) - 1));
     } else if ('+' == buf[0]) {
-        // add device named after +
-        (void)snarfline(buf + 1, &stash);
+        // add device named after +, maybe followed by vendor:product
+        const struct device_profile_t *profile = NULL;
+        unsigned vendor, product;
+        char serial[65] = "";
+        char *rest = snarfline(buf + 1, &stash);
+
+        if (2 <= sscanf(rest, " %4x:%4x:%64[!-~]",
+                        &vendor, &product, serial)) {
+            profile = gpsd_device_profile(vendor, product);
+            GPSD_LOG(LOG_INF, &context.errout,
+                     "<= control(%d): %s is USB %04x:%04x %s, %s\n", sfd,
+                     stash, vendor, product, serial,
+                     NULL == profile ? "no profile" :
+                     profile->driver->type_name);
+        }
         if (find_device(stash)) {
             GPSD_LOG(LOG_INF, &context.errout,
                      "<= control(%d): %s already active \n", sfd,
@@ -979,7 +1498,7 @@ static void handle_control(int sfd, char *buf)
         } else {
             GPSD_LOG(LOG_INF, &context.errout,
                      "<= control(%d): adding %s\n", sfd, stash);
-            if (gpsd_add_device(stash, nowait)) {
+            if (add_device(stash, nowait, profile)) {
                 ignore_return(write(sfd, ACK, sizeof(ACK) - 1));
             } else {
                 ignore_return(write(sfd, ERROR, sizeof(ERROR) - 1));
@@ -1287,6 +1806,40 @@ static void handle_request(struct subscriber_t *sub, const char *buf,
             char *host, *port, *device;  // for parse_uri_dest()
             int status = json_watch_read(buf + 1, &sub->policy, &end);
 
+            if (0 == status) {
+                status = json_watch_rate_read(buf + 1, &sub->rates, NULL);
+                memset(sub->rate_due, 0, sizeof(sub->rate_due));
+                memset(&sub->delta, 0, sizeof(sub->delta));
+                if (0 == status &&
+                    sub->rates.latest) {
+                    latest_start(sub);
+                }
+#ifdef HAVE_ZLIB
+                if (NULL != sub->deflate) {
+                    // once compressed, the stream stays so
+                    (void)strlcpy(sub->rates.compress, "deflate",
+                                  sizeof(sub->rates.compress));
+                } else if ('\0' != sub->rates.compress[0]) {
+                    int type = SOCK_STREAM;
+                    socklen_t typelen = sizeof(type);
+
+                    // the local data socket keeps reports whole, plain
+                    (void)getsockopt(sub->fd, SOL_SOCKET, SO_TYPE, &type,
+                                     &typelen);
+                    if (SOCK_STREAM != type) {
+                        sub->rates.compress[0] = '\0';
+                    } else {
+                        sub->zstart = true;
+                    }
+                }
+#endif  // HAVE_ZLIB
+            }
+#ifdef AIVDM_ENABLE
+            if (0 == status) {
+                status = json_ais_filter_read(buf + 1, &sub->aisfilter, NULL);
+                ais_seen_free(sub);
+            }
+#endif  // AIVDM_ENABLE
             if (NULL == end) {
                 buf += strnlen(buf, bufsize - 1);
             } else {
@@ -1295,6 +1848,21 @@ static void handle_request(struct subscriber_t *sub, const char *buf,
                 }
                 buf = end;
             }
+#ifdef HAVE_ZLIB
+            if (0 != status) {
+                sub->zstart = false;
+            } else if (sub->zstart &&
+                       !deflate_start(sub)) {
+                // the reply must not promise a compressed stream
+                sub->zstart = false;
+                sub->rates.compress[0] = '\0';
+                (void)strlcpy(reply,
+                              "{\"class\":\"ERROR\",\"message\":"
+                              "\"Can't compress the stream\"}\r\n",
+                              replylen);
+                GPSD_LOG(LOG_ERROR, &context.errout, "response: %s\n", reply);
+            }
+#endif  // HAVE_ZLIB
             if (0 != status) {
                 // failed to parse ?WATCH.
                 (void)snprintf(reply, replylen,
@@ -1319,7 +1887,8 @@ static void handle_request(struct subscriber_t *sub, const char *buf,
                     // awaken specific device
 #ifdef __UNUSED__
                     char outbuf[GPS_JSON_RESPONSE_MAX];
-                    json_watch_dump(&sub->policy, outbuf, sizeof(outbuf));
+                    json_watch_dump(&sub->policy, NULL, NULL,
+                                    outbuf, sizeof(outbuf));
                     GPSD_LOG(0, &context.errout, "policy: %s\n", outbuf);
 #endif
                     devp = find_device(sub->policy.devpath);
@@ -1375,6 +1944,12 @@ static void handle_request(struct subscriber_t *sub, const char *buf,
         json_devicelist_dump(reply + strnlen(reply, replylen),
                              replylen - strnlen(reply, replylen));
         json_watch_dump(&sub->policy,
+#ifdef AIVDM_ENABLE
+                        &sub->aisfilter,
+#else
+                        NULL,
+#endif  // AIVDM_ENABLE
+                        &sub->rates,
                         reply + strnlen(reply, replylen),
                         replylen - strnlen(reply, replylen));
     } else if (str_starts_with(buf, "?DEVICE") &&
@@ -1594,6 +2169,23 @@ static void handle_request(struct subscriber_t *sub, const char *buf,
         }
         str_rstrip_char(reply, ',');
         (void)strlcat(reply, "]}\r\n", replylen);
+#ifdef AIS_VESSELS_ENABLE
+    } else if (str_starts_with(buf, "?AIS;")) {
+        buf += 5;
+        // too big for reply, the main loop sends it a slice at a time
+        sub->aissnap = true;
+        sub->aissnap_cursor = 0;
+        sub->aissnap_count = 0;
+        ais_snap_pending = true;
+#endif  // AIS_VESSELS_ENABLE
+    } else if (str_starts_with(buf, "?LEXER;")) {
+        buf += 7;
+        for (devp = devices; devp < devices + MAX_DEVICES; devp++) {
+            if (allocated_device(devp) && subscribed(sub, devp)) {
+                json_lexer_dump(devp, reply + strnlen(reply, replylen),
+                                replylen - strnlen(reply, replylen));
+            }
+        }
     } else if (str_starts_with(buf, "?VERSION;")) {
         buf += 9;
         json_version_dump(reply, replylen);
@@ -1716,6 +2308,365 @@ static void pseudonmea_report(struct subscriber_t *sub,
 #endif  // AIVDM_ENABLE
     }
 }
+
+// the changed bits that make each watch_rate_class report
+static const gps_mask_t rate_masks[RATE_CLASSES] = {
+    REPORT_IS,                                  // TPV
+    DOP_SET | SATELLITE_SET | USED_IS,          // SKY
+    ATTITUDE_SET,                               // ATT
+    IMU_SET,                                    // IMU
+    GST_SET,                                    // GST
+    RAW_IS,                                     // RAW
+};
+
+/* Return whether writes to sub are stalled: the last one found its
+ * socket full, and it still is, or the rest of a report cut short is
+ * still waiting to go.  Only what gpsd sees when it writes counts, how
+ * much the client has left unread is not something all sockets tell.
+ */
+static bool client_backlogged(struct subscriber_t *sub)
+{
+    static const timespec_t zero = {0, 0};
+    fd_set wfds;
+
+    if (!sub->backlog) {
+        return false;
+    }
+    if (NULL != sub->held &&
+        !client_write_held(sub)) {
+        return true;
+    }
+    if (UNALLOCATED_FD == sub->fd) {
+        return true;
+    }
+    FD_ZERO(&wfds);
+    FD_SET(sub->fd, &wfds);
+    if (0 < pselect(sub->fd + 1, NULL, &wfds, NULL, &zero, NULL)) {
+        sub->backlog = false;
+    }
+    return sub->backlog;
+}
+
+/* Drop from changed the report classes sub wants less often, and
+ * note when they are due again.  Return what is left to report.
+ * Only data reports pass this way; DEVICE, PPS and TOFF notices do not.
+ */
+static gps_mask_t watch_rate_pass(struct subscriber_t *sub,
+                                  gps_mask_t changed)
+{
+    const struct watch_rate_t *rates = &sub->rates;
+    timespec_t now, step;
+    bool backlog = false;
+    bool clock_read = false;
+    int i;
+
+    if (rates->latest &&
+        0 != (changed & (REPORT_IS | DOP_SET | SATELLITE_SET | USED_IS |
+                         ATTITUDE_SET | IMU_SET | GST_SET | RAW_IS))) {
+        backlog = client_backlogged(sub);
+    }
+    for (i = 0; i < RATE_CLASSES; i++) {
+        timespec_t *due = &sub->rate_due[i];
+
+        if (0 == (changed & rate_masks[i])) {
+            continue;
+        }
+        if (backlog) {
+            // a newer report will do when the client catches up
+            changed &= ~rate_masks[i];
+            continue;
+        }
+        if (0 >= rates->interval[i]) {
+            continue;
+        }
+        if (!clock_read) {
+            (void)clock_gettime(CLOCK_MONOTONIC, &now);
+            clock_read = true;
+        }
+        if (TS_GT(due, &now)) {
+            changed &= ~rate_masks[i];
+            continue;
+        }
+        /* Due.  The next one is an interval after this deadline, so
+         * jitter in the epochs does not lower the average rate, or an
+         * interval from now after a gap. */
+        DTOTS(&step, rates->interval[i]);
+        if (TS_GT(&now, due) &&
+            TS_SUB_D(&now, due) >= rates->interval[i]) {
+            *due = now;
+        }
+        due->tv_sec += step.tv_sec;
+        due->tv_nsec += step.tv_nsec;
+        TS_NORM(due);
+    }
+    return changed;
+}
+
+#ifdef AIVDM_ENABLE
+/* Get the position, in degrees, from an AIS message.
+ * Return false if the type has no position, or it is not available.
+ */
+static bool ais_position(const struct ais_t *ais, double *lat, double *lon)
+{
+    int ilat, ilon;
+    double div = AIS_LATLON_DIV;
+
+    switch (ais->type) {
+    case 1:
+        FALLTHROUGH
+    case 2:
+        FALLTHROUGH
+    case 3:
+        ilat = ais->type1.lat;
+        ilon = ais->type1.lon;
+        break;
+    case 4:
+        FALLTHROUGH
+    case 11:
+        ilat = ais->type4.lat;
+        ilon = ais->type4.lon;
+        break;
+    case 9:
+        ilat = ais->type9.lat;
+        ilon = ais->type9.lon;
+        break;
+    case 18:
+        ilat = ais->type18.lat;
+        ilon = ais->type18.lon;
+        break;
+    case 19:
+        ilat = ais->type19.lat;
+        ilon = ais->type19.lon;
+        break;
+    case 21:
+        ilat = ais->type21.lat;
+        ilon = ais->type21.lon;
+        break;
+    case 27:
+        if (AIS_LONGRANGE_LAT_NOT_AVAILABLE == ais->type27.lat ||
+            AIS_LONGRANGE_LON_NOT_AVAILABLE == ais->type27.lon) {
+            return false;
+        }
+        *lat = ais->type27.lat / AIS_LONGRANGE_LATLON_DIV;
+        *lon = ais->type27.lon / AIS_LONGRANGE_LATLON_DIV;
+        return true;
+    default:
+        return false;
+    }
+    if (AIS_LAT_NOT_AVAILABLE == ilat ||
+        AIS_LON_NOT_AVAILABLE == ilon) {
+        return false;
+    }
+    *lat = ilat / div;
+    *lon = ilon / div;
+    return true;
+}
+
+// is the position inside the filter box and circle?
+static bool ais_filter_area(const struct ais_filter_t *filter,
+                            double lat, double lon)
+{
+    if (4 == filter->nbox) {
+        if (filter->box[0] > lat ||
+            filter->box[2] < lat) {
+            return false;
+        }
+        if (filter->box[1] <= filter->box[3]) {
+            if (filter->box[1] > lon ||
+                filter->box[3] < lon) {
+                return false;
+            }
+        } else if (filter->box[1] > lon &&
+                   filter->box[3] < lon) {
+            // box crosses the antimeridian
+            return false;
+        }
+    }
+    if (3 == filter->ncircle) {
+        // cheap reject on latitude alone, one degree >= 110 km
+        if (fabs(lat - filter->circle[0]) * 110000.0 > filter->circle[2]) {
+            return false;
+        }
+        if (earth_distance(lat, lon, filter->circle[0], filter->circle[1]) >
+            filter->circle[2]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int ais_mmsi_compare(const void *a, const void *b)
+{
+    unsigned int ua = *(const unsigned int *)a;
+    unsigned int ub = *(const unsigned int *)b;
+
+    return (ua > ub) - (ua < ub);
+}
+
+/* Decide if the AIS message in the device passes the client's filter.
+ * Called once per message per client, before any JSON is generated.
+ *
+ * Messages without a position pass the area filter if the last
+ * position seen from that MMSI did.  The minimum interval only
+ * applies to position messages, so static data is not lost.
+ */
+static bool ais_filter_pass(struct subscriber_t *sub,
+                            const struct ais_t *ais)
+{
+    const struct ais_filter_t *filter = &sub->aisfilter;
+    struct ais_seen_t *seen;
+    timespec_t now;
+    double lat, lon;
+    bool has_pos;
+
+    if (!filter->active) {
+        return true;
+    }
+    if (0 != filter->typemask &&
+        (AIS_FILTER_TYPE_MAX < ais->type ||
+         0 == (filter->typemask & (1UL << ais->type)))) {
+        return false;
+    }
+    if (0 < filter->nmmsi &&
+        NULL == bsearch(&ais->mmsi, filter->mmsi, filter->nmmsi,
+                        sizeof(filter->mmsi[0]), ais_mmsi_compare)) {
+        return false;
+    }
+    if (0 == filter->nbox &&
+        0 == filter->ncircle &&
+        0 >= filter->interval) {
+        return true;
+    }
+
+    has_pos = ais_position(ais, &lat, &lon);
+    seen = ais_seen_find(sub, ais->mmsi);
+    if (0 != filter->nbox ||
+        0 != filter->ncircle) {
+        if (has_pos &&
+            !ais_filter_area(filter, lat, lon)) {
+            // it left, its static data stays out with it
+            if (NULL != seen) {
+                ais_seen_remove(sub, seen);
+            }
+            return false;
+        }
+        if (!has_pos &&
+            NULL == seen) {
+            // no position heard from it inside the area
+            return false;
+        }
+    }
+    if (!has_pos) {
+        return true;
+    }
+
+    (void)clock_gettime(CLOCK_REALTIME, &now);
+    if (NULL == seen) {
+        seen = ais_seen_add(sub, ais->mmsi, &now);
+        if (NULL == seen) {
+            return true;
+        }
+    }
+    seen->heard = now;
+    if (0 < filter->interval) {
+        timespec_t delta;
+
+        TS_SUB(&delta, &now, &seen->sent);
+        // a clock step backward just lets the next one through
+        if (0 <= TSTONS(&delta) &&
+            filter->interval > TSTONS(&delta)) {
+            return false;
+        }
+        seen->sent = now;
+    }
+    return true;
+}
+#endif  // AIVDM_ENABLE
+
+#ifdef AIS_VESSELS_ENABLE
+#define AIS_SNAP_SLICE  16      // vessels sent per main loop pass
+
+// dump one stored AIS message, if the client's type filter passes it
+static void ais_snapshot_dump(const struct subscriber_t *sub,
+                              const struct ais_t *ais,
+                              char *buf, size_t buflen)
+{
+    size_t len = strnlen(buf, buflen);
+
+    if (0 == ais->type ||
+        (0 != sub->aisfilter.typemask &&
+         0 == (sub->aisfilter.typemask & (1UL << ais->type)))) {
+        return;
+    }
+    json_aivdm_dump(ais, NULL, sub->policy.scaled, buf + len, buflen - len);
+}
+
+/* Send the next slice of a client's ?AIS snapshot, then the closing
+ * AISSNAP object when all vessels are sent.  The client's MMSI, area
+ * and type filters apply, the area one to each vessel's last position.
+ */
+static void ais_snapshot_slice(struct subscriber_t *sub)
+{
+    const struct ais_filter_t *filter = &sub->aisfilter;
+    char buf[GPS_JSON_RESPONSE_MAX * 2];
+    timespec_t now;
+    int n;
+
+    (void)clock_gettime(CLOCK_REALTIME, &now);
+    // only vessels sent count, skipping is cheap
+    for (n = 0; n < AIS_SNAP_SLICE; ) {
+        int cursor = sub->aissnap_cursor;
+        const struct ais_vessel_t *vessel = ais_vessel_next(&cursor,
+                                                            &now);
+        struct ais_t position, info;
+        double lat, lon;
+        ssize_t status;
+
+        if (NULL == vessel) {
+            char tbuf[JSON_DATE_MAX+1];
+
+            sub->aissnap = false;
+            (void)snprintf(buf, sizeof(buf),
+                           "{\"class\":\"AISSNAP\",\"time\":\"%s\","
+                           "\"vessels\":%d}\r\n",
+                           now_to_iso8601(tbuf, sizeof(tbuf)),
+                           sub->aissnap_count);
+            (void)throttled_write(sub, buf, strnlen(buf, sizeof(buf)));
+            return;
+        }
+        if (0 < filter->nmmsi &&
+            NULL == bsearch(&vessel->mmsi, filter->mmsi, filter->nmmsi,
+                            sizeof(filter->mmsi[0]), ais_mmsi_compare)) {
+            sub->aissnap_cursor = cursor;
+            continue;
+        }
+        (void)ais_vessel_message(vessel, false, &position);
+        if ((0 != filter->nbox ||
+             0 != filter->ncircle) &&
+            (!ais_position(&position, &lat, &lon) ||
+             !ais_filter_area(filter, lat, lon))) {
+            sub->aissnap_cursor = cursor;
+            continue;
+        }
+        buf[0] = '\0';
+        (void)ais_vessel_message(vessel, true, &info);
+        ais_snapshot_dump(sub, &position, buf, sizeof(buf));
+        ais_snapshot_dump(sub, &info, buf, sizeof(buf));
+        if ('\0' == buf[0]) {
+            sub->aissnap_cursor = cursor;
+            continue;
+        }
+        status = throttled_write(sub, buf, strnlen(buf, sizeof(buf)));
+        if (0 >= status) {
+            // detached, or try this vessel again next time
+            return;
+        }
+        sub->aissnap_cursor = cursor;
+        sub->aissnap_count++;
+        n++;
+    }
+}
+#endif  // AIS_VESSELS_ENABLE
 #endif  // SOCKET_EXPORT_ENABLE
 
 // report on the current packet from a specified device
@@ -1723,6 +2674,10 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
 {
 #ifdef SOCKET_EXPORT_ENABLE
     struct subscriber_t *sub;
+    char report[GPS_JSON_RESPONSE_MAX * 4];
+    gps_mask_t report_mask = 0;         // what report holds, 0 nothing
+    bool report_scaled = false;
+    bool report_timing = false;
 
     GPSD_LOG(LOG_DATA, &context.errout, "all_reports(): changed %s\n",
              gps_maskdump(changed));
@@ -1901,6 +2856,20 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
 
     // a few things are not per-subscriber reports
     if (0 != (changed & REPORT_IS)) {
+        if (MODE_NO_FIX < device->gpsdata.fix.mode &&
+            0 != device->attach_time.tv_sec) {
+            timespec_t now;
+            char ts_buf[TIMESPEC_LEN];
+
+            (void)clock_gettime(CLOCK_MONOTONIC, &now);
+            TS_SUB(&device->first_fix, &now, &device->attach_time);
+            GPSD_LOG(LOG_INF, &context.errout,
+                     "%s: first fix %s sec after attach\n",
+                     device->gpsdata.dev.path,
+                     timespec_str(&device->first_fix, ts_buf,
+                                  sizeof(ts_buf)));
+            device->attach_time.tv_sec = 0;
+        }
         if (MODE_3D == device->gpsdata.fix.mode) {
             struct gps_device_t *dgnss;
 
@@ -1933,7 +2902,20 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
 #endif  // SHM_EXPORT_ENABLE
 
 #ifdef SOCKET_EXPORT_ENABLE
-    // update all subscribers associated with this device
+#ifdef AIS_VESSELS_ENABLE
+    if (0 != (changed & AIS_SET)) {
+        timespec_t now;
+
+        (void)clock_gettime(CLOCK_REALTIME, &now);
+        ais_vessel_update(&device->gpsdata.ais, &now);
+    }
+#endif  // AIS_VESSELS_ENABLE
+
+    /* Update all subscribers associated with this device.  The JSON is
+     * formatted once, and reused while the next clients want the same
+     * classes, scaled and timing; decimation and filters make them
+     * differ.  Deltas and compression work on that copy.
+     */
     for (sub = subscribers; sub < (subscribers + MAX_CLIENTS); sub++) {
         if (0 == sub->active ||
             !subscribed(sub, device)) {
@@ -1955,8 +2937,21 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
 
         // some listeners may be in watcher mode
         if (sub->policy.watcher) {
-            if ((changed & DATA_IS) ||
-                (changed & REPORT_IS)) {
+            gps_mask_t subchanged = changed;
+
+#ifdef AIVDM_ENABLE
+            // drop filtered AIS before anything is formatted for it
+            if (0 != (changed & AIS_SET) &&
+                !ais_filter_pass(sub, &device->gpsdata.ais)) {
+                subchanged &= ~AIS_SET;
+            }
+#endif  // AIVDM_ENABLE
+            // and classes the client wants less often
+            if (sub->rates.active) {
+                subchanged = watch_rate_pass(sub, subchanged);
+            }
+            if ((subchanged & DATA_IS) ||
+                (subchanged & REPORT_IS)) {
                 GPSD_LOG(LOG_PROG, &context.errout,
                          "Changed mask: %s with %sreliable "
                          "cycle detection\n",
@@ -1968,28 +2963,58 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
                 }
 
                 if (sub->policy.nmea) {
-                    pseudonmea_report(sub, changed, device);
+                    pseudonmea_report(sub, subchanged, device);
                 }
 
                 if (sub->policy.json) {
                     char buf[GPS_JSON_RESPONSE_MAX * 4];
+                    const char *out = report;
 
-                    if (0 != (changed & AIS_SET) &&
+                    if (0 != (subchanged & AIS_SET) &&
                         24 == device->gpsdata.ais.type &&
                         device->gpsdata.ais.type24.part != both &&
                         !sub->policy.split24) {
                         continue;
                     }
 
-                    json_data_report(changed, device, &sub->policy,
-                                     buf, sizeof(buf));
-                    if ('\0' != buf[0]) {
-                        (void)throttled_write(sub, buf,
-                                              strnlen(buf, sizeof(buf)));
+                    if (subchanged != report_mask ||
+                        sub->policy.scaled != report_scaled ||
+                        sub->policy.timing != report_timing) {
+                        json_data_report(subchanged, device, &sub->policy,
+                                         report, sizeof(report));
+                        report_mask = subchanged;
+                        report_scaled = sub->policy.scaled;
+                        report_timing = sub->policy.timing;
+                    }
+                    if (sub->rates.delta) {
+                        (void)strlcpy(buf, report, sizeof(buf));
+                        json_delta_encode(&sub->delta, device,
+                                          sub->rates.keyframe,
+                                          buf, sizeof(buf));
+                        out = buf;
+                    }
+                    if ('\0' != out[0]) {
+#ifdef HAVE_ZLIB
+                        // compressed, it need not flush before the epoch ends
+                        sub->zhold = 0 == (changed & REPORT_IS) &&
+                                     device->cycle_end_reliable;
+#endif  // HAVE_ZLIB
+                        (void)throttled_write(sub, out,
+                                              strnlen(out, sizeof(report)));
+#ifdef HAVE_ZLIB
+                        sub->zhold = false;
+#endif  // HAVE_ZLIB
                     }
                 }
             }
         }
+#ifdef HAVE_ZLIB
+        // the epoch is over, let out what was held back for it
+        if (0 != (changed & REPORT_IS) &&
+            NULL != sub->deflate) {
+            (void)deflate_write(sub, "", 0);
+        }
+#endif  // HAVE_ZLIB
     }   // subscribers
 #endif  // SOCKET_EXPORT_ENABLE
 }
@@ -2014,6 +3039,18 @@ static int handle_gpsd_request(struct subscriber_t *sub, const char *buf,
                 size_t len = strnlen(reply, sizeof(reply));
                 handle_request(sub, buf, bufsize, &end,
                                reply + len, sizeof(reply) - len);
+#ifdef HAVE_ZLIB
+                if (sub->zstart) {
+                    // the ?WATCH reply goes plain, all after it compressed
+                    (void)throttled_write(sub, reply,
+                                          strnlen(reply, sizeof(reply)));
+                    if (UNALLOCATED_FD == sub->fd) {
+                        return -1;
+                    }
+                    reply[0] = '\0';
+                    sub->zstart = false;
+                }
+#endif  // HAVE_ZLIB
             }
         }
     }
@@ -2176,6 +3213,8 @@ int main(int argc, char *argv[])
     // some of these statics suppress -W warnings due to longjmp()
 #ifdef SOCKET_EXPORT_ENABLE
     static char *gpsd_service = NULL;
+    static char *data_socket = NULL;
+    static socket_t dsock = -1;
     struct subscriber_t *sub;
 #endif  // SOCKET_EXPORT_ENABLE
     fd_set rfds;
@@ -2187,12 +3226,13 @@ int main(int argc, char *argv[])
     socket_t cfd;
     static char *control_socket = NULL;
 #endif  // CONTROL_SOCKET_ENABLE
-#if defined(SOCKET_EXPORT_ENABLE) || defined(CONTROL_SOCKET_ENABLE)
+#ifdef CONTROL_SOCKET_ENABLE
     sockaddr_t fsin;
-#endif  // SOCKET_EXPORT_ENABLE || CONTROL_SOCKET_ENABLE
+#endif  // CONTROL_SOCKET_ENABLE
     static char *pid_file = NULL;
     struct gps_device_t *device;
     int i;
+    static int poll_start = 0;        // round robin, see DEVICE_BUDGET
     socket_t msocks[2] = {-1, -1};
     bool device_opened = false;
     bool go_background = true;
@@ -2211,7 +3251,7 @@ int main(int argc, char *argv[])
 #endif  // CONTROL_SOCKET_ENABLE
 
     while (1) {
-        const char *optstring = "?bD:F:f:GhlNnpP:rS:s:V";
+        const char *optstring = "?bD:F:f:GhlNnpP:rS:s:U:V";
         int ch;
 
 #ifdef HAVE_GETOPT_LONG
@@ -2231,6 +3271,7 @@ int main(int argc, char *argv[])
             {"port", required_argument, NULL, 'S'},
             {"sockfile", required_argument, NULL, 'F'},
             {"speed", required_argument, NULL, 's'},
+            {"datasock", required_argument, NULL, 'U'},
             {"version", no_argument, NULL, 'V' },
             {NULL, 0, NULL, 0},
         };
@@ -2324,6 +3365,11 @@ int main(int argc, char *argv[])
                 }
             }
             break;
+#ifdef SOCKET_EXPORT_ENABLE
+        case 'U':
+            data_socket = optarg;
+            break;
+#endif  // SOCKET_EXPORT_ENABLE
         case 'V':
             (void)printf("%s: %s (revision %s)\n", argv[0], VERSION, REVISION);
             exit(EXIT_SUCCESS);
@@ -2431,7 +3477,7 @@ int main(int argc, char *argv[])
                      "removing stale control socket %s failed: %s(%d)\n",
                      control_socket, strerror(errno), errno);
         }
-        if (BAD_SOCKET(csock = filesock(control_socket))) {
+        if (BAD_SOCKET(csock = filesock(control_socket, SOCK_STREAM))) {
             // cast for 32-bit intptr_t
             GPSD_LOG(LOG_ERROR, &context.errout,
                      "control socket %s create failed, netlib error %ld\n",
@@ -2530,6 +3576,32 @@ int main(int argc, char *argv[])
     }
     GPSD_LOG(LOG_INF, &context.errout, "listening on port %s\n",
                        gpsd_service);
+
+    /*
+     * The local data socket speaks the same protocol as the TCP port,
+     * but SOCK_SEQPACKET keeps each report in its own message so
+     * clients need not scan for line ends.
+     */
+    if (NULL != data_socket &&
+        '\0' != data_socket[0]) {
+        (void)unlink(data_socket);
+        if (BAD_SOCKET(dsock = filesock(data_socket, SOCK_SEQPACKET))) {
+            // cast for 32-bit intptr_t
+            GPSD_LOG(LOG_ERROR, &context.errout,
+                     "data socket %s create failed, netlib error %ld\n",
+                     data_socket, (long)dsock);
+            exit(EXIT_FAILURE);
+        }
+        // any local user may connect, as with the TCP port
+        if (0 != chmod(data_socket, 0666)) {
+            GPSD_LOG(LOG_WARN, &context.errout,
+                     "data socket %s chmod failed: %s(%d)\n",
+                     data_socket, strerror(errno), errno);
+        }
+        GPSD_LOG(LOG_PROG, &context.errout,
+                 "data socket %s is fd %ld\n",
+                 data_socket, (long)dsock);
+    }
 #endif  // SOCKET_EXPORT_ENABLE
 
     if (0 == getuid()) {
@@ -2699,10 +3771,27 @@ int main(int argc, char *argv[])
 
     for (i = 0; i < AFCOUNT; i++) {
         if (0 <= msocks[i]) {
+            int opts = fcntl(msocks[i], F_GETFL);
+
+            // non-blocking, so accept_client() can drain the queue
+            if (0 <= opts) {
+                (void)fcntl(msocks[i], F_SETFL, opts | O_NONBLOCK);
+            }
             FD_SET(msocks[i], &all_fds);
             adjust_max_fd(msocks[i], true);
         }
     }
+#ifdef SOCKET_EXPORT_ENABLE
+    if (0 <= dsock) {
+        int opts = fcntl(dsock, F_GETFL);
+
+        if (0 <= opts) {
+            (void)fcntl(dsock, F_SETFL, opts | O_NONBLOCK);
+        }
+        FD_SET(dsock, &all_fds);
+        adjust_max_fd(dsock, true);
+    }
+#endif  // SOCKET_EXPORT_ENABLE
 #ifdef CONTROL_SOCKET_ENABLE
     FD_ZERO(&control_fds);
 #endif  // CONTROL_SOCKET_ENABLE
@@ -2729,6 +3818,12 @@ int main(int argc, char *argv[])
         fd_set efds;
         // static here suppresses longjmp warning
         static const timespec_t ts_timeout = {2, 0};   // timeout for pselect()
+        // shortened for a device configuration step coming due
+        static timespec_t ts_wait;
+#ifdef AIS_VESSELS_ENABLE
+        // while an ?AIS snapshot is being sent
+        static const timespec_t ts_snap = {0, 20000000};
+#endif  // AIS_VESSELS_ENABLE
         timespec_t before, after;        // time before/after gpsd_await_data()
         int await;
         bool time_warp;
@@ -2736,8 +3831,22 @@ int main(int argc, char *argv[])
         time_warp = false;
         GPSD_LOG(LOG_RAW1, &context.errout, "await data\n");
         (void)clock_gettime(CLOCK_REALTIME, &before);
+        ts_wait = ts_timeout;
+        for (device = devices; device < devices + MAX_DEVICES; device++) {
+            if (allocated_device(device) &&
+                0 < device->gpsdata.gps_fd) {
+                gpsd_config_timeout(device, &before, &ts_wait);
+                if (device->poll_pending) {
+                    // packets buffered, select() will not say so
+                    ts_wait = (timespec_t){0, 0};
+                }
+            }
+        }
         await = gpsd_await_data(&rfds, &efds, maxfd, &all_fds, &context.errout,
-                                ts_timeout);
+#ifdef AIS_VESSELS_ENABLE
+                                ais_snap_pending ? ts_snap :
+#endif  // AIS_VESSELS_ENABLE
+                                ts_wait);
         (void)clock_gettime(CLOCK_REALTIME, &after);
         TS_SUB(&delta, &after, &before);
         if ((1 + ts_timeout.tv_sec) <= llabs(delta.tv_sec)) {
@@ -2777,59 +3886,28 @@ int main(int argc, char *argv[])
         for (i = 0; i < AFCOUNT; i++) {
             if (0 <= msocks[i] &&
                 FD_ISSET(msocks[i], &rfds)) {
-                socklen_t alen = (socklen_t) sizeof(fsin);
-                socket_t ssock =
-                    accept(msocks[i], (struct sockaddr *)&fsin, &alen);
-
-                if (BAD_SOCKET(ssock)) {
-                    GPSD_LOG(LOG_ERROR, &context.errout,
-                             "accept: fail: %s(%d)\n", strerror(errno), errno);
-                } else {
-                    struct subscriber_t *client = NULL;
-                    int opts = fcntl(ssock, F_GETFL);
-                    static struct linger linger = { 1, RELEASE_TIMEOUT };
-                    char *c_ip;
+                int budget;
 
-                    if (0 <= opts) {
-                        (void)fcntl(ssock, F_SETFL, opts | O_NONBLOCK);
-                    }
-
-                    c_ip = netlib_sock2ip(ssock);
-                    client = allocate_client();
-                    if (NULL == client) {
-                        // cast for 32-bit intptr_t
-                        GPSD_LOG(LOG_ERROR, &context.errout,
-                                 "Client %s connect on fd %ld -"
-                                 "no subscriber slots available\n", c_ip,
-                                  (long)ssock);
-                        (void)close(ssock);
-                    } else if (-1 == setsockopt(ssock,
-                                                SOL_SOCKET, SO_LINGER,
-                                                (char *)&linger,
-                                                (int)sizeof(struct linger))) {
-                        GPSD_LOG(LOG_ERROR, &context.errout,
-                                 "Error: SETSOCKOPT SO_LINGER. %s(%d)\n",
-                                 strerror(errno), errno);
-                        (void)close(ssock);
-                    } else {
-                        char announce[GPS_JSON_RESPONSE_MAX];
-                        FD_SET(ssock, &all_fds);
-                        adjust_max_fd(ssock, true);
-                        client->fd = ssock;
-                        client->active = time(NULL);
-                        // cast for 32-bit intptr_t
-                        GPSD_LOG(LOG_SPIN, &context.errout,
-                                 "client %s (%d) connect on fd %ld\n", c_ip,
-                                 sub_index(client), (long)ssock);
-                        json_version_dump(announce, sizeof(announce));
-                        (void)throttled_write(client, announce,
-                                              strnlen(announce,
-                                                      sizeof(announce)));
+                // drain the listen queue, but not forever
+                for (budget = 0; budget < ACCEPT_BUDGET; budget++) {
+                    if (!accept_client(msocks[i])) {
+                        break;
                     }
                 }
                 FD_CLR(msocks[i], &rfds);
             }
         }
+        if (0 <= dsock &&
+            FD_ISSET(dsock, &rfds)) {
+            int budget;
+
+            for (budget = 0; budget < ACCEPT_BUDGET; budget++) {
+                if (!accept_client(dsock)) {
+                    break;
+                }
+            }
+            FD_CLR(dsock, &rfds);
+        }
 #endif  // SOCKET_EXPORT_ENABLE
 
 #ifdef CONTROL_SOCKET_ENABLE
@@ -2882,19 +3960,45 @@ int main(int argc, char *argv[])
         }
 #endif  // CONTROL_SOCKET_ENABLE
 
-        // poll all active devices
+        /* poll all active devices, timing sources first, then the rest
+         * round robin, starting one further along each pass */
         GPSD_LOG(LOG_RAW1, &context.errout, "poll active devices\n");
-        for (device = devices; device < devices + MAX_DEVICES; device++) {
+        poll_start = (poll_start + 1) % MAX_DEVICES;
+        for (i = 0; i < 2 * MAX_DEVICES; i++) {
             int multipoll_ret;
+            bool timing, ready;
 
+            device = devices + (poll_start + i) % MAX_DEVICES;
             if (!allocated_device(device) ||
                 0 >= device->gpsdata.gps_fd) {
                 continue;
             }
+            timing = VALID_UNIT(device->shm_clock_unit) ||
+                     0 < device->chrony_clock_fd;
+            if ((MAX_DEVICES > i) != timing) {
+                // first round timing sources, second the others
+                continue;
+            }
 
-            multipoll_ret = gpsd_multipoll(FD_ISSET(device->gpsdata.gps_fd,
-                                           &rfds), device, all_reports,
-                                           DEVICE_REAWAKE);
+            ready = FD_ISSET(device->gpsdata.gps_fd, &rfds) ||
+                    device->poll_pending;
+            if (ready) {
+                // how long since its input came in, as near as we know
+                (void)clock_gettime(CLOCK_REALTIME, &now);
+                if (0 == device->ready_since.tv_sec) {
+                    device->ready_since = after;
+                }
+                TS_SUB(&device->qdelay, &now, &device->ready_since);
+                if (TS_GT(&device->qdelay, &device->qdelay_max)) {
+                    device->qdelay_max = device->qdelay;
+                }
+            }
+            multipoll_ret = gpsd_multipoll(ready, device, all_reports,
+                                           DEVICE_REAWAKE,
+                                           timing ? 0 : DEVICE_BUDGET);
+            if (!device->poll_pending) {
+                device->ready_since.tv_sec = 0;
+            }
             // cast for 32-bit intptr_t
             GPSD_LOG(LOG_DATA, &context.errout,
                      "gpsd_multipoll(%ld) = %d\n",
@@ -3050,6 +4154,18 @@ int main(int argc, char *argv[])
             }
         }
 
+#ifdef AIS_VESSELS_ENABLE
+        // move pending ?AIS snapshots along
+        ais_snap_pending = false;
+        for (sub = subscribers; sub < subscribers + MAX_CLIENTS; sub++) {
+            if (0 != sub->active &&
+                sub->aissnap) {
+                ais_snapshot_slice(sub);
+                ais_snap_pending |= sub->aissnap;
+            }
+        }
+#endif  // AIS_VESSELS_ENABLE
+
         /*
          * Mark devices with an identified packet type but no
          * remaining subscribers to be closed in RELEASE_TIME seconds.
@@ -3177,6 +4293,9 @@ shutdown:
             detach_client(sub);
         }
     }
+    if (NULL != data_socket) {
+        (void)unlink(data_socket);
+    }
 #endif  // SOCKET_EXPORT_ENABLE
 
 #ifdef SHM_EXPORT_ENABLE
@@ -796,7 +796,70 @@ void json_device_dump(const struct gps_device_t *device,
     (void)strlcat(reply, "}\r\n", replylen);
 }
 
+// append "key":{"name":count,...} for the nonzero counts
+static void json_lexer_counts(const char *key, const unsigned long *counts,
+                              unsigned n, const char *(*name)(int),
+                              char *reply, size_t replylen)
+{
+    unsigned i;
+
+    str_appendf(reply, replylen, ",\"%s\":{", key);
+    for (i = 0; i < n; i++) {
+        if (0 != counts[i]) {
+            str_appendf(reply, replylen, "\"%s\":%lu,", name((int)i),
+                        counts[i]);
+        }
+    }
+    str_rstrip_char(reply, ',');
+    (void)strlcat(reply, "}", replylen);
+}
+
+static const char *lexer_state_name(int state)
+{
+    return packet_state_name((unsigned)state);
+}
+
+// the lexer counters of a device, for ?LEXER
+void json_lexer_dump(const struct gps_device_t *device,
+                     char *reply, size_t replylen)
+{
+    const struct gps_lexer_t *lexer = &device->lexer;
+    int i;
+
+    (void)snprintf(reply, replylen,
+                   "{\"class\":\"LEXER\",\"path\":\"%s\",\"chars\":%lu,"
+                   "\"discarded\":%lu,\"maxresync\":%lu",
+                   device->gpsdata.dev.path, lexer->char_counter,
+                   lexer->stats.discarded, lexer->stats.max_resync);
+    json_lexer_counts("accepted", lexer->stats.accepted,
+                      ROWS(lexer->stats.accepted), packet_type_name,
+                      reply, replylen);
+    json_lexer_counts("bad", lexer->stats.bad, ROWS(lexer->stats.bad),
+                      packet_type_name, reply, replylen);
+    json_lexer_counts("pushbacks", lexer->stats.pushbacks,
+                      ROWS(lexer->stats.pushbacks), lexer_state_name,
+                      reply, replylen);
+    str_appendf(reply, replylen, ",\"overflows\":%lu,\"reads\":[",
+                lexer->stats.overflows);
+    for (i = 0; i < LEXER_READ_BINS; i++) {
+        str_appendf(reply, replylen, "%lu,", lexer->stats.reads[i]);
+    }
+    str_rstrip_char(reply, ',');
+    // how long input waited for the main loop
+    str_appendf(reply, replylen, "],\"qdelay\":%.6f,\"qdelaymax\":%.6f",
+                TSTONS(&device->qdelay), TSTONS(&device->qdelay_max));
+    if (0 != device->first_fix.tv_sec ||
+        0 != device->first_fix.tv_nsec) {
+        // how long the device took to its first fix
+        str_appendf(reply, replylen, ",\"firstfix\":%.3f",
+                    TSTONS(&device->first_fix));
+    }
+    (void)strlcat(reply, "}\r\n", replylen);
+}
+
 void json_watch_dump(const struct gps_policy_t *ccp,
+                     const struct ais_filter_t *filter,
+                     const struct watch_rate_t *rates,
                      char *reply, size_t replylen)
 {
     (void)snprintf(reply, replylen,
@@ -815,9 +878,526 @@ void json_watch_dump(const struct gps_policy_t *ccp,
     if ('\0' != ccp->devpath[0]) {
         str_appendf(reply, replylen, ",\"device\":\"%s\"", ccp->devpath);
     }
+    if (NULL != filter) {
+        json_ais_filter_dump(filter, reply, replylen);
+    }
+    if (NULL != rates) {
+        json_watch_rate_dump(rates, reply, replylen);
+    }
     (void)strlcat(reply, "}\r\n", replylen);
 }
 
+// ?WATCH keys of the decimation intervals, in watch_rate_class order
+static const char * const rate_keys[RATE_CLASSES] = {
+    "tpvinterval",
+    "skyinterval",
+    "attinterval",
+    "imuinterval",
+    "gstinterval",
+    "rawinterval",
+};
+
+/* Parse the decimation keys of a WATCH object into *rates.
+ * All other keys are ignored, json_watch_read() handles those.
+ * Any key missing from the object clears that setting.
+ */
+int json_watch_rate_read(const char *buf, struct watch_rate_t *rates,
+                         const char **endptr)
+{
+    // *INDENT-OFF*
+    const struct json_attr_t rate_attrs[] = {
+        {"class",       t_check,   .dflt.check = "WATCH"},
+        {"tpvinterval", t_real,    .addr.real = &rates->interval[RATE_TPV],
+                                   .dflt.real = 0.0},
+        {"skyinterval", t_real,    .addr.real = &rates->interval[RATE_SKY],
+                                   .dflt.real = 0.0},
+        {"attinterval", t_real,    .addr.real = &rates->interval[RATE_ATT],
+                                   .dflt.real = 0.0},
+        {"imuinterval", t_real,    .addr.real = &rates->interval[RATE_IMU],
+                                   .dflt.real = 0.0},
+        {"gstinterval", t_real,    .addr.real = &rates->interval[RATE_GST],
+                                   .dflt.real = 0.0},
+        {"rawinterval", t_real,    .addr.real = &rates->interval[RATE_RAW],
+                                   .dflt.real = 0.0},
+        {"latest",      t_boolean, .addr.boolean = &rates->latest,
+                                   .dflt.boolean = false},
+        {"delta",       t_boolean, .addr.boolean = &rates->delta,
+                                   .dflt.boolean = false},
+        {"keyframe",    t_integer, .addr.integer = &rates->keyframe,
+                                   .dflt.integer = DELTA_KEYFRAME},
+        {"compress",    t_string,  .addr.string = rates->compress,
+                                   .len = sizeof(rates->compress)},
+        {"", t_ignore},
+        {NULL},
+    };
+    // *INDENT-ON*
+    int status;
+    int i;
+
+    memset(rates, 0, sizeof(*rates));
+    status = json_read_object(buf, rate_attrs, endptr);
+    if (0 != status) {
+        memset(rates, 0, sizeof(*rates));
+        return status;
+    }
+    if (1 > rates->keyframe) {
+        memset(rates, 0, sizeof(*rates));
+        return JSON_ERR_MISC;
+    }
+#ifdef HAVE_ZLIB
+    if ('\0' != rates->compress[0] &&
+        0 != strcmp(rates->compress, "deflate")) {
+#else
+    if ('\0' != rates->compress[0]) {
+#endif  // HAVE_ZLIB
+        // not a compressor this gpsd has
+        memset(rates, 0, sizeof(*rates));
+        return JSON_ERR_MISC;
+    }
+    rates->active = rates->latest;
+    for (i = 0; i < RATE_CLASSES; i++) {
+        if (0 > rates->interval[i] ||
+            0 == isfinite(rates->interval[i])) {
+            memset(rates, 0, sizeof(*rates));
+            return JSON_ERR_MISC;
+        }
+        if (0 < rates->interval[i]) {
+            rates->active = true;
+        }
+    }
+    return 0;
+}
+
+// append the set decimation keys, as ,"key":value pairs, to reply
+void json_watch_rate_dump(const struct watch_rate_t *rates,
+                          char *reply, size_t replylen)
+{
+    int i;
+
+    for (i = 0; i < RATE_CLASSES; i++) {
+        if (0 < rates->interval[i]) {
+            str_appendf(reply, replylen, ",\"%s\":%.3f",
+                        rate_keys[i], rates->interval[i]);
+        }
+    }
+    if (rates->latest) {
+        (void)strlcat(reply, ",\"latest\":true", replylen);
+    }
+    if (rates->delta) {
+        str_appendf(reply, replylen, ",\"delta\":true,\"keyframe\":%d",
+                    rates->keyframe);
+    }
+    if ('\0' != rates->compress[0]) {
+        str_appendf(reply, replylen, ",\"compress\":\"%s\"",
+                    rates->compress);
+    }
+}
+
+// FNV-1a, 32 bits, of a JSON value as sent
+static uint32_t delta_hash(const char *value, size_t len)
+{
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (unsigned char)value[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+// find key in the delta state, trying index hint first, -1 if not there
+static int delta_key_find(const struct delta_class_t *state,
+                          const struct json_member_t *member, int hint)
+{
+    int i;
+
+    if (hint < state->nkeys &&
+        json_member_is(member, state->keys[hint].name)) {
+        return hint;
+    }
+    for (i = 0; i < state->nkeys; i++) {
+        if (json_member_is(member, state->keys[i].name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// find a satellite in the delta state, trying index hint first
+static int delta_sat_find(const struct delta_t *delta, uint64_t id,
+                          int hint)
+{
+    int i;
+
+    if (hint < delta->nsats &&
+        delta->sats[hint].id == id) {
+        return hint;
+    }
+    for (i = 0; i < delta->nsats; i++) {
+        if (delta->sats[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// append len bytes of text to out, false if they do not fit
+static bool delta_append(char *out, size_t outlen, const char *text,
+                         size_t len)
+{
+    size_t used = strnlen(out, outlen);
+
+    if (used + len >= outlen) {
+        return false;
+    }
+    memcpy(out + used, text, len);
+    out[used + len] = '\0';
+    return true;
+}
+
+/* Encode one TPV or SKY object, line, of len bytes, as a delta against
+ * state and append it to out; or, when a delta will not do, as a
+ * keyframe: the whole object, marked "delta":false.  Update state.
+ */
+static void delta_object(struct delta_t *delta, struct delta_class_t *state,
+                         const struct gps_device_t *device, int keyframe,
+                         const char *line, size_t len,
+                         char *out, size_t outlen)
+{
+    static struct json_member_t members[DELTA_KEYS_MAX];
+    static struct json_member_t sats[MAXCHANNELS];
+    static struct delta_class_t next;
+    static struct delta_sat_t nextsats[MAXCHANNELS];
+    static char text[GPS_JSON_RESPONSE_MAX * 4];
+    int nmembers, nsats = 0;
+    int head, i, j;
+    bool sky = state == &delta->sky;
+    bool first;
+    bool full;
+
+    nmembers = json_object_members(line, members, DELTA_KEYS_MAX, NULL);
+    if (1 > nmembers ||
+        !json_member_is(&members[0], "class")) {
+        // not for us, pass it on as is, and start over after it
+        state->device = NULL;
+        (void)delta_append(out, outlen, line, len);
+        return;
+    }
+    // the class, and device if any, go in every report
+    head = 1;
+    if (1 < nmembers &&
+        json_member_is(&members[1], "device")) {
+        head = 2;
+    }
+
+    // hash what is there now
+    full = NULL == state->device ||
+           device != state->device ||
+           keyframe <= state->count;
+    next.nkeys = 0;
+    for (i = head; i < nmembers; i++) {
+        struct delta_key_t *key = &next.keys[next.nkeys++];
+
+        if (sizeof(key->name) <= members[i].keylen) {
+            full = true;
+            next.nkeys = 0;
+            break;
+        }
+        memcpy(key->name, members[i].key, members[i].keylen);
+        key->name[members[i].keylen] = '\0';
+        key->hash = delta_hash(members[i].value, members[i].valuelen);
+        if (sky &&
+            json_member_is(&members[i], "satellites")) {
+            nsats = json_array_members(members[i].value, sats, MAXCHANNELS,
+                                       NULL);
+            if (0 > nsats) {
+                full = true;
+                nsats = 0;
+            }
+        }
+    }
+    for (i = 0; i < nsats; i++) {
+        nextsats[i].id = json_sat_id(sats[i].value);
+        nextsats[i].hash = delta_hash(sats[i].value, sats[i].valuelen);
+        // the client could not tell duplicates apart
+        for (j = 0; j < i; j++) {
+            if (nextsats[j].id == nextsats[i].id) {
+                full = true;
+            }
+        }
+    }
+
+    if (!full) {
+        bool fits;
+
+        text[0] = '\0';
+        fits = delta_append(text, sizeof(text), line,
+                            (size_t)(members[head - 1].value +
+                                     members[head - 1].valuelen - line));
+        (void)strlcat(text, ",\"delta\":true", sizeof(text));
+        // values that changed, or are new
+        for (i = head; i < nmembers; i++) {
+            int k = delta_key_find(state, &members[i], i - head);
+
+            if (sky &&
+                json_member_is(&members[i], "satellites")) {
+                continue;
+            }
+            if (0 > k ||
+                state->keys[k].hash != next.keys[i - head].hash) {
+                (void)strlcat(text, ",", sizeof(text));
+                fits &= delta_append(text, sizeof(text), members[i].key - 1,
+                                     (size_t)(members[i].value +
+                                              members[i].valuelen -
+                                              members[i].key + 1));
+            }
+        }
+        // keys that went away
+        first = true;
+        for (i = 0; i < state->nkeys; i++) {
+            for (j = 0; j < next.nkeys; j++) {
+                if (0 == strcmp(state->keys[i].name, next.keys[j].name)) {
+                    break;
+                }
+            }
+            if (j == next.nkeys &&
+                (!sky ||
+                 0 != strcmp(state->keys[i].name, "satellites"))) {
+                str_appendf(text, sizeof(text), "%s\"%s\"",
+                            first ? ",\"unset\":[" : ",",
+                            state->keys[i].name);
+                first = false;
+            }
+        }
+        if (!first) {
+            (void)strlcat(text, "]", sizeof(text));
+        }
+        if (sky) {
+            // satellites that changed, or are new
+            first = true;
+            for (i = 0; i < nsats; i++) {
+                int k = delta_sat_find(delta, nextsats[i].id, i);
+
+                if (0 > k ||
+                    delta->sats[k].hash != nextsats[i].hash) {
+                    (void)strlcat(text, first ? ",\"satellites\":[" : ",",
+                                  sizeof(text));
+                    fits &= delta_append(text, sizeof(text), sats[i].value,
+                                         sats[i].valuelen);
+                    first = false;
+                }
+            }
+            if (!first) {
+                (void)strlcat(text, "]", sizeof(text));
+            }
+            // satellites no longer there
+            first = true;
+            for (i = 0; i < delta->nsats; i++) {
+                uint64_t id = delta->sats[i].id;
+
+                for (j = 0; j < nsats; j++) {
+                    if (nextsats[j].id == id) {
+                        break;
+                    }
+                }
+                if (j == nsats) {
+                    str_appendf(text, sizeof(text),
+                                "%s{\"PRN\":%u,\"gnssid\":%u,"
+                                "\"svid\":%u,\"sigid\":%u}",
+                                first ? ",\"gone\":[" : ",",
+                                (unsigned)(id >> 48),
+                                (unsigned)((id >> 32) & 0xffff),
+                                (unsigned)((id >> 16) & 0xffff),
+                                (unsigned)(id & 0xffff));
+                    first = false;
+                }
+            }
+            if (!first) {
+                (void)strlcat(text, "]", sizeof(text));
+            }
+        }
+        fits &= delta_append(text, sizeof(text), "}\r\n", 3);
+        // worth it only if shorter than the report itself
+        if (!fits ||
+            strlen(text) >= len) {
+            full = true;
+        }
+    }
+
+    if (full) {
+        const char *split = members[head - 1].value +
+                            members[head - 1].valuelen;
+
+        text[0] = '\0';
+        (void)delta_append(text, sizeof(text), line, (size_t)(split - line));
+        (void)strlcat(text, ",\"delta\":false", sizeof(text));
+        if (!delta_append(text, sizeof(text), split,
+                          len - (size_t)(split - line))) {
+            // the report as is, and start over after it
+            state->device = NULL;
+            (void)delta_append(out, outlen, line, len);
+            return;
+        }
+        next.count = 0;
+    } else {
+        next.count = state->count + 1;
+    }
+    if (!delta_append(out, outlen, text, strlen(text))) {
+        state->device = NULL;
+        return;
+    }
+
+    next.device = device;
+    *state = next;
+    if (sky) {
+        delta->nsats = nsats;
+        memcpy(delta->sats, nextsats, nsats * sizeof(nextsats[0]));
+    }
+}
+
+/* Rewrite the TPV and SKY objects of a json_data_report() in buf as
+ * deltas, or keyframes, for a client that asked for "delta" in ?WATCH.
+ * Other objects pass through as they are.
+ */
+void json_delta_encode(struct delta_t *delta,
+                       const struct gps_device_t *device, int keyframe,
+                       char *buf, size_t buflen)
+{
+    static char out[GPS_JSON_RESPONSE_MAX * 4];
+    const char *line = buf;
+
+    out[0] = '\0';
+    while ('\0' != *line) {
+        const char *eol = strstr(line, "\r\n");
+        size_t len = NULL == eol ? strlen(line) : (size_t)(eol - line) + 2;
+
+        if (str_starts_with(line, "{\"class\":\"TPV\"")) {
+            delta_object(delta, &delta->tpv, device, keyframe, line, len,
+                         out, sizeof(out));
+        } else if (str_starts_with(line, "{\"class\":\"SKY\"")) {
+            delta_object(delta, &delta->sky, device, keyframe, line, len,
+                         out, sizeof(out));
+        } else {
+            (void)delta_append(out, sizeof(out), line, len);
+        }
+        line += len;
+    }
+    (void)strlcpy(buf, out, buflen);
+}
+
+/* Parse the AIS filter keys of a WATCH object into *filter.
+ * All other keys are ignored, json_watch_read() handles those.
+ * Any key missing from the object clears that criterion.
+ */
+int json_ais_filter_read(const char *buf, struct ais_filter_t *filter,
+                         const char **endptr)
+{
+    // *INDENT-OFF*
+    const struct json_attr_t ais_filter_attrs[] = {
+        {"class",       t_check,   .dflt.check = "WATCH"},
+        {"aisbox",      t_array,   .addr.array.element_type = t_real,
+                                   .addr.array.arr.reals.store = filter->box,
+                                   .addr.array.count = &filter->nbox,
+                                   .addr.array.maxlen = 4},
+        {"aiscircle",   t_array,   .addr.array.element_type = t_real,
+                                   .addr.array.arr.reals.store = filter->circle,
+                                   .addr.array.count = &filter->ncircle,
+                                   .addr.array.maxlen = 3},
+        {"aismmsi",     t_array,   .addr.array.element_type = t_uinteger,
+                                   .addr.array.arr.uintegers.store =
+                                       filter->mmsi,
+                                   .addr.array.count = &filter->nmmsi,
+                                   .addr.array.maxlen = AIS_FILTER_MMSI_MAX},
+        {"aistype",     t_array,   .addr.array.element_type = t_uinteger,
+                                   .addr.array.arr.uintegers.store =
+                                       filter->type,
+                                   .addr.array.count = &filter->ntype,
+                                   .addr.array.maxlen = AIS_FILTER_TYPE_MAX},
+        {"aisinterval", t_real,    .addr.real = &filter->interval,
+                                   .dflt.real = 0.0},
+        {"", t_ignore},
+        {NULL},
+    };
+    // *INDENT-ON*
+    int status;
+    int i;
+
+    memset(filter, 0, sizeof(*filter));
+    status = json_read_object(buf, ais_filter_attrs, endptr);
+    if (0 != status) {
+        memset(filter, 0, sizeof(*filter));
+        return status;
+    }
+    if ((0 != filter->nbox && 4 != filter->nbox) ||
+        (0 != filter->ncircle && 3 != filter->ncircle) ||
+        0 > filter->interval) {
+        memset(filter, 0, sizeof(*filter));
+        return JSON_ERR_MISC;
+    }
+    for (i = 0; i < filter->ntype; i++) {
+        if (1 > filter->type[i] ||
+            AIS_FILTER_TYPE_MAX < filter->type[i]) {
+            memset(filter, 0, sizeof(*filter));
+            return JSON_ERR_MISC;
+        }
+        filter->typemask |= 1UL << filter->type[i];
+    }
+    // a short list, insertion sort it so the daemon can bsearch() it
+    for (i = 1; i < filter->nmmsi; i++) {
+        unsigned int mmsi = filter->mmsi[i];
+        int j;
+
+        for (j = i; 0 < j && filter->mmsi[j - 1] > mmsi; j--) {
+            filter->mmsi[j] = filter->mmsi[j - 1];
+        }
+        filter->mmsi[j] = mmsi;
+    }
+    filter->active = 0 != filter->nbox || 0 != filter->ncircle ||
+                     0 != filter->nmmsi || 0 != filter->ntype ||
+                     0 < filter->interval;
+    return 0;
+}
+
+// append the set AIS filter keys, as ,"key":value pairs, to reply
+void json_ais_filter_dump(const struct ais_filter_t *filter,
+                          char *reply, size_t replylen)
+{
+    int i;
+
+    if (4 == filter->nbox) {
+        str_appendf(reply, replylen,
+                    ",\"aisbox\":[%.7f,%.7f,%.7f,%.7f]",
+                    filter->box[0], filter->box[1],
+                    filter->box[2], filter->box[3]);
+    }
+    if (3 == filter->ncircle) {
+        str_appendf(reply, replylen,
+                    ",\"aiscircle\":[%.7f,%.7f,%.1f]",
+                    filter->circle[0], filter->circle[1], filter->circle[2]);
+    }
+    if (0 < filter->nmmsi) {
+        (void)strlcat(reply, ",\"aismmsi\":[", replylen);
+        for (i = 0; i < filter->nmmsi; i++) {
+            str_appendf(reply, replylen, "%s%u", 0 == i ? "" : ",",
+                        filter->mmsi[i]);
+        }
+        (void)strlcat(reply, "]", replylen);
+    }
+    if (0 < filter->ntype) {
+        (void)strlcat(reply, ",\"aistype\":[", replylen);
+        for (i = 0; i < filter->ntype; i++) {
+            str_appendf(reply, replylen, "%s%u", 0 == i ? "" : ",",
+                        filter->type[i]);
+        }
+        (void)strlcat(reply, "]", replylen);
+    }
+    if (0 < filter->interval) {
+        str_appendf(reply, replylen, ",\"aisinterval\":%.3f",
+                    filter->interval);
+    }
+}
+
 // dump the hoppity skipity orbit_t
 static void json_subframe_dump_orb(const orbit_t *orbit,
                                    const bool scaled UNUSED,
@@ -1337,7 +1917,7 @@ void json_raw_dump(const struct gps_data_t *gpsdata,
                 (long long)gpsdata->raw.mtime.tv_sec,
                 gpsdata->raw.mtime.tv_nsec);
 
-    for (i = 0; i < MAXCHANNELS; i++) {
+    for (i = 0; i < (int)gpsdata->raw.nmeas && i < MAXCHANNELS; i++) {
         if (0 == gpsdata->raw.meas[i].svid ||
             255 == gpsdata->raw.meas[i].svid) {
             // skip empty and GLONASS 255
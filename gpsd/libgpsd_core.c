@@ -17,6 +17,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <libgen.h>
+#include <limits.h>        // for UINT_MAX
 #include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -257,9 +258,66 @@ static void gpsd_run_device_hook(struct gpsd_errout_t *errout,
     }
 }
 
+/* make gpsd_drivers[index] the driver in control of session
+ * Return: 1 (switched) */
+static int switch_driver(struct gps_device_t *session, unsigned int index)
+{
+    const struct gps_type_t *dp = gpsd_drivers[index];
+    bool first_sync = (NULL != session->device_type);
+
+    GPSD_LOG(LOG_PROG, &session->context->errout,
+             "CORE: selecting %s driver...\n", dp->type_name);
+    gpsd_assert_sync(session);
+    session->device_type = dp;
+    session->driver_index = index;
+    session->gpsdata.dev.mincycle = session->device_type->min_cycle;
+    // the new driver decides what rides beside it
+    session->protocols = 0;
+    gpsd_config_start(session);
+    // reconfiguration might be required
+    if (first_sync &&
+        NULL != session->device_type->event_hook) {
+        session->device_type->event_hook(session, EVENT_DRIVER_SWITCH);
+    }
+    if (STICKY(dp)) {
+        session->last_controller = dp;
+    }
+    return 1;
+}
+
+/* index into gpsd_drivers[] of the first driver for each packet type,
+ * -1 for none.  Built on first use, gpsd_drivers[] never changes. */
+static int packet_driver(int packet_type)
+{
+    static int index[MAX_PACKET_TYPE + 1];
+    static bool built = false;
+
+    if (!built) {
+        int i;
+
+        for (i = 0; i <= MAX_PACKET_TYPE; i++) {
+            index[i] = -1;
+        }
+        for (i = 0; NULL != gpsd_drivers[i]; i++) {
+            int type = gpsd_drivers[i]->packet_type;
+
+            if (0 <= type &&
+                MAX_PACKET_TYPE >= type &&
+                -1 == index[type]) {
+                index[type] = i;
+            }
+        }
+        built = true;
+    }
+    if (0 > packet_type ||
+        MAX_PACKET_TYPE < packet_type) {
+        return -1;
+    }
+    return index[packet_type];
+}
+
 int gpsd_switch_driver(struct gps_device_t *session, char *type_name)
 {
-    const struct gps_type_t **dp;
     bool first_sync = (NULL != session->device_type);
     unsigned int i;
 
@@ -271,31 +329,109 @@ int gpsd_switch_driver(struct gps_device_t *session, char *type_name)
 
     GPSD_LOG(LOG_PROG, &session->context->errout,
              "CORE: switch_driver(%s) called...\n", type_name);
-    for (dp = gpsd_drivers, i = 0; *dp; dp++, i++)
-        if (0 == strcmp((*dp)->type_name, type_name)) {
-            GPSD_LOG(LOG_PROG, &session->context->errout,
-                     "CORE: selecting %s driver...\n",
-                     (*dp)->type_name);
-            gpsd_assert_sync(session);
-            session->device_type = *dp;
-            session->driver_index = i;
-            session->gpsdata.dev.mincycle = session->device_type->min_cycle;
-            // reconfiguration might be required
-            if (first_sync &&
-                NULL != session->device_type->event_hook) {
-                session->device_type->event_hook(session,
-                                                 EVENT_DRIVER_SWITCH);
-            }
-            if (STICKY(*dp)) {
-                session->last_controller = *dp;
-            }
-            return 1;
+    for (i = 0; NULL != gpsd_drivers[i]; i++) {
+        if (0 == strcmp(gpsd_drivers[i]->type_name, type_name)) {
+            return switch_driver(session, i);
         }
+    }
     GPSD_LOG(LOG_ERROR, &session->context->errout,
              "CORE: invalid GPS type \"%s\".\n", type_name);
     return 0;
 }
 
+/* (re)start the configuration sequence of the driver in control,
+ * the first step goes at the next gpsd_configure() */
+void gpsd_config_start(struct gps_device_t *session)
+{
+    session->cfg_stage = 0;
+    session->cfg_wait = false;
+    session->cfg_due.tv_sec = 0;
+    session->cfg_due.tv_nsec = 0;
+}
+
+/* the device answered the last configuration step, ACK or NAK,
+ * no need to wait out CONFIG_ACK_WAIT */
+void gpsd_config_ack(struct gps_device_t *session)
+{
+    if (session->cfg_wait) {
+        session->cfg_wait = false;
+        session->cfg_due.tv_sec = 0;
+        session->cfg_due.tv_nsec = 0;
+    }
+}
+
+/* Run the next step of the configuration sequence, if one is due.
+ *
+ * Steps go to the driver's event hook as EVENT_CONFIGURE, with the step
+ * number in cfg_stage.  The next one goes CONFIG_STEP_GAP later, or,
+ * when the hook set cfg_wait, at the ACK/NAK (gpsd_config_ack()) or
+ * after CONFIG_ACK_WAIT, whichever comes first.  So a sequence of n
+ * steps is done in at most n * CONFIG_ACK_WAIT seconds, whatever the
+ * packet rate.  A hook may set cfg_stage to UINT_MAX to stop early.
+ */
+void gpsd_configure(struct gps_device_t *session, const timespec_t *now)
+{
+    const struct gps_type_t *dp = session->device_type;
+    unsigned int step = session->cfg_stage;
+
+    if (UINT_MAX == step) {
+        return;
+    }
+    if (NULL == dp ||
+        NULL == dp->event_hook ||
+        dp->config_steps <= step ||
+        session->context->readonly) {
+        session->cfg_stage = UINT_MAX;
+        return;
+    }
+    if (TS_GT(&session->cfg_due, now)) {
+        return;
+    }
+    if (session->cfg_wait) {
+        GPSD_LOG(LOG_PROG, &session->context->errout,
+                 "CORE: %s config step %u, no ACK/NAK, going on\n",
+                 dp->type_name, step - 1);
+        session->cfg_wait = false;
+    }
+
+    GPSD_LOG(LOG_PROG, &session->context->errout,
+             "CORE: %s config step %u of %u\n",
+             dp->type_name, step, dp->config_steps);
+    dp->event_hook(session, EVENT_CONFIGURE);
+    if (step != session->cfg_stage) {
+        // the hook stopped or restarted the sequence
+        return;
+    }
+    session->cfg_stage++;
+    session->cfg_due = *now;
+    if (session->cfg_wait) {
+        session->cfg_due.tv_sec += CONFIG_ACK_WAIT;
+    } else {
+        session->cfg_due.tv_nsec += CONFIG_STEP_GAP;
+        TS_NORM(&session->cfg_due);
+    }
+}
+
+// lower *timeout to wake up for the next configuration step, if sooner
+void gpsd_config_timeout(const struct gps_device_t *session,
+                         const timespec_t *now, timespec_t *timeout)
+{
+    timespec_t delta;
+
+    if (UINT_MAX == session->cfg_stage ||
+        NULL == session->device_type) {
+        return;
+    }
+    TS_SUB(&delta, &session->cfg_due, now);
+    if (!TS_GZ(&delta)) {
+        delta.tv_sec = 0;
+        delta.tv_nsec = 0;
+    }
+    if (TS_GT(timeout, &delta)) {
+        *timeout = delta;
+    }
+}
+
 void gps_context_init(struct gps_context_t *context,
                       const char *label)
 {
@@ -375,6 +511,9 @@ void gpsd_deactivate(struct gps_device_t *session)
     if (SERVICE_NTRIP == session->servicetype) {
         ntrip_close(session);
     } else
+    if (SOURCE_FED == session->sourcetype) {
+        fed_close(session);
+    } else
 #if defined(NMEA2000_ENABLE)
     if (SOURCE_CAN == session->sourcetype) {
         (void)nmea2000_close(session);
@@ -394,6 +533,8 @@ void gpsd_deactivate(struct gps_device_t *session)
     // mark it inactivated
     session->gpsdata.online.tv_sec = 0;
     session->gpsdata.online.tv_nsec = 0;
+    session->poll_pending = false;
+    session->ready_since.tv_sec = 0;
 }
 
 // shim function to decouple PPS monitor code from the session structure
@@ -628,6 +769,10 @@ int gpsd_open(struct gps_device_t *session)
         session->gpsdata.gps_fd = dsock;
         return session->gpsdata.gps_fd;
     }
+    if (str_starts_with(session->gpsdata.dev.path, "fed://")) {
+        // fed://host[:port][:/device], decoded epochs from a remote gpsd
+        return fed_open(session);
+    }
     if (str_starts_with(session->gpsdata.dev.path, "gpsd://")) {
         /* could be:
          *    gpsd://[ipv6]
@@ -733,6 +878,11 @@ int gpsd_activate(struct gps_device_t *session, const int mode)
         const struct gps_type_t **dp;
 
         for (dp = gpsd_drivers; *dp; dp++) {
+            if (NULL != session->profile &&
+                session->profile->driver != *dp) {
+                // hotplug told us what it is, do not ask the others
+                continue;
+            }
             if (NULL != (*dp)->probe_detect) {
                 GPSD_LOG(LOG_PROG, &session->context->errout,
                          "CORE: Probing \"%s\" driver...\n",
@@ -755,6 +905,11 @@ int gpsd_activate(struct gps_device_t *session, const int mode)
         }
         GPSD_LOG(LOG_PROG, &session->context->errout,
                  "CORE: no probe matched...\n");
+        if (NULL != session->profile) {
+            // no need to wait for a packet to say what it is
+            (void)gpsd_switch_driver(session,
+                                     session->profile->driver->type_name);
+        }
     }
 foundit:
 
@@ -769,6 +924,8 @@ foundit:
         NULL != session->device_type->event_hook) {
         session->device_type->event_hook(session, EVENT_REACTIVATE);
     }
+    // and configure it again
+    gpsd_config_start(session);
     // cast for 32-bit ints
     GPSD_LOG(LOG_PROG, &session->context->errout,
              "CORE: activate fd %ld done\n",
@@ -1541,6 +1698,8 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
 {
     ssize_t newlen;
     bool driver_change = false;
+    // decoder for a packet that rides beside the controlling driver
+    const struct gps_type_t *secondary = NULL;
     timespec_t ts_now;
     timespec_t delta;
     char ts_buf[TIMESPEC_LEN];
@@ -1735,20 +1894,44 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
             driver_change = new_packet_type && !dependent_nmea;
         }
         if (driver_change) {
-            const struct gps_type_t **dp;
+            int index = packet_driver(session->lexer.type);
+
+            if (0 > index) {
+                // nobody decodes it, keep what we have
+                driver_change = false;
+            } else if (NULL != session->device_type &&
+                       (STICKY(session->device_type) ||
+                        NMEA_PACKET == session->device_type->packet_type) &&
+                       !STICKY(gpsd_drivers[index])) {
+                /*
+                 * RTCM, AIVDM, and friends interleaved with the
+                 * controlling driver's own traffic.  Hand the packet
+                 * straight to its decoder, the controller stays.
+                 */
+                int mask = PACKET_TYPEMASK(session->lexer.type);
 
-            for (dp = gpsd_drivers; *dp; dp++)
-                if (session->lexer.type == (*dp)->packet_type) {
-                    GPSD_LOG(LOG_PROG, &session->context->errout,
-                             "CORE: switching to match packet type %d: %s\n",
-                             session->lexer.type, gpsd_prettydump(session));
-                    (void)gpsd_switch_driver(session, (*dp)->type_name);
-                    break;
+                if (0 == (session->protocols & mask)) {
+                    session->protocols |= mask;
+                    GPSD_LOG(LOG_INF, &session->context->errout,
+                             "CORE: %s also carries %s, beside %s\n",
+                             session->gpsdata.dev.path,
+                             gpsd_drivers[index]->type_name,
+                             session->device_type->type_name);
                 }
+                secondary = gpsd_drivers[index];
+                driver_change = false;
+            } else if (session->device_type != gpsd_drivers[index]) {
+                GPSD_LOG(LOG_PROG, &session->context->errout,
+                         "CORE: switching to match packet type %d: %s\n",
+                         session->lexer.type, gpsd_prettydump(session));
+                (void)switch_driver(session, (unsigned int)index);
+            }
         }
         session->badcount = 0;
-        session->gpsdata.dev.driver_mode =
-            (session->lexer.type > NMEA_PACKET) ? MODE_BINARY : MODE_NMEA;
+        if (NULL == secondary) {
+            session->gpsdata.dev.driver_mode =
+                (session->lexer.type > NMEA_PACKET) ? MODE_BINARY : MODE_NMEA;
+        }
     } else if (hunt_failure(session) && !gpsd_next_hunt_setting(session)) {
         (void)clock_gettime(CLOCK_REALTIME, &ts_now);
         TS_SUB(&delta, &ts_now, &session->gpsdata.online);
@@ -1822,12 +2005,6 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
         session->lexer.counter++;
     }
 
-    // fire the configure hook, on every packet.  Seems excessive...
-    if (NULL != session->device_type &&
-        NULL != session->device_type->event_hook) {
-        session->device_type->event_hook(session, EVENT_CONFIGURE);
-    }
-
     GPSD_LOG(LOG_RAW, &session->context->errout,
              "CORE: raw packet of type %d, %zd:%s\n",
              session->lexer.type,
@@ -1837,11 +2014,15 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
     // Get data from current packet into the fix structure
     if (COMMENT_PACKET != session->lexer.type &&
         BAD_PACKET != session->lexer.type &&
-        NULL != session->device_type &&
-        NULL != session->device_type->parse_packet) {
-            received |= session->device_type->parse_packet(session);
+        NULL != session->device_type) {
+        const struct gps_type_t *decoder =
+            (NULL != secondary) ? secondary : session->device_type;
+
+        if (NULL != decoder->parse_packet) {
+            received |= decoder->parse_packet(session);
             GPSD_LOG(LOG_SPIN, &session->context->errout,
                      "CORE: parse_packet() = %s\n", gps_maskdump(received));
+        }
     }
 
     /*
@@ -1960,12 +2141,25 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
     return session->gpsdata.set;
 }
 
-// consume and handle packets from a specified device
+/* read and handle the packets of a device
+ * budget is the most packets to handle, 0 for all there are.  When
+ * it runs out device->poll_pending is set, call again with data_ready
+ * even if the fd is not readable, packets may be buffered.
+ */
 int gpsd_multipoll(const bool data_ready,
                    struct gps_device_t *device,
                    void (*handler)(struct gps_device_t *, gps_mask_t),
-                   float reawake_time)
+                   float reawake_time, unsigned budget)
 {
+    timespec_t now;
+    bool was_pending = device->poll_pending;
+
+    device->poll_pending = false;
+
+    // configuration goes by the clock, not by the packet
+    (void)clock_gettime(CLOCK_REALTIME, &now);
+    gpsd_configure(device, &now);
+
     if (data_ready) {
         int fragments;
 
@@ -2026,8 +2220,11 @@ int gpsd_multipoll(const bool data_ready,
                 /*
                  * No data on the first fragment read means the device
                  * fd may have been in an end-of-file condition on select.
+                 * Not if it was called back for a partial packet left
+                 * when the budget ran out.
                  */
-                if (0 == fragments) {
+                if (0 == fragments &&
+                    !was_pending) {
                     GPSD_LOG(LOG_DATA, &device->context->errout,
                              "CORE: %s returned zero bytes\n",
                              device->gpsdata.dev.path);
@@ -2101,6 +2298,13 @@ int gpsd_multipoll(const bool data_ready,
                 handler(device, changed);
             }
 
+            // leave the rest for the next pass, other devices are waiting
+            if (0 < budget &&
+                budget <= (unsigned)fragments + 1) {
+                device->poll_pending = 0 < packet_buffered_input(&device->lexer);
+                return DEVICE_UNCHANGED;
+            }
+
 #ifdef __future__
             // this breaks: test/daemon/passthrough.log ??
             /*
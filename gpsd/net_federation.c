@@ -0,0 +1,416 @@
+/* net_federation.c -- take decoded epochs from an upstream gpsd
+ *
+ * A fed:// source makes this gpsd a client of another one.  Unlike
+ * gpsd://, which passes the upstream JSON through as text, it asks
+ * the upstream for delta encoded, deflate compressed reports from the
+ * devices it names, and unpacks each TPV, SKY, GST and AIS straight
+ * into the session.  Nothing goes through the packet lexer or a
+ * receiver driver; local clients, SHM and D-Bus are fed from the
+ * session like for any other device.
+ *
+ *    fed://host[:port][:/device]
+ *
+ * Without a device every upstream device is merged into this one.
+ * When the upstream goes away, reconnects back off from FED_BACKOFF_MIN
+ * to FED_BACKOFF_MAX seconds, and start over once reports flow again.
+ *
+ * This file is Copyright by the GPSD project
+ * SPDX-License-Identifier: BSD-2-clause
+ */
+
+#include "../include/gpsd_config.h"   // must be before all includes
+
+#include <errno.h>                    // for errno
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZLIB
+    #include <zlib.h>                 // for inflate()
+#endif  // HAVE_ZLIB
+
+#include "../include/gpsd.h"
+#include "../include/gps_json.h"       // needs gpsd.h
+#include "../include/strfuncs.h"
+
+#define FED_URI         "fed://"
+#define FED_BACKOFF_MIN 2               // seconds
+#define FED_BACKOFF_MAX 64              // seconds
+
+struct fed_stream_t {
+#ifdef HAVE_ZLIB
+    z_stream zs;
+    bool compressed;            // past the WATCH, the rest is deflated
+#endif  // HAVE_ZLIB
+    size_t inlen;               // bytes read, not yet decoded
+    unsigned char in[GPS_JSON_RESPONSE_MAX * 2];
+    struct gps_data_t upstream; // the report just unpacked
+    struct privdata_t priv;     // delta base for upstream
+};
+
+// the next retry waits twice as long as the last one
+static void fed_backoff(struct gps_device_t *session)
+{
+    if (FED_BACKOFF_MIN > session->fed.backoff) {
+        session->fed.backoff = FED_BACKOFF_MIN;
+    } else if (FED_BACKOFF_MAX / 2 >= session->fed.backoff) {
+        session->fed.backoff *= 2;
+    } else {
+        session->fed.backoff = FED_BACKOFF_MAX;
+    }
+    session->fed.retry = time(NULL) + session->fed.backoff;
+}
+
+static void fed_free(struct gps_device_t *session)
+{
+    if (NULL == session->fed.stream) {
+        return;
+    }
+#ifdef HAVE_ZLIB
+    (void)inflateEnd(&session->fed.stream->zs);
+#endif  // HAVE_ZLIB
+    free(session->fed.stream);
+    session->fed.stream = NULL;
+}
+
+/* open a federation link to an upstream gpsd
+ *
+ * Return: socket on success
+ *         PLACEHOLDING_FD (-2) while waiting to retry
+ *         UNALLOCATED_FD (-1) on a bad URI, or out of memory
+ */
+socket_t fed_open(struct gps_device_t *session)
+{
+    char server[GPS_PATH_MAX], *host, *port, *device;
+    char watch[GPS_PATH_MAX + 128];
+    time_t now = time(NULL);
+    socket_t dsock;
+    ssize_t wlen;
+
+    session->sourcetype = SOURCE_FED;
+    INVALIDATE_SOCKET(session->gpsdata.gps_fd);
+    (void)strlcpy(server, session->gpsdata.dev.path + sizeof(FED_URI) - 1,
+                  sizeof(server));
+    if (-1 == parse_uri_dest(server, &host, &port, &device)) {
+        GPSD_LOG(LOG_ERROR, &session->context->errout,
+                 "FED: malformed URI %s\n", session->gpsdata.dev.path);
+        return UNALLOCATED_FD;
+    }
+    if (NULL == port) {
+        port = DEFAULT_GPSD_PORT;
+    }
+    if (now < session->fed.retry) {
+        GPSD_LOG(LOG_PROG, &session->context->errout,
+                 "FED: %s, next try in %lld sec\n",
+                 session->gpsdata.dev.path,
+                 (long long)(session->fed.retry - now));
+        return PLACEHOLDING_FD;
+    }
+
+    dsock = netlib_connectsock(AF_UNSPEC, host, port, "tcp");
+    if (0 > dsock) {
+        fed_backoff(session);
+        // cast for 32-bit ints
+        GPSD_LOG(LOG_WARN, &session->context->errout,
+                 "FED: can't connect to %s:%s, %s(%ld), retry in %d sec\n",
+                 host, port, netlib_errstr(dsock), (long)dsock,
+                 session->fed.backoff);
+        return PLACEHOLDING_FD;
+    }
+
+    fed_free(session);
+    session->fed.stream = calloc(1, sizeof(struct fed_stream_t));
+    if (NULL == session->fed.stream) {
+        GPSD_LOG(LOG_ERROR, &session->context->errout,
+                 "FED: out of memory for %s\n", session->gpsdata.dev.path);
+        (void)close(dsock);
+        return UNALLOCATED_FD;
+    }
+    session->fed.stream->upstream.privdata = &session->fed.stream->priv;
+
+    // the upstream must know delta and compress, this gpsd or later
+    (void)strlcpy(watch, "?WATCH={\"enable\":true,\"json\":true,"
+                  "\"delta\":true", sizeof(watch));
+#ifdef HAVE_ZLIB
+    if (Z_OK == inflateInit(&session->fed.stream->zs)) {
+        (void)strlcat(watch, ",\"compress\":\"deflate\"", sizeof(watch));
+    }
+#endif  // HAVE_ZLIB
+    if (NULL != device) {
+        str_appendf(watch, sizeof(watch), ",\"device\":\"%s\"", device);
+    }
+    (void)strlcat(watch, "};\r\n", sizeof(watch));
+    wlen = (ssize_t)strnlen(watch, sizeof(watch));
+    if (wlen != write(dsock, watch, wlen)) {
+        fed_backoff(session);
+        GPSD_LOG(LOG_WARN, &session->context->errout,
+                 "FED: subscribe to %s:%s failed, retry in %d sec\n",
+                 host, port, session->fed.backoff);
+        (void)close(dsock);
+        fed_free(session);
+        return PLACEHOLDING_FD;
+    }
+    // cast for 32-bit ints
+    GPSD_LOG(LOG_PROG, &session->context->errout,
+             "FED: subscribed to %s:%s%s%s on fd %ld\n", host, port,
+             NULL == device ? "" : " device ",
+             NULL == device ? "" : device, (long)dsock);
+
+    (void)gpsd_switch_driver(session, "GPSD federation");
+    session->gpsdata.gps_fd = dsock;
+    return dsock;
+}
+
+// close the link, and hold off the reconnect
+void fed_close(struct gps_device_t *session)
+{
+    if (!BAD_SOCKET(session->gpsdata.gps_fd)) {
+        // cast for 32-bit ints
+        GPSD_LOG(LOG_SPIN, &session->context->errout,
+                 "close(%ld) in fed_close(%s)\n",
+                 (long)session->gpsdata.gps_fd, session->gpsdata.dev.path);
+        (void)close(session->gpsdata.gps_fd);
+        INVALIDATE_SOCKET(session->gpsdata.gps_fd);
+        fed_backoff(session);
+    }
+    fed_free(session);
+}
+
+/* Move read bytes to the lexer input buffer.  Plain text goes one
+ * line at a time, so the WATCH that turns compression on is seen
+ * before the bytes after it are looked at.
+ *
+ * Return: false on a broken compressed stream
+ */
+static bool fed_decode(struct gps_device_t *session,
+                       struct fed_stream_t *fed)
+{
+    struct gps_lexer_t *lexer = &session->lexer;
+    size_t room = sizeof(lexer->inbuffer) - 1 - lexer->inbuflen;
+    size_t used = 0;
+
+#ifdef HAVE_ZLIB
+    if (fed->compressed) {
+        int status;
+
+        fed->zs.next_in = fed->in;
+        fed->zs.avail_in = (uInt)fed->inlen;
+        fed->zs.next_out = lexer->inbuffer + lexer->inbuflen;
+        fed->zs.avail_out = (uInt)room;
+        status = inflate(&fed->zs, Z_SYNC_FLUSH);
+        if (Z_OK != status &&
+            Z_BUF_ERROR != status) {
+            GPSD_LOG(LOG_ERROR, &session->context->errout,
+                     "FED: %s inflate() failed, %d\n",
+                     session->gpsdata.dev.path, status);
+            return false;
+        }
+        used = fed->inlen - fed->zs.avail_in;
+        lexer->inbuflen += room - fed->zs.avail_out;
+    } else
+#endif  // HAVE_ZLIB
+    {
+        unsigned char *nl = memchr(fed->in, '\n', fed->inlen);
+
+        used = NULL == nl ? fed->inlen : (size_t)(nl - fed->in) + 1;
+        if (room < used) {
+            used = room;
+        }
+        memcpy(lexer->inbuffer + lexer->inbuflen, fed->in, used);
+        lexer->inbuflen += used;
+    }
+    fed->inlen -= used;
+    memmove(fed->in, fed->in + used, fed->inlen);
+    return true;
+}
+
+/* Take the first whole line of the lexer input buffer into outbuffer,
+ * without the line end.
+ *
+ * Return: true if there was one
+ */
+static bool fed_line(struct gps_device_t *session, struct fed_stream_t *fed)
+{
+    struct gps_lexer_t *lexer = &session->lexer;
+    unsigned char *nl = memchr(lexer->inbuffer, '\n', lexer->inbuflen);
+    size_t len, linelen;
+
+    if (NULL == nl) {
+        if (sizeof(lexer->inbuffer) - 1 <= lexer->inbuflen) {
+            GPSD_LOG(LOG_WARN, &session->context->errout,
+                     "FED: %s overlong report dropped\n",
+                     session->gpsdata.dev.path);
+            lexer->inbuflen = 0;
+        }
+        return false;
+    }
+    len = (size_t)(nl - lexer->inbuffer) + 1;
+    linelen = len - 1;
+    if (0 < linelen &&
+        '\r' == lexer->inbuffer[linelen - 1]) {
+        linelen--;
+    }
+    memcpy(lexer->outbuffer, lexer->inbuffer, linelen);
+    lexer->outbuffer[linelen] = '\0';
+    lexer->outbuflen = linelen;
+    lexer->inbuflen -= len;
+    memmove(lexer->inbuffer, lexer->inbuffer + len, lexer->inbuflen);
+
+#ifdef HAVE_ZLIB
+    if (!fed->compressed &&
+        str_starts_with((char *)lexer->outbuffer, "{\"class\":\"WATCH\"") &&
+        NULL != strstr((char *)lexer->outbuffer,
+                       "\"compress\":\"deflate\"")) {
+        GPSD_LOG(LOG_PROG, &session->context->errout,
+                 "FED: %s compressed from here on\n",
+                 session->gpsdata.dev.path);
+        fed->compressed = true;
+    }
+#endif  // HAVE_ZLIB
+    return true;
+}
+
+/* Get the next report line into lexer.outbuffer, reading the socket
+ * only when none is buffered.
+ *
+ * Return: number of bytes read, or the line length
+ *         0 for no data
+ *         -1 on error or EOF
+ */
+static ssize_t fed_get(struct gps_device_t *session)
+{
+    struct fed_stream_t *fed = session->fed.stream;
+    ssize_t got = 0;
+
+    // never BAD_PACKET, gpsd_poll() would go hunting
+    session->lexer.type = JSON_PACKET;
+    session->lexer.outbuflen = 0;
+    if (NULL == fed ||
+        !fed_decode(session, fed)) {
+        return -1;
+    }
+    if (fed_line(session, fed)) {
+        return (ssize_t)session->lexer.outbuflen;
+    }
+    if (sizeof(fed->in) > fed->inlen) {
+        got = read(session->gpsdata.gps_fd, fed->in + fed->inlen,
+                   sizeof(fed->in) - fed->inlen);
+        if (0 > got) {
+            if (EAGAIN == errno ||
+                EINTR == errno) {
+                return 0;
+            }
+            GPSD_LOG(LOG_WARN, &session->context->errout,
+                     "FED: %s read error %s(%d)\n",
+                     session->gpsdata.dev.path, strerror(errno), errno);
+            return -1;
+        }
+        if (0 == got) {
+            GPSD_LOG(LOG_WARN, &session->context->errout,
+                     "FED: %s upstream closed\n",
+                     session->gpsdata.dev.path);
+            return -1;
+        }
+        fed->inlen += got;
+        session->lexer.char_counter += got;
+    }
+    if (!fed_decode(session, fed)) {
+        return -1;
+    }
+    (void)fed_line(session, fed);
+    return got;
+}
+
+// unpack one upstream report into the session
+static gps_mask_t fed_parse(struct gps_device_t *session)
+{
+    struct fed_stream_t *fed = session->fed.stream;
+    struct gps_data_t *up;
+    gps_mask_t mask = 0;
+    int status;
+
+    if (NULL == fed) {
+        return 0;
+    }
+    up = &fed->upstream;
+    up->set = 0;
+    status = libgps_json_unpack((const char *)session->lexer.outbuffer,
+                                up, NULL);
+    if (0 != status) {
+        GPSD_LOG(LOG_WARN, &session->context->errout,
+                 "FED: %s bad report, %s: %s\n",
+                 session->gpsdata.dev.path,
+                 0 > status ? "no class" : json_error_string(status),
+                 (char *)session->lexer.outbuffer);
+        return 0;
+    }
+
+    if (0 != (up->set & ERROR_SET)) {
+        GPSD_LOG(LOG_WARN, &session->context->errout,
+                 "FED: %s upstream says: %s\n",
+                 session->gpsdata.dev.path, up->error);
+        return 0;
+    }
+    if (0 != (up->set & STATUS_SET)) {
+        // TPV, only TPV sets STATUS_SET
+        session->newdata = up->fix;
+        mask = up->set | CLEAR_IS | REPORT_IS;
+    } else if (0 != (up->set & (SATELLITE_SET | DOP_SET))) {
+        if (0 != (up->set & SATELLITE_SET)) {
+            (void)memcpy(session->gpsdata.skyview, up->skyview,
+                         sizeof(session->gpsdata.skyview));
+            session->gpsdata.satellites_visible = up->satellites_visible;
+            session->gpsdata.satellites_used = up->satellites_used;
+            session->gpsdata.skyview_time = up->skyview_time;
+            mask |= SATELLITE_SET | USED_IS;
+        }
+        if (0 != (up->set & DOP_SET)) {
+            session->gpsdata.dop = up->dop;
+            mask |= DOP_SET;
+        }
+    } else if (0 != (up->set & GST_SET)) {
+        session->gpsdata.gst = up->gst;
+        mask = GST_SET;
+#ifdef AIVDM_ENABLE
+    } else if (0 != (up->set & AIS_SET)) {
+        session->gpsdata.ais = up->ais;
+        mask = AIS_SET;
+#endif  // AIVDM_ENABLE
+    } else {
+        // VERSION, DEVICES, WATCH, and classes not federated
+        return 0;
+    }
+    // reports flow, next outage starts backing off from the bottom
+    session->fed.backoff = 0;
+    return mask;
+}
+
+// *INDENT-OFF*
+const struct gps_type_t driver_federation = {
+    .type_name      = "GPSD federation",  // full name of type
+    .packet_type    = JSON_PACKET,      // associated lexer packet type
+    .flags          = DRIVER_STICKY,    // remember this
+    .trigger        = NULL,             // selected by fed_open()
+    .channels       = 0,                // not used
+    .probe_detect   = NULL,             // no probe
+    .get_packet     = fed_get,          // split reports, no lexer
+    .parse_packet   = fed_parse,        // unpack into the session
+    .rtcm_writer    = NULL,             // upstream gets no RTCM
+    .init_query     = NULL,             // non-perturbing initial query
+    .event_hook     = NULL,             // lifetime event handler
+    .speed_switcher = NULL,             // no speed switcher
+    .mode_switcher  = NULL,             // no mode switcher
+    .rate_switcher  = NULL,             // no sample-rate switcher
+    .min_cycle.tv_sec  = 1,             // not relevant, no rate switch
+    .min_cycle.tv_nsec = 0,             // not relevant, no rate switch
+    .control_send   = NULL,             // how to send control strings
+    .time_offset     = NULL,            // no method for NTP fudge factor
+};
+// *INDENT-ON*
+
+// vim: set expandtab shiftwidth=4
@@ -410,6 +410,9 @@ static bool character_pushback(struct gps_lexer_t *lexer,
 {
     --lexer->inbufptr;
     --lexer->char_counter;
+    if (LEXER_STATES > lexer->state) {
+        lexer->stats.pushbacks[lexer->state]++;
+    }
     lexer->state = newstate;
     if (lexer->errout.debug >= LOG_RAW2) {
         unsigned char c = *lexer->inbufptr;
@@ -429,6 +432,8 @@ static void character_discard(struct gps_lexer_t *lexer)
 {
     memmove(lexer->inbuffer, lexer->inbuffer + 1, (size_t)-- lexer->inbuflen);
     lexer->inbufptr = lexer->inbuffer;
+    lexer->stats.discarded++;
+    lexer->stats.resync++;
     if (lexer->errout.debug >= LOG_RAW1) {
         char scratchbuf[MAX_PACKET_LENGTH*4+1];
 
@@ -2053,6 +2058,101 @@ static bool nextstate(struct gps_lexer_t *lexer, unsigned char c)
     return true;        // no pushback
 }
 
+/* the packet type a _RECOGNIZED state claims, for counting bad ones.
+ * TSIP_RECOGNIZED may also be Garmin. */
+static int recognized_type(unsigned state)
+{
+    switch (state) {
+    case AIS_RECOGNIZED:
+        return AIVDM_PACKET;
+    case ALLY_RECOGNIZED:
+        return ALLYSTAR_PACKET;
+#ifdef EVERMORE_ENABLE
+    case EVERMORE_RECOGNIZED:
+        return EVERMORE_PACKET;
+#endif  // EVERMORE_ENABLE
+#ifdef GEOSTAR_ENABLE
+    case GEOSTAR_RECOGNIZED:
+        return GEOSTAR_PACKET;
+#endif  // GEOSTAR_ENABLE
+#ifdef GREIS_ENABLE
+    case GREIS_RECOGNIZED:
+        return GREIS_PACKET;
+#endif  // GREIS_ENABLE
+#if defined(TNT_ENABLE) || defined(GARMINTXT_ENABLE) || defined(ONCORE_ENABLE)
+    case GTXT_RECOGNIZED:
+        return GARMINTXT_PACKET;
+#endif  // TNT_ENABLE || GARMINTXT_ENABLE || ONCORE_ENABLE
+#ifdef ITRAX_ENABLE
+    case ITALK_RECOGNIZED:
+        return ITALK_PACKET;
+#endif  // ITRAX_ENABLE
+    case JSON_RECOGNIZED:
+        return JSON_PACKET;
+#ifdef NAVCOM_ENABLE
+    case NAVCOM_RECOGNIZED:
+        return NAVCOM_PACKET;
+#endif  // NAVCOM_ENABLE
+    case NMEA_RECOGNIZED:
+        return NMEA_PACKET;
+#ifdef ONCORE_ENABLE
+    case ONCORE_RECOGNIZED:
+        return ONCORE_PACKET;
+#endif  // ONCORE_ENABLE
+    case RTCM2_RECOGNIZED:
+        return RTCM2_PACKET;
+    case RTCM3_RECOGNIZED:
+        return RTCM3_PACKET;
+#ifdef SIRF_ENABLE
+    case SIRF_RECOGNIZED:
+        return SIRF_PACKET;
+#endif  // SIRF_ENABLE
+#ifdef SKYTRAQ_ENABLE
+    case SKY_RECOGNIZED:
+        return SKY_PACKET;
+#endif  // SKYTRAQ_ENABLE
+#ifdef SUPERSTAR2_ENABLE
+    case SUPERSTAR2_RECOGNIZED:
+        return SUPERSTAR2_PACKET;
+#endif  // SUPERSTAR2_ENABLE
+#if defined(TSIP_ENABLE) || defined(GARMIN_ENABLE)
+    case TSIP_RECOGNIZED:
+        return TSIP_PACKET;
+    case GARMIN_RECOGNIZED:
+        return GARMIN_PACKET;
+#endif  // TSIP_ENABLE || GARMIN_ENABLE
+    case UBX_RECOGNIZED:
+        return UBX_PACKET;
+#ifdef ZODIAC_ENABLE
+    case ZODIAC_RECOGNIZED:
+        return ZODIAC_PACKET;
+#endif  // ZODIAC_ENABLE
+    default:
+        return COMMENT_PACKET;
+    }
+}
+
+/* count a packet leaving the lexer, good or bad
+ * recognized is the _RECOGNIZED state it was found in */
+static void packet_count(struct gps_lexer_t *lexer, int packet_type,
+                         unsigned recognized)
+{
+    if (BAD_PACKET == packet_type) {
+        lexer->stats.bad[recognized_type(recognized)]++;
+        lexer->stats.discarded += lexer->inbufptr - lexer->inbuffer;
+        lexer->stats.resync += lexer->inbufptr - lexer->inbuffer;
+        return;
+    }
+    if (0 <= packet_type &&
+        MAX_PACKET_TYPE >= packet_type) {
+        lexer->stats.accepted[packet_type]++;
+    }
+    if (lexer->stats.max_resync < lexer->stats.resync) {
+        lexer->stats.max_resync = lexer->stats.resync;
+    }
+    lexer->stats.resync = 0;
+}
+
 // packet grab succeeded, move to output buffer
 static void packet_accept(struct gps_lexer_t *lexer, int packet_type)
 {
@@ -2153,6 +2253,76 @@ static void packet_unstash(struct gps_lexer_t *lexer)
 
 // entry points begin here
 
+// name of packet type, for reports
+const char *packet_type_name(int type)
+{
+    static const char *names[] = {
+        "COMMENT", "NMEA", "AIVDM", "GARMINTXT", "SIRF", "ZODIAC", "TSIP",
+        "EVERMORE", "ITALK", "GARMIN", "NAVCOM", "UBX", "SUPERSTAR2",
+        "ONCORE", "GEOSTAR", "NMEA2000", "GREIS", "SKY", "ALLYSTAR",
+        "RTCM2", "RTCM3", "JSON",
+    };
+
+    if (0 > type ||
+        (int)ROWS(names) <= type) {
+        return "BAD";
+    }
+    return names[type];
+}
+
+// name of lexer state, for reports
+const char *packet_state_name(unsigned state)
+{
+    if (ROWS(state_table) <= state) {
+        return "UNKNOWN";
+    }
+    return state_table[state];
+}
+
+// one line of the lexer counters, the nonzero ones, for gpsdecode, gpsmon
+char *packet_stats_dump(const struct gps_lexer_t *lexer,
+                        char *buf, size_t buflen)
+{
+    int i;
+
+    (void)snprintf(buf, buflen, "chars %lu discarded %lu maxresync %lu",
+                   lexer->char_counter, lexer->stats.discarded,
+                   lexer->stats.max_resync);
+    (void)strlcat(buf, " accepted", buflen);
+    for (i = 0; i <= MAX_PACKET_TYPE; i++) {
+        if (0 != lexer->stats.accepted[i]) {
+            str_appendf(buf, buflen, " %s:%lu", packet_type_name(i),
+                        lexer->stats.accepted[i]);
+        }
+    }
+    (void)strlcat(buf, " bad", buflen);
+    for (i = 0; i <= MAX_PACKET_TYPE; i++) {
+        if (0 != lexer->stats.bad[i]) {
+            str_appendf(buf, buflen, " %s:%lu", packet_type_name(i),
+                        lexer->stats.bad[i]);
+        }
+    }
+    (void)strlcat(buf, " pushbacks", buflen);
+    for (i = 0; i < LEXER_STATES; i++) {
+        if (0 != lexer->stats.pushbacks[i]) {
+            str_appendf(buf, buflen, " %s:%lu",
+                        packet_state_name((unsigned)i),
+                        lexer->stats.pushbacks[i]);
+        }
+    }
+    // reads by smallest size in the bin
+    str_appendf(buf, buflen, " overflows %lu reads",
+                lexer->stats.overflows);
+    for (i = 0; i < LEXER_READ_BINS; i++) {
+        if (0 != lexer->stats.reads[i]) {
+            str_appendf(buf, buflen, " %lu:%lu",
+                        0 == i ? 0UL : 1UL << (i - 1),
+                        lexer->stats.reads[i]);
+        }
+    }
+    return buf;
+}
+
 // reset lexer structure
 void lexer_init(struct gps_lexer_t *lexer, struct gpsd_errout_t *errout)
 {
@@ -2192,6 +2362,7 @@ void packet_parse(struct gps_lexer_t *lexer)
         bool unstash;
         unsigned char *trailer;
         unsigned char ck_a, ck_b;  // for ubx check bytes
+        unsigned recognized;    // the state before the checks
 
         if (!nextstate(lexer, c)) {
             continue;
@@ -2204,6 +2375,7 @@ void packet_parse(struct gps_lexer_t *lexer)
         inbuflen = lexer->inbufptr - lexer->inbuffer;
         acc_dis = PASS;
         unstash = false;
+        recognized = lexer->state;
 
         /* check if we have a _RECOGNISED state, if so, perform final
          * checks on the packet, before decoding.
@@ -2340,6 +2512,16 @@ void packet_parse(struct gps_lexer_t *lexer)
                 packet_type = GREIS_PACKET;
                 break;
             }
+#ifdef GREIS_SKIP_ENABLE
+            if (GREIS_MSG_NONE == greis_msg_of(lexer->inbuffer)) {
+                // nothing decodes it, don't spend a checksum on it
+                GPSD_LOG(LOG_IO, &lexer->errout,
+                         "Skip GREIS packet type '%c%c' len %d\n",
+                         lexer->inbuffer[0], lexer->inbuffer[1], inbuflen);
+                packet_type = GREIS_PACKET;
+                break;
+            }
+#endif  // GREIS_SKIP_ENABLE
             // 8-bit checksum
             crc_computed = greis_checksum(lexer->inbuffer, inbuflen);
 
@@ -2375,10 +2557,12 @@ void packet_parse(struct gps_lexer_t *lexer)
         case GTXT_RECOGNIZED:
             // As of June 2023, we have no regression of GARMINTXT.
             if (57 <= inbuflen) {
+                packet_count(lexer, GARMINTXT_PACKET, recognized);
                 packet_accept(lexer, GARMINTXT_PACKET);
                 packet_discard(lexer);
                 lexer->state = GROUND_STATE;
             } else {
+                packet_count(lexer, BAD_PACKET, recognized);
                 packet_accept(lexer, BAD_PACKET);
                 lexer->state = GROUND_STATE;
             }
@@ -3033,6 +3217,7 @@ void packet_parse(struct gps_lexer_t *lexer)
 
         }
         if (ACCEPT == acc_dis) {
+            packet_count(lexer, packet_type, recognized);
             packet_accept(lexer, packet_type);
             packet_discard(lexer);
 #ifdef STASH_ENABLE
@@ -3437,6 +3622,19 @@ ssize_t packet_get1(struct gps_device_t *session)
         return packet_get1_chunked(session);
     }
 
+    /* A big read can hold many packets.  Hand out the ones already
+     * buffered before asking the device for more, a read() per packet
+     * is mostly EAGAIN. */
+    if (0 < packet_buffered_input(lexer)) {
+        packet_parse(lexer);
+        if (0 < lexer->outbuflen) {
+            GPSD_LOG(LOG_IO, &lexer->errout,
+                     "PACKET: packet_get1(fd %d) buffered outbuflen %zd\n",
+                     fd, lexer->outbuflen);
+            return (ssize_t)lexer->outbuflen;
+        }
+    }
+
     errno = 0;
     /* O_NONBLOCK set, so this should not block.
      * Best not to block on an unresponsive GNSS receiver */
@@ -3463,6 +3661,17 @@ ssize_t packet_get1(struct gps_device_t *session)
                                  lexer->inbufptr, (size_t) recvd));
         lexer->inbuflen += recvd;
     }
+    if (0 <= recvd) {
+        // bin 0 for no bytes, else bin n for 2^(n-1) to 2^n - 1 bytes
+        unsigned bin = 0;
+        size_t n;
+
+        for (n = (size_t)recvd; 0 < n && (LEXER_READ_BINS - 1) > bin;
+             n >>= 1) {
+            bin++;
+        }
+        lexer->stats.reads[bin]++;
+    }
     GPSD_LOG(LOG_SPIN, &lexer->errout,
              "PACKET: packet_get1(fd %d) recvd %zd %s(%d)\n",
              fd, recvd, strerror(errno), errno);
@@ -3485,6 +3694,9 @@ ssize_t packet_get1(struct gps_device_t *session)
 
     // if input buffer is full, discard
     if (sizeof(lexer->inbuffer) <= (lexer->inbuflen)) {
+        lexer->stats.overflows++;
+        lexer->stats.discarded += lexer->inbufptr - lexer->inbuffer;
+        lexer->stats.resync += lexer->inbufptr - lexer->inbuffer;
         // coverity[tainted_data]
         packet_discard(lexer);
         lexer->state = GROUND_STATE;
@@ -22,6 +22,7 @@
 #ifdef AIVDM_ENABLE
 
 #define AIS_MSG_PART2_FLAG 0x100
+#define AIS_PAYLOAD_MAX    1008         // most payload bits, 168 armored chars
 
 static unsigned char convtab[] = {
     "0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVW`abcdefghijklmnopqrstuvw"};
@@ -43,300 +44,569 @@ static unsigned char contab1[] = {
     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 
-static void ais_addbits(unsigned char *bits,
-                        unsigned int   start,
-                        unsigned int   len,
-                        uint64_t       data)
-{
-    unsigned int  l;
-    unsigned int  pos;
-    uint64_t      mask;
-    unsigned int  mask1;
-
-    mask  = 0x1;
-    pos   = (start + len - 1) / 6;
-    mask1 = 0x20;
-    mask1 = mask1 >> ((start + len - 1) % 6);
+/* Payloads are built with a small bit writer.  Fields go into a 64 bit
+ * accumulator, MSB first, and whole six-bit symbols are armored with
+ * convtab[] as soon as they are complete, so each field costs a shift,
+ * an or, and a table lookup per symbol instead of a loop per bit.
+ * Fields are written in payload order; gaps (spare bits) are written as
+ * zeros.
+ */
+struct sixbit_writer_t {
+    unsigned char *out;         // next armored character
+    uint64_t acc;               // pending bits, right aligned
+    unsigned int nacc;          // number of pending bits, < 6 between calls
+    unsigned int len;           // payload bits written so far
+    bool overflow;              // more than AIS_PAYLOAD_MAX, nothing written
+};
 
-    if (0 == len) {
+// append the low width bits of data, width at most 32
+static void ais_putbits(struct sixbit_writer_t *w, unsigned int width,
+                        uint64_t data)
+{
+    if (0 == width ||
+        w->overflow) {
         return;
     }
-
-    for(l = 0; l < len; l++) {
-        if (data & mask) {
-            bits[pos] |= mask1;
-        }
-        mask  <<= 1;
-        mask1 <<= 1;
-        if (0x40 == mask1) {
-            pos   -= 1;
-            mask1  = 0x1;
-        }
+    if (AIS_PAYLOAD_MAX - w->len < width) {
+        w->overflow = true;
+        return;
+    }
+    w->acc = (w->acc << width) | (data & ((UINT64_C(1) << width) - 1));
+    w->nacc += width;
+    w->len += width;
+    while (6 <= w->nacc) {
+        w->nacc -= 6;
+        *w->out++ = convtab[(w->acc >> w->nacc) & 0x3f];
     }
-    return;
 }
 
+// pad the field that should start at start with zeros
+static void ais_skipto(struct sixbit_writer_t *w, unsigned int start)
+{
+    while (w->len < start &&
+           !w->overflow) {
+        unsigned int gap = start - w->len;
 
-static void ais_addchar(unsigned char *bits,
-                        unsigned int   start,
-                        unsigned int   len,
-                        char          *data)
+        ais_putbits(w, 32 < gap ? 32 : gap, 0);
+    }
+}
+
+/* append count six-bit characters from data, '@' (zero) after the end
+ * of the string.  Characters outside the six-bit set become '?'.
+ */
+static void ais_putchars(struct sixbit_writer_t *w, unsigned int count,
+                         const char *data)
 {
+    uint64_t word = 0;
+    unsigned int n = 0;
     unsigned int l;
-    unsigned int flag;
 
-    for(l = 0, flag = 0; l < len; l++) {
-        unsigned char a, b;
+    // five characters to a 30 bit word
+    for (l = 0; l < count; l++) {
+        unsigned char a = (unsigned char)data[l];
 
-        a = (unsigned char) data[l];
-        if ((unsigned char)'\0' == a) {
-            flag = 1;
+        if ('\0' == a) {
+            break;
         }
-        if (0 == flag) {
-            b = contab1[a & 0x7f];
-        } else {
-            b = (unsigned char)'\0';
+        word = (word << 6) | (contab1[a & 0x7f] & 0x3f);
+        if (5 == ++n) {
+            ais_putbits(w, 30, word);
+            word = 0;
+            n = 0;
         }
-        ais_addbits(bits, start+6*l, 6, (uint64_t)b);
     }
-    return;
+    ais_putbits(w, 6 * n, word);
+    // zeros after the end of the string
+    ais_skipto(w, w->len + 6 * (count - l));
 }
 
-
-static void ais_adddata(unsigned char *bits,
-                   unsigned int   start,
-                   unsigned int   len,
-                   char          *data)
+// append bitcount bits from data, MSB first, as unpacked from JSON
+static void ais_putdata(struct sixbit_writer_t *w, const char *data,
+                        size_t bitcount)
 {
-    unsigned int l;
+    const unsigned char *p = (const unsigned char *)data;
+    size_t bytes = bitcount / CHAR_BIT;
+    unsigned int rest = (unsigned int)(bitcount % CHAR_BIT);
 
-    for(l = 0; l < len; l++) {
-        ais_addbits(bits, start+6*l, 6, (uint64_t)data[l]);
+    if (AIS_PAYLOAD_MAX - w->len < bitcount) {
+        // do not trust bitcount to fit data
+        w->overflow = true;
+        return;
+    }
+    for (; 4 <= bytes; bytes -= 4, p += 4) {
+        ais_putbits(w, 32, getbeu32(p, 0));
+    }
+    for (; 0 < bytes; bytes--, p++) {
+        ais_putbits(w, 8, *p);
+    }
+    if (0 < rest) {
+        ais_putbits(w, rest, *p >> (CHAR_BIT - rest));
     }
-    return;
 }
 
-
-static void ais_binary_to_ascii(unsigned char *bits, unsigned int len)
+// an empty payload
+static unsigned int ais_nothing(unsigned char *bits)
 {
-    unsigned int l;
+    bits[0] = '\0';
+    return 0;
+}
 
-    if (0 == len) {
-        bits[0] = '\0';
-        return;
+/* armor any last partial symbol, zero filled, and terminate
+ *
+ * Return: payload length in bits, 0 if it was too long to encode
+ */
+static unsigned int ais_finish(struct sixbit_writer_t *w,
+                               unsigned char *bits)
+{
+    if (w->overflow) {
+        return ais_nothing(bits);
     }
-
-    for (l = 0; l < len;l += 6) {
-        bits[l/6] = convtab[bits[l/6] & 0x3f];
+    if (0 < w->nacc) {
+        *w->out++ = convtab[(w->acc << (6 - w->nacc)) & 0x3f];
+        w->nacc = 0;
     }
-    return;
+    *w->out = '\0';
+    return w->len;
 }
 
-
+/* encode ais into bits as an armored, NUL terminated, AIVDM payload.
+ * flag selects part B of a type 24.  bits must hold at least 170 bytes
+ * (1008 payload bits).
+ *
+ * Types 6 and 8 are encoded only when they carry raw data; payloads the
+ * decoder broke out into DAC/FID specific fields are not re-encoded.
+ *
+ * Return: payload length in bits, 0 when there is nothing to encode,
+ *         or more than AIS_PAYLOAD_MAX bits
+ */
 unsigned int ais_binary_encode(struct ais_t *ais,
                                unsigned char *bits,
                                int flag)
 {
-    unsigned int len;
+    struct sixbit_writer_t w;
     size_t slen;
+    unsigned int u;
 
-    len = 0;
+    w.out = bits;
+    w.acc = 0;
+    w.nacc = 0;
+    w.len = 0;
+    w.overflow = false;
 
     if (0 != flag) {
         flag = AIS_MSG_PART2_FLAG;
     }
-    ais_addbits(bits,  0,  6, (uint64_t)ais->type);
-    ais_addbits(bits,  6,  2, (uint64_t)ais->repeat);
-    ais_addbits(bits,  8, 30, (uint64_t)ais->mmsi);
+    ais_putbits(&w,  6, (uint64_t)ais->type);
+    ais_putbits(&w,  2, (uint64_t)ais->repeat);
+    ais_putbits(&w, 30, (uint64_t)ais->mmsi);
     switch (flag | ais->type) {
     case 1:     // Position Report
         FALLTHROUGH
     case 2:
         FALLTHROUGH
     case 3:
-        ais_addbits(bits,  38,  4, (uint64_t)ais->type1.status);
-        ais_addbits(bits,  42,  8, (uint64_t)ais->type1.turn);
-        ais_addbits(bits,  50, 10, (uint64_t)ais->type1.speed);
-        ais_addbits(bits,  60,  1, (uint64_t)ais->type1.accuracy);
-        ais_addbits(bits,  61, 28, (uint64_t)ais->type1.lon);
-        ais_addbits(bits,  89, 27, (uint64_t)ais->type1.lat);
-        ais_addbits(bits, 116, 12, (uint64_t)ais->type1.course);
-        ais_addbits(bits, 128,  9, (uint64_t)ais->type1.heading);
-        ais_addbits(bits, 137,  6, (uint64_t)ais->type1.second);
-        ais_addbits(bits, 143,  2, (uint64_t)ais->type1.maneuver);
-        // ais_addbits(bits, 145,  3, (uint64_t)ais->type1.spare);
-        ais_addbits(bits, 148,  1, (uint64_t)ais->type1.raim);
-        ais_addbits(bits, 149, 19, (uint64_t)ais->type1.radio);
-        len = 149 + 19;
+        ais_putbits(&w,  4, (uint64_t)ais->type1.status);
+        ais_putbits(&w,  8, (uint64_t)ais->type1.turn);
+        ais_putbits(&w, 10, (uint64_t)ais->type1.speed);
+        ais_putbits(&w,  1, (uint64_t)ais->type1.accuracy);
+        ais_putbits(&w, 28, (uint64_t)ais->type1.lon);
+        ais_putbits(&w, 27, (uint64_t)ais->type1.lat);
+        ais_putbits(&w, 12, (uint64_t)ais->type1.course);
+        ais_putbits(&w,  9, (uint64_t)ais->type1.heading);
+        ais_putbits(&w,  6, (uint64_t)ais->type1.second);
+        ais_putbits(&w,  2, (uint64_t)ais->type1.maneuver);
+        ais_skipto(&w, 148);    // spare
+        ais_putbits(&w,  1, (uint64_t)ais->type1.raim);
+        ais_putbits(&w, 19, (uint64_t)ais->type1.radio);
         break;
     case 4:     // Base Station Report
         FALLTHROUGH
     case 11:    // UTC/Date Response
-        ais_addbits(bits,  38, 14, (uint64_t)ais->type4.year);
-        ais_addbits(bits,  52,  4, (uint64_t)ais->type4.month);
-        ais_addbits(bits,  56,  5, (uint64_t)ais->type4.day);
-        ais_addbits(bits,  61,  5, (uint64_t)ais->type4.hour);
-        ais_addbits(bits,  66,  6, (uint64_t)ais->type4.minute);
-        ais_addbits(bits,  72,  6, (uint64_t)ais->type4.second);
-        ais_addbits(bits,  78,  1, (uint64_t)ais->type4.accuracy);
-        ais_addbits(bits,  79, 28, (uint64_t)ais->type4.lon);
-        ais_addbits(bits, 107, 27, (uint64_t)ais->type4.lat);
-        ais_addbits(bits, 134,  4, (uint64_t)ais->type4.epfd);
-        // ais_addbits(bits, 138, 10, (uint64_t)ais->type4.spare);
-        ais_addbits(bits, 148,  1, (uint64_t)ais->type4.raim);
-        ais_addbits(bits, 149, 19, (uint64_t)ais->type4.radio);
-        len = 149 + 19;
+        ais_putbits(&w, 14, (uint64_t)ais->type4.year);
+        ais_putbits(&w,  4, (uint64_t)ais->type4.month);
+        ais_putbits(&w,  5, (uint64_t)ais->type4.day);
+        ais_putbits(&w,  5, (uint64_t)ais->type4.hour);
+        ais_putbits(&w,  6, (uint64_t)ais->type4.minute);
+        ais_putbits(&w,  6, (uint64_t)ais->type4.second);
+        ais_putbits(&w,  1, (uint64_t)ais->type4.accuracy);
+        ais_putbits(&w, 28, (uint64_t)ais->type4.lon);
+        ais_putbits(&w, 27, (uint64_t)ais->type4.lat);
+        ais_putbits(&w,  4, (uint64_t)ais->type4.epfd);
+        ais_skipto(&w, 148);    // spare
+        ais_putbits(&w,  1, (uint64_t)ais->type4.raim);
+        ais_putbits(&w, 19, (uint64_t)ais->type4.radio);
         break;
     case 5:     // Ship static and voyage related data
-        ais_addbits(bits,  38,  2, (uint64_t)ais->type5.ais_version);
-        ais_addbits(bits,  40, 30, (uint64_t)ais->type5.imo);
-        ais_addchar(bits,  70,  7,           ais->type5.callsign);
-        ais_addchar(bits, 112, 20,           ais->type5.shipname);
-        ais_addbits(bits, 232,  8, (uint64_t)ais->type5.shiptype);
-        ais_addbits(bits, 240,  9, (uint64_t)ais->type5.to_bow);
-        ais_addbits(bits, 249,  9, (uint64_t)ais->type5.to_stern);
-        ais_addbits(bits, 258,  6, (uint64_t)ais->type5.to_port);
-        ais_addbits(bits, 264,  6, (uint64_t)ais->type5.to_starboard);
-        ais_addbits(bits, 270,  4, (uint64_t)ais->type5.epfd);
-        ais_addbits(bits, 274,  4, (uint64_t)ais->type5.month);
-        ais_addbits(bits, 278,  5, (uint64_t)ais->type5.day);
-        ais_addbits(bits, 283,  5, (uint64_t)ais->type5.hour);
-        ais_addbits(bits, 288,  6, (uint64_t)ais->type5.minute);
-        ais_addbits(bits, 294,  8, (uint64_t)ais->type5.draught);
-        ais_addchar(bits, 302, 20,           ais->type5.destination);
-        ais_addbits(bits, 422,  1, (uint64_t)ais->type5.dte);
-        // ais_addbits(bits, 423,  1, (uint64_t)ais->type5.spare);
-        len = 423 + 1;
+        ais_putbits(&w,  2, (uint64_t)ais->type5.ais_version);
+        ais_putbits(&w, 30, (uint64_t)ais->type5.imo);
+        ais_putchars(&w, 7, ais->type5.callsign);
+        ais_putchars(&w, 20, ais->type5.shipname);
+        ais_putbits(&w,  8, (uint64_t)ais->type5.shiptype);
+        ais_putbits(&w,  9, (uint64_t)ais->type5.to_bow);
+        ais_putbits(&w,  9, (uint64_t)ais->type5.to_stern);
+        ais_putbits(&w,  6, (uint64_t)ais->type5.to_port);
+        ais_putbits(&w,  6, (uint64_t)ais->type5.to_starboard);
+        ais_putbits(&w,  4, (uint64_t)ais->type5.epfd);
+        ais_putbits(&w,  4, (uint64_t)ais->type5.month);
+        ais_putbits(&w,  5, (uint64_t)ais->type5.day);
+        ais_putbits(&w,  5, (uint64_t)ais->type5.hour);
+        ais_putbits(&w,  6, (uint64_t)ais->type5.minute);
+        ais_putbits(&w,  8, (uint64_t)ais->type5.draught);
+        ais_putchars(&w, 20, ais->type5.destination);
+        ais_putbits(&w,  1, (uint64_t)ais->type5.dte);
+        ais_skipto(&w, 424);    // spare
+        break;
+    case 6:     // Addressed Binary Message
+        if (ais->type6.structured) {
+            return ais_nothing(bits);
+        }
+        ais_putbits(&w,  2, (uint64_t)ais->type6.seqno);
+        ais_putbits(&w, 30, (uint64_t)ais->type6.dest_mmsi);
+        ais_putbits(&w,  1, (uint64_t)ais->type6.retransmit);
+        ais_skipto(&w, 72);     // spare
+        ais_putbits(&w, 10, (uint64_t)ais->type6.dac);
+        ais_putbits(&w,  6, (uint64_t)ais->type6.fid);
+        ais_putdata(&w, ais->type6.bitdata, ais->type6.bitcount);
+        break;
+    case 7:     // Binary Acknowledge
+        FALLTHROUGH
+    case 13:    // Safety Related Acknowledge
+    {
+        unsigned int mmsi[4];
+        unsigned int seqno[4];
+        unsigned int n;
+
+        mmsi[0] = ais->type7.mmsi1;
+        seqno[0] = ais->type7.seqno1;
+        mmsi[1] = ais->type7.mmsi2;
+        seqno[1] = ais->type7.seqno2;
+        mmsi[2] = ais->type7.mmsi3;
+        seqno[2] = ais->type7.seqno3;
+        mmsi[3] = ais->type7.mmsi4;
+        seqno[3] = ais->type7.seqno4;
+        // up to the last acknowledged station, at least one
+        for (n = 4; 1 < n && 0 == mmsi[n - 1] && 0 == seqno[n - 1]; n--) {
+            continue;
+        }
+        ais_skipto(&w, 40);     // spare
+        for (u = 0; u < n; u++) {
+            ais_putbits(&w, 30, (uint64_t)mmsi[u]);
+            ais_putbits(&w,  2, (uint64_t)seqno[u]);
+        }
+        break;
+    }
+    case 8:     // Binary Broadcast Message
+        if (ais->type8.structured) {
+            return ais_nothing(bits);
+        }
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 10, (uint64_t)ais->type8.dac);
+        ais_putbits(&w,  6, (uint64_t)ais->type8.fid);
+        ais_putdata(&w, ais->type8.bitdata, ais->type8.bitcount);
         break;
     case 9:     // Standard SAR Aircraft Position Report
-        ais_addbits(bits,  38, 12, (uint64_t)ais->type9.alt);
-        ais_addbits(bits,  50, 10, (uint64_t)ais->type9.speed);
-        ais_addbits(bits,  60,  1, (uint64_t)ais->type9.accuracy);
-        ais_addbits(bits,  61, 28, (uint64_t)ais->type9.lon);
-        ais_addbits(bits,  89, 27, (uint64_t)ais->type9.lat);
-        ais_addbits(bits, 116, 12, (uint64_t)ais->type9.course);
-        ais_addbits(bits, 128,  6, (uint64_t)ais->type9.second);
-        ais_addbits(bits, 134,  8, (uint64_t)ais->type9.regional);
-        ais_addbits(bits, 142,  1, (uint64_t)ais->type9.dte);
-        // ais_addbits(bits, 143,  3, (uint64_t)ais->type9.spare);
-        ais_addbits(bits, 146,  1, (uint64_t)ais->type9.assigned);
-        ais_addbits(bits, 147,  1, (uint64_t)ais->type9.raim);
-        ais_addbits(bits, 148, 19, (uint64_t)ais->type9.radio);
-        len = 148 + 19;
+        ais_putbits(&w, 12, (uint64_t)ais->type9.alt);
+        ais_putbits(&w, 10, (uint64_t)ais->type9.speed);
+        ais_putbits(&w,  1, (uint64_t)ais->type9.accuracy);
+        ais_putbits(&w, 28, (uint64_t)ais->type9.lon);
+        ais_putbits(&w, 27, (uint64_t)ais->type9.lat);
+        ais_putbits(&w, 12, (uint64_t)ais->type9.course);
+        ais_putbits(&w,  6, (uint64_t)ais->type9.second);
+        ais_putbits(&w,  8, (uint64_t)ais->type9.regional);
+        ais_putbits(&w,  1, (uint64_t)ais->type9.dte);
+        ais_skipto(&w, 146);    // spare
+        ais_putbits(&w,  1, (uint64_t)ais->type9.assigned);
+        ais_putbits(&w,  1, (uint64_t)ais->type9.raim);
+        ais_putbits(&w, 20, (uint64_t)ais->type9.radio);
+        break;
+    case 10:    // UTC/Date Inquiry
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 30, (uint64_t)ais->type10.dest_mmsi);
+        ais_skipto(&w, 72);     // spare
+        break;
+    case 12:    // Safety Related Message
+        ais_putbits(&w,  2, (uint64_t)ais->type12.seqno);
+        ais_putbits(&w, 30, (uint64_t)ais->type12.dest_mmsi);
+        ais_putbits(&w,  1, (uint64_t)ais->type12.retransmit);
+        ais_skipto(&w, 72);     // spare
+        slen = strnlen(ais->type12.text, sizeof(ais->type12.text) - 1);
+        ais_putchars(&w, (unsigned int)slen, ais->type12.text);
+        break;
+    case 14:    // Safety Related Broadcast Message
+        ais_skipto(&w, 40);     // spare
+        slen = strnlen(ais->type14.text, sizeof(ais->type14.text) - 1);
+        ais_putchars(&w, (unsigned int)slen, ais->type14.text);
+        break;
+    case 15:    // Interrogation
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 30, (uint64_t)ais->type15.mmsi1);
+        ais_putbits(&w,  6, (uint64_t)ais->type15.type1_1);
+        ais_putbits(&w, 12, (uint64_t)ais->type15.offset1_1);
+        if (0 != ais->type15.type1_2 ||
+            0 != ais->type15.offset1_2 ||
+            0 != ais->type15.mmsi2) {
+            ais_skipto(&w, 90);     // spare
+            ais_putbits(&w,  6, (uint64_t)ais->type15.type1_2);
+            ais_putbits(&w, 12, (uint64_t)ais->type15.offset1_2);
+            ais_skipto(&w, 110);    // spare
+        }
+        if (0 != ais->type15.mmsi2) {
+            ais_putbits(&w, 30, (uint64_t)ais->type15.mmsi2);
+            ais_putbits(&w,  6, (uint64_t)ais->type15.type2_1);
+            ais_putbits(&w, 12, (uint64_t)ais->type15.offset2_1);
+            ais_skipto(&w, 160);    // spare
+        }
+        break;
+    case 16:    // Assigned Mode Command
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 30, (uint64_t)ais->type16.mmsi1);
+        ais_putbits(&w, 12, (uint64_t)ais->type16.offset1);
+        ais_putbits(&w, 10, (uint64_t)ais->type16.increment1);
+        if (0 == ais->type16.mmsi2 &&
+            0 == ais->type16.offset2 &&
+            0 == ais->type16.increment2) {
+            ais_skipto(&w, 96);     // spare
+        } else {
+            ais_putbits(&w, 30, (uint64_t)ais->type16.mmsi2);
+            ais_putbits(&w, 12, (uint64_t)ais->type16.offset2);
+            ais_putbits(&w, 10, (uint64_t)ais->type16.increment2);
+        }
+        break;
+    case 17:    // GNSS Broadcast Binary Message
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 18, (uint64_t)ais->type17.lon);
+        ais_putbits(&w, 17, (uint64_t)ais->type17.lat);
+        ais_skipto(&w, 80);     // spare
+        ais_putdata(&w, ais->type17.bitdata, ais->type17.bitcount);
         break;
     case 18:    // Standard Class B CS Position Report
-        ais_addbits(bits,  38,  8, (uint64_t)ais->type18.reserved);
-        ais_addbits(bits,  46, 10, (uint64_t)ais->type18.speed);
-        ais_addbits(bits,  56,  1, (uint64_t)ais->type18.accuracy);
-        ais_addbits(bits,  57, 28, (uint64_t)ais->type18.lon);
-        ais_addbits(bits,  85, 27, (uint64_t)ais->type18.lat);
-        ais_addbits(bits, 112, 12, (uint64_t)ais->type18.course);
-        ais_addbits(bits, 124,  9, (uint64_t)ais->type18.heading);
-        ais_addbits(bits, 133,  6, (uint64_t)ais->type18.second);
-        ais_addbits(bits, 139,  2, (uint64_t)ais->type18.regional);
-        ais_addbits(bits, 141,  1, (uint64_t)ais->type18.cs);
-        ais_addbits(bits, 142,  1, (uint64_t)ais->type18.display);
-        ais_addbits(bits, 143,  1, (uint64_t)ais->type18.dsc);
-        ais_addbits(bits, 144,  1, (uint64_t)ais->type18.band);
-        ais_addbits(bits, 145,  1, (uint64_t)ais->type18.msg22);
-        ais_addbits(bits, 146,  1, (uint64_t)ais->type18.assigned);
-        ais_addbits(bits, 147,  1, (uint64_t)ais->type18.raim);
-        ais_addbits(bits, 148, 20, (uint64_t)ais->type18.radio);
-        len = 148 + 20;
+        ais_putbits(&w,  8, (uint64_t)ais->type18.reserved);
+        ais_putbits(&w, 10, (uint64_t)ais->type18.speed);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.accuracy);
+        ais_putbits(&w, 28, (uint64_t)ais->type18.lon);
+        ais_putbits(&w, 27, (uint64_t)ais->type18.lat);
+        ais_putbits(&w, 12, (uint64_t)ais->type18.course);
+        ais_putbits(&w,  9, (uint64_t)ais->type18.heading);
+        ais_putbits(&w,  6, (uint64_t)ais->type18.second);
+        ais_putbits(&w,  2, (uint64_t)ais->type18.regional);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.cs);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.display);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.dsc);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.band);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.msg22);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.assigned);
+        ais_putbits(&w,  1, (uint64_t)ais->type18.raim);
+        ais_putbits(&w, 20, (uint64_t)ais->type18.radio);
         break;
     case 19:    // Extended Class B CS Position Report
-        ais_addbits(bits,  38,  8, (uint64_t)ais->type19.reserved);
-        ais_addbits(bits,  46, 10, (uint64_t)ais->type19.speed);
-        ais_addbits(bits,  56,  1, (uint64_t)ais->type19.accuracy);
-        ais_addbits(bits,  57, 28, (uint64_t)ais->type19.lon);
-        ais_addbits(bits,  85, 27, (uint64_t)ais->type19.lat);
-        ais_addbits(bits, 112, 12, (uint64_t)ais->type19.course);
-        ais_addbits(bits, 124,  9, (uint64_t)ais->type19.heading);
-        ais_addbits(bits, 133,  6, (uint64_t)ais->type19.second);
-        ais_addbits(bits, 139,  4, (uint64_t)ais->type19.regional);
-        ais_addchar(bits, 143, 20,           ais->type19.shipname);
-        ais_addbits(bits, 263,  8, (uint64_t)ais->type19.shiptype);
-        ais_addbits(bits, 271,  9, (uint64_t)ais->type19.to_bow);
-        ais_addbits(bits, 280,  9, (uint64_t)ais->type19.to_stern);
-        ais_addbits(bits, 289,  6, (uint64_t)ais->type19.to_port);
-        ais_addbits(bits, 295,  6, (uint64_t)ais->type19.to_starboard);
-        ais_addbits(bits, 299,  4, (uint64_t)ais->type19.epfd);
-        ais_addbits(bits, 302,  1, (uint64_t)ais->type19.raim);
-        ais_addbits(bits, 305,  1, (uint64_t)ais->type19.dte);
-        ais_addbits(bits, 306,  1, (uint64_t)ais->type19.assigned);
-        // ais_addbits(bits, 307,  5, (uint64_t)ais->type19.spare);
-        len = 307 + 5;
+        ais_putbits(&w,  8, (uint64_t)ais->type19.reserved);
+        ais_putbits(&w, 10, (uint64_t)ais->type19.speed);
+        ais_putbits(&w,  1, (uint64_t)ais->type19.accuracy);
+        ais_putbits(&w, 28, (uint64_t)ais->type19.lon);
+        ais_putbits(&w, 27, (uint64_t)ais->type19.lat);
+        ais_putbits(&w, 12, (uint64_t)ais->type19.course);
+        ais_putbits(&w,  9, (uint64_t)ais->type19.heading);
+        ais_putbits(&w,  6, (uint64_t)ais->type19.second);
+        ais_putbits(&w,  4, (uint64_t)ais->type19.regional);
+        ais_putchars(&w, 20, ais->type19.shipname);
+        ais_putbits(&w,  8, (uint64_t)ais->type19.shiptype);
+        ais_putbits(&w,  9, (uint64_t)ais->type19.to_bow);
+        ais_putbits(&w,  9, (uint64_t)ais->type19.to_stern);
+        ais_putbits(&w,  6, (uint64_t)ais->type19.to_port);
+        ais_putbits(&w,  6, (uint64_t)ais->type19.to_starboard);
+        ais_putbits(&w,  4, (uint64_t)ais->type19.epfd);
+        ais_putbits(&w,  1, (uint64_t)ais->type19.raim);
+        ais_putbits(&w,  1, (uint64_t)ais->type19.dte);
+        ais_putbits(&w,  1, (uint64_t)ais->type19.assigned);
+        ais_skipto(&w, 312);    // spare
+        break;
+    case 20:    // Data Link Management Message
+    {
+        unsigned int n;
+
+        // up to the last reservation in use, at least one
+        if (0 != ais->type20.offset4 || 0 != ais->type20.number4 ||
+            0 != ais->type20.timeout4 || 0 != ais->type20.increment4) {
+            n = 4;
+        } else if (0 != ais->type20.offset3 || 0 != ais->type20.number3 ||
+                   0 != ais->type20.timeout3 ||
+                   0 != ais->type20.increment3) {
+            n = 3;
+        } else if (0 != ais->type20.offset2 || 0 != ais->type20.number2 ||
+                   0 != ais->type20.timeout2 ||
+                   0 != ais->type20.increment2) {
+            n = 2;
+        } else {
+            n = 1;
+        }
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 12, (uint64_t)ais->type20.offset1);
+        ais_putbits(&w,  4, (uint64_t)ais->type20.number1);
+        ais_putbits(&w,  3, (uint64_t)ais->type20.timeout1);
+        ais_putbits(&w, 11, (uint64_t)ais->type20.increment1);
+        if (2 <= n) {
+            ais_putbits(&w, 12, (uint64_t)ais->type20.offset2);
+            ais_putbits(&w,  4, (uint64_t)ais->type20.number2);
+            ais_putbits(&w,  3, (uint64_t)ais->type20.timeout2);
+            ais_putbits(&w, 11, (uint64_t)ais->type20.increment2);
+        }
+        if (3 <= n) {
+            ais_putbits(&w, 12, (uint64_t)ais->type20.offset3);
+            ais_putbits(&w,  4, (uint64_t)ais->type20.number3);
+            ais_putbits(&w,  3, (uint64_t)ais->type20.timeout3);
+            ais_putbits(&w, 11, (uint64_t)ais->type20.increment3);
+        }
+        if (4 <= n) {
+            ais_putbits(&w, 12, (uint64_t)ais->type20.offset4);
+            ais_putbits(&w,  4, (uint64_t)ais->type20.number4);
+            ais_putbits(&w,  3, (uint64_t)ais->type20.timeout4);
+            ais_putbits(&w, 11, (uint64_t)ais->type20.increment4);
+        }
+        // pad to a whole byte
+        ais_skipto(&w, (w.len + 7) & ~7U);
         break;
+    }
     case 21:    // Aid-to-Navigation Report
-        ais_addbits(bits,  38,  5, (uint64_t)ais->type21.aid_type);
-        ais_addchar(bits,  43, 20,           ais->type21.name);
-        ais_addbits(bits, 163,  1, (uint64_t)ais->type21.accuracy);
-        ais_addbits(bits, 164, 28, (uint64_t)ais->type21.lon);
-        ais_addbits(bits, 192, 27, (uint64_t)ais->type21.lat);
-        ais_addbits(bits, 219,  9, (uint64_t)ais->type21.to_bow);
-        ais_addbits(bits, 228,  9, (uint64_t)ais->type21.to_stern);
-        ais_addbits(bits, 237,  6, (uint64_t)ais->type21.to_port);
-        ais_addbits(bits, 243,  6, (uint64_t)ais->type21.to_starboard);
-        ais_addbits(bits, 249,  4, (uint64_t)ais->type21.epfd);
-        ais_addbits(bits, 253,  6, (uint64_t)ais->type21.second);
-        ais_addbits(bits, 259,  1, (uint64_t)ais->type21.off_position);
-        ais_addbits(bits, 260,  8, (uint64_t)ais->type21.regional);
-        ais_addbits(bits, 268,  1, (uint64_t)ais->type21.raim);
-        ais_addbits(bits, 269,  1, (uint64_t)ais->type21.virtual_aid);
-        ais_addbits(bits, 270,  1, (uint64_t)ais->type21.assigned);
-        // ais_addbits(bits, 271,  1, (uint64_t)ais->type21.spare);
-        len = 271 + 1;
+        ais_putbits(&w,  5, (uint64_t)ais->type21.aid_type);
+        ais_putchars(&w, 20, ais->type21.name);
+        ais_putbits(&w,  1, (uint64_t)ais->type21.accuracy);
+        ais_putbits(&w, 28, (uint64_t)ais->type21.lon);
+        ais_putbits(&w, 27, (uint64_t)ais->type21.lat);
+        ais_putbits(&w,  9, (uint64_t)ais->type21.to_bow);
+        ais_putbits(&w,  9, (uint64_t)ais->type21.to_stern);
+        ais_putbits(&w,  6, (uint64_t)ais->type21.to_port);
+        ais_putbits(&w,  6, (uint64_t)ais->type21.to_starboard);
+        ais_putbits(&w,  4, (uint64_t)ais->type21.epfd);
+        ais_putbits(&w,  6, (uint64_t)ais->type21.second);
+        ais_putbits(&w,  1, (uint64_t)ais->type21.off_position);
+        ais_putbits(&w,  8, (uint64_t)ais->type21.regional);
+        ais_putbits(&w,  1, (uint64_t)ais->type21.raim);
+        ais_putbits(&w,  1, (uint64_t)ais->type21.virtual_aid);
+        ais_putbits(&w,  1, (uint64_t)ais->type21.assigned);
+        ais_skipto(&w, 272);    // spare
         slen = strnlen(ais->type21.name, sizeof(ais->type21.name));
         if (20 < slen) {
-            unsigned int extralen;
-
-            extralen = (unsigned int)(slen - 20);
-            ais_addchar(bits, 272, extralen, ais->type21.name + 20);
-            len += extralen * 6;
+            // name extension
+            ais_putchars(&w, (unsigned int)(slen - 20),
+                         ais->type21.name + 20);
         }
         break;
-    case 24:    // Class B CS Static Data Report Part 1
-        if (ais->type24.part == part_a) {
-            ais_addbits(bits,  38,  2, (uint64_t)0);
-            ais_addchar(bits,  40, 20,           ais->type24.shipname);
-            // ais_addbits(bits, 160,  8, (uint64_t)ais->type24.a.spare);
-            len = 160;
+    case 22:    // Channel Management
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 12, (uint64_t)ais->type22.channel_a);
+        ais_putbits(&w, 12, (uint64_t)ais->type22.channel_b);
+        ais_putbits(&w,  4, (uint64_t)ais->type22.txrx);
+        ais_putbits(&w,  1, (uint64_t)ais->type22.power);
+        if (ais->type22.addressed) {
+            ais_putbits(&w, 30, (uint64_t)ais->type22.mmsi.dest1);
+            ais_skipto(&w, 104);    // spare
+            ais_putbits(&w, 30, (uint64_t)ais->type22.mmsi.dest2);
+            ais_skipto(&w, 139);    // spare
+        } else {
+            ais_putbits(&w, 18, (uint64_t)ais->type22.area.ne_lon);
+            ais_putbits(&w, 17, (uint64_t)ais->type22.area.ne_lat);
+            ais_putbits(&w, 18, (uint64_t)ais->type22.area.sw_lon);
+            ais_putbits(&w, 17, (uint64_t)ais->type22.area.sw_lat);
         }
+        ais_putbits(&w,  1, (uint64_t)ais->type22.addressed);
+        ais_putbits(&w,  1, (uint64_t)ais->type22.band_a);
+        ais_putbits(&w,  1, (uint64_t)ais->type22.band_b);
+        ais_putbits(&w,  3, (uint64_t)ais->type22.zonesize);
+        ais_skipto(&w, 168);    // spare
+        break;
+    case 23:    // Group Assignment Command
+        ais_skipto(&w, 40);     // spare
+        ais_putbits(&w, 18, (uint64_t)ais->type23.ne_lon);
+        ais_putbits(&w, 17, (uint64_t)ais->type23.ne_lat);
+        ais_putbits(&w, 18, (uint64_t)ais->type23.sw_lon);
+        ais_putbits(&w, 17, (uint64_t)ais->type23.sw_lat);
+        ais_putbits(&w,  4, (uint64_t)ais->type23.stationtype);
+        ais_putbits(&w,  8, (uint64_t)ais->type23.shiptype);
+        ais_skipto(&w, 144);    // spare
+        /* The decoder reads txrx as four bits, overlapping the top
+         * half of interval; write the two bits that are its own. */
+        ais_putbits(&w,  2, (uint64_t)(ais->type23.txrx >> 2));
+        ais_putbits(&w,  4, (uint64_t)ais->type23.interval);
+        ais_putbits(&w,  4, (uint64_t)ais->type23.quiet);
+        ais_skipto(&w, 160);    // spare
         break;
-    case 24 | AIS_MSG_PART2_FLAG:  // Class B CS Static Data Report Part 2
-        if ((ais->type24.part == part_b) || (ais->type24.part == both)) {
-            ais_addbits(bits,  38,  2, (uint64_t)1);
-            ais_addbits(bits,  40,  8, (uint64_t)ais->type24.shiptype);
-            ais_addchar(bits,  48,  3,          &ais->type24.vendorid[0]);
-            ais_adddata(bits,  66,  3,          &ais->type24.vendorid[3]);
-            ais_addchar(bits,  90,  7,          ais->type24.callsign);
-            if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
-                ais_addbits(bits, 132, 30,
-                            (uint64_t)ais->type24.mothership_mmsi);
-            } else {
-                ais_addbits(bits, 132,  9, (uint64_t)ais->type24.dim.to_bow);
-                ais_addbits(bits, 141,  9, (uint64_t)ais->type24.dim.to_stern);
-                ais_addbits(bits, 150,  6, (uint64_t)ais->type24.dim.to_port);
-                ais_addbits(bits, 156,  6,
-                            (uint64_t)ais->type24.dim.to_starboard);
-            }
-            // ais_addbits(bits, 162,  6, ais->type24.b.spare);
-            len = 162 + 6;
+    case 24:    // Class B CS Static Data Report Part A
+        if (part_b == ais->type24.part) {
+            return ais_nothing(bits);
+        }
+        ais_putbits(&w,  2, (uint64_t)0);
+        ais_putchars(&w, 20, ais->type24.shipname);
+        ais_skipto(&w, 160);    // spare
+        break;
+    case 24 | AIS_MSG_PART2_FLAG:  // Class B CS Static Data Report Part B
+        if (part_a == ais->type24.part) {
+            return ais_nothing(bits);
+        }
+        ais_putbits(&w,  2, (uint64_t)1);
+        ais_putbits(&w,  8, (uint64_t)ais->type24.shiptype);
+        /* Revision 4 vendorid is 3 characters, then model and serial;
+         * older units use all 7 characters, which the decoder reports
+         * both ways, so the two agree.  JSON from before model and
+         * serial existed has only the 7 characters. */
+        if (0 == ais->type24.model &&
+            0 == ais->type24.serial) {
+            ais_putchars(&w, 7, ais->type24.vendorid);
+        } else {
+            ais_putchars(&w, 3, ais->type24.vendorid);
+            ais_putbits(&w,  4, (uint64_t)ais->type24.model);
+            ais_putbits(&w, 20, (uint64_t)ais->type24.serial);
+        }
+        ais_putchars(&w, 7, ais->type24.callsign);
+        if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
+            ais_putbits(&w, 30, (uint64_t)ais->type24.mothership_mmsi);
+        } else {
+            ais_putbits(&w,  9, (uint64_t)ais->type24.dim.to_bow);
+            ais_putbits(&w,  9, (uint64_t)ais->type24.dim.to_stern);
+            ais_putbits(&w,  6, (uint64_t)ais->type24.dim.to_port);
+            ais_putbits(&w,  6, (uint64_t)ais->type24.dim.to_starboard);
+        }
+        ais_skipto(&w, 168);    // spare
+        break;
+    case 25:    // Binary Message, Single Slot
+        ais_putbits(&w,  1, (uint64_t)ais->type25.addressed);
+        ais_putbits(&w,  1, (uint64_t)ais->type25.structured);
+        if (ais->type25.addressed) {
+            ais_putbits(&w, 30, (uint64_t)ais->type25.dest_mmsi);
+        }
+        if (ais->type25.structured) {
+            ais_putbits(&w, 16, (uint64_t)ais->type25.app_id);
+        }
+        ais_putdata(&w, ais->type25.bitdata, ais->type25.bitcount);
+        break;
+    case 26:    // Binary Message, Multiple Slot
+        ais_putbits(&w,  1, (uint64_t)ais->type26.addressed);
+        ais_putbits(&w,  1, (uint64_t)ais->type26.structured);
+        if (ais->type26.addressed) {
+            ais_putbits(&w, 30, (uint64_t)ais->type26.dest_mmsi);
+        }
+        if (ais->type26.structured) {
+            ais_putbits(&w, 16, (uint64_t)ais->type26.app_id);
         }
+        ais_putdata(&w, ais->type26.bitdata, ais->type26.bitcount);
+        // radio status, in the last 20 bits whatever the length
+        ais_putbits(&w, 20, (uint64_t)ais->type26.radio);
         break;
     case 27:    // Long Range AIS Broadcast message
-        ais_addbits(bits,  38,  1, (uint64_t)ais->type27.accuracy);
-        ais_addbits(bits,  39,  1, (uint64_t)ais->type27.raim);
-        ais_addbits(bits,  40,  4, (uint64_t)ais->type27.status);
-        ais_addbits(bits,  44, 18, (uint64_t)ais->type27.lon);
-        ais_addbits(bits,  62, 17, (uint64_t)ais->type27.lat);
-        ais_addbits(bits,  79,  6, (uint64_t)ais->type27.speed);
-        ais_addbits(bits,  85,  9, (uint64_t)ais->type27.course);
-        ais_addbits(bits,  94,  1, (uint64_t)ais->type27.gnss);
+        ais_putbits(&w,  1, (uint64_t)ais->type27.accuracy);
+        ais_putbits(&w,  1, (uint64_t)ais->type27.raim);
+        ais_putbits(&w,  4, (uint64_t)ais->type27.status);
+        ais_putbits(&w, 18, (uint64_t)ais->type27.lon);
+        ais_putbits(&w, 17, (uint64_t)ais->type27.lat);
+        ais_putbits(&w,  6, (uint64_t)ais->type27.speed);
+        ais_putbits(&w,  9, (uint64_t)ais->type27.course);
+        ais_putbits(&w,  1, (uint64_t)ais->type27.gnss);
+        ais_skipto(&w, 96);     // spare
         break;
+    default:
+        // nothing we know how to encode
+        return ais_nothing(bits);
     }
-    ais_binary_to_ascii(bits, len);
-    return len;
+    return ais_finish(&w, bits);
 }
 #endif  // AIVDM_ENABLE
 // vim: set expandtab shiftwidth=4
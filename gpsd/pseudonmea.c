@@ -525,7 +525,6 @@ static void gpsd_binary_ais_dump(struct gps_device_t *session,
         channel = 'B';
     }
 
-    memset(data, 0, sizeof(data));
     datalen = ais_binary_encode(&session->gpsdata.ais, &data[0], 0);
     if ((6 * 60) < datalen) {
         static int number1 = 0;
@@ -594,7 +593,6 @@ static void gpsd_binary_ais_dump(struct gps_device_t *session,
         msg2 = 1;
         numc[0] = '\0';
 
-        memset(data, 0, sizeof(data));
         datalen = ais_binary_encode(&session->gpsdata.ais, &data[0], 1);
         if (0 < datalen) {
             left = GETLEFT(datalen);
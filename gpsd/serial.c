@@ -975,6 +975,10 @@ int gpsd_serial_open(struct gps_device_t *session)
     session->baudindex = 0;  // FIXME: fixed speed
     if (0 < session->context->fixed_port_speed) {
         new_speed = session->context->fixed_port_speed;
+    } else if (NULL != session->profile &&
+               0 < session->profile->speed) {
+        // hotplug said what receiver it is
+        new_speed = session->profile->speed;
     } else {
         new_speed = gpsd_get_speed_old(session);
     }
@@ -937,8 +937,8 @@ static bool do_command(const char *line)
             }
             announce_log("[probing %sabled]", context.readonly ? "dis" : "en");
             if (!context.readonly) {
-                // magic - forces a reconfigure
-                session.lexer.counter = 0;
+                // forces a reconfigure
+                gpsd_config_start(&session);
             }
         }
         break;
@@ -1496,7 +1496,7 @@ int main(int argc, char **argv)
         }
 
         switch(gpsd_multipoll(FD_ISSET(session.gpsdata.gps_fd, &rfds),
-                              &session, gpsmon_hook, 0)) {
+                              &session, gpsmon_hook, 0, 0)) {
         case DEVICE_READY:
             FD_SET(session.gpsdata.gps_fd, &all_fds);
             break;
@@ -1612,6 +1612,12 @@ int main(int argc, char **argv)
     if (NULL != explanation) {
         (void)fputs(explanation, stderr);
     }
+    if (0 < session.lexer.char_counter) {
+        char sbuf[BUFSIZ];
+
+        (void)fprintf(stderr, "lexer: %s\n",
+                      packet_stats_dump(&session.lexer, sbuf, sizeof(sbuf)));
+    }
     if (logfile) {
         (void)fclose(logfile);
     }
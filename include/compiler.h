@@ -139,5 +139,19 @@ static inline void memory_barrier(void)
     #define unlikely(x)     (x)
 #endif
 
+/* THREAD_LOCAL, storage class for small per-thread caches.
+ * libgps is used from threaded programs, so a plain static cache is
+ * not safe there.  Left undefined when the compiler can not do it,
+ * code must then do without the cache.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define THREAD_LOCAL __thread
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+    #define THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+      !defined(__STDC_NO_THREADS__)
+    #define THREAD_LOCAL _Thread_local
+#endif
+
 #endif  // _GPSD_COMPILER_H_
 // vim: set expandtab shiftwidth=4
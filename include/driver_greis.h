@@ -8,4 +8,48 @@
 
 unsigned char greis_checksum(const unsigned char *src, int count);
 
+// GREIS message IDs are two characters, greis_id_table[] covers '0' to '~'
+#define GREIS_ID_FIRST          '0'
+#define GREIS_ID_LAST           '~'
+#define GREIS_ID_SPAN           (GREIS_ID_LAST - GREIS_ID_FIRST + 1)
+
+// the messages driver_greis.c decodes, GREIS_MSG_NONE for the rest
+enum greis_msg {
+    GREIS_MSG_NONE,
+    GREIS_MSG_ET,       // ::
+    GREIS_MSG_AZ,
+    GREIS_MSG_DC,
+    GREIS_MSG_DP,
+    GREIS_MSG_EC,
+    GREIS_MSG_ER,
+    GREIS_MSG_EL,
+    GREIS_MSG_GT,
+    GREIS_MSG_R3,
+    GREIS_MSG_RC,
+    GREIS_MSG_P3,
+    GREIS_MSG_PC,
+    GREIS_MSG_PV,
+    GREIS_MSG_RE,
+    GREIS_MSG_SG,
+    GREIS_MSG_SI,
+    GREIS_MSG_SS,
+    GREIS_MSG_UO,
+    GREIS_MSG_RT,       // ~~
+    GREIS_MSGS          // keep last
+};
+
+extern const unsigned char greis_id_table[GREIS_ID_SPAN][GREIS_ID_SPAN];
+
+// the enum greis_msg for the two character ID at id
+static inline unsigned greis_msg_of(const unsigned char *id)
+{
+    if (GREIS_ID_FIRST > id[0] ||
+        GREIS_ID_LAST < id[0] ||
+        GREIS_ID_FIRST > id[1] ||
+        GREIS_ID_LAST < id[1]) {
+        return GREIS_MSG_NONE;
+    }
+    return greis_id_table[id[0] - GREIS_ID_FIRST][id[1] - GREIS_ID_FIRST];
+}
+
 #endif  // _DRIVER_GREIS_H_
@@ -110,6 +110,11 @@ extern "C" {
  *       Add ve_err_deviation, vn_err_deviationv, vu_err_deviation to gst_t
  *       Move gst_t out of gps_data_t union.
  *       Add ROWS(), IN() macrosa
+ *       Add privdata_t.seqpacket for local data socket connections
+ *       Add gps_ais_filter(), gps_ais_hook() and their privdata_t members
+ *       Add privdata_t delta_tpv, delta_sky and delta_scratch
+ *       Add WATCH_DEFLATE and privdata_t inflate
+ *       Add rawdata_t.nmeas
  */
 #define GPSD_API_MAJOR_VERSION  14      // bump on incompatible changes
 #define GPSD_API_MINOR_VERSION  0       // bump on compatible changes
@@ -1483,6 +1488,10 @@ struct route_info {
     } waypoints[16];
 };
 
+#define AIS_TYPE_MAX            27      // highest AIS message type
+// bit for AIS message type t in a gps_ais_filter() mask
+#define AIS_TYPE_BIT(t)         (1UL << (t))
+
 struct ais_t
 {
     unsigned int        type;           // message type
@@ -2692,6 +2701,10 @@ struct rawdata_t {
 #define SAT_EPHEMERIS   0x20    // ephemeris collected
 #define SAT_FIX_USED    0x40    // used for position fix
     } meas[MAXCHANNELS];
+    /* meas[] in use, from meas[0].  Those before it may still have
+     * svid 0, those past it may hold anything.  Last, so meas[] stays
+     * where it was. */
+    unsigned nmeas;
 };
 
 struct version_t {
@@ -2780,6 +2793,7 @@ typedef uint32_t watch_t;
 #define WATCH_DEVICE    (watch_t)0x000800u       // watch specific device
 #define WATCH_SPLIT24   (watch_t)0x001000u       // split AIS Type 24s
 #define WATCH_PPS       (watch_t)0x002000u       // enable PPS JSON
+#define WATCH_DEFLATE   (watch_t)0x004000u       // compressed stream
 #define WATCH_NEWSTYLE  (watch_t)0x010000u       // force JSON streaming
 
 
@@ -2795,6 +2809,7 @@ struct fixsource_t
 
 // data buffers for reading files or sockets
 struct gps_data_t;   // forward declaration of gpss_data_t;
+struct sock_inflate_t;  // private to libgps_sock.c
 
 struct privdata_t
 {
@@ -2802,11 +2817,23 @@ struct privdata_t
     ssize_t waiting;       // the number of bytes in the buffer
     char buffer[GPS_JSON_RESPONSE_MAX * 2];
     int waitcount;
+    // true if connected to a SOCK_SEQPACKET socket, one report per read
+    bool seqpacket;
     // DBus handler
     void (*handler)(struct gps_data_t *);
     // SHM handler
     void *shmseg;
     int tick;
+    // AIS types to unpack, AIS_TYPE_BIT()s, 0 for all of them
+    unsigned long ais_types;
+    // called after an AIS message of the type at its index is unpacked
+    void (*ais_hooks[AIS_TYPE_MAX + 1])(struct gps_data_t *);
+    // last full TPV and SKY, that delta encoded reports build on
+    char delta_tpv[GPS_JSON_RESPONSE_MAX];
+    char delta_sky[GPS_JSON_RESPONSE_MAX * 2];
+    char delta_scratch[GPS_JSON_RESPONSE_MAX * 2];
+    // compressed stream state, NULL while the stream is plain
+    struct sock_inflate_t *inflate;
 };
 
 #ifdef USE_QT
@@ -2980,6 +3007,9 @@ extern int gps_mainloop(struct gps_data_t *, int,
                         void (*)(struct gps_data_t *));
 extern const char *gps_data(const struct gps_data_t *);
 extern const char *gps_errstr(const int);
+extern int gps_ais_filter(struct gps_data_t *, unsigned long);
+extern int gps_ais_hook(struct gps_data_t *, unsigned int,
+                        void (*)(struct gps_data_t *));
 extern char *gps_visibilize(char *outbuf, size_t outlen,
                             const char *inbuf, size_t inlen);
 
@@ -3120,6 +3150,8 @@ extern short ubx2_to_prn(int gnssId, int svId);
 #define GPSD_DBUS_EXPORT        "DBUS export"
 #define GPSD_LOCAL_FILE         "local file"
 #define GPSD_SHARED_MEMORY      "shared memory"
+// host prefix for the local SOCK_SEQPACKET data socket, "unix:/path"
+#define GPSD_LOCAL_SOCKET       "unix:"
 
 #ifdef __cplusplus
 }  // End of the 'extern "C"' block
@@ -12,11 +12,26 @@ extern "C" {
 #endif
 
 struct gps_device_t;
+struct ais_filter_t;
+struct watch_rate_t;
+
+// one "key":value member of a JSON object, as spans of its text
+struct json_member_t {
+    const char *key;                    // without the quotes
+    size_t keylen;
+    const char *value;                  // the value text, as sent
+    size_t valuelen;
+};
+// most members in a SKY satellite object
+#define JSON_SAT_MEMBERS_MAX    16
 
 int json_ais_read(const char *, char *, size_t, struct ais_t *,
                   const char **);
+unsigned int json_ais_type(const char *);
 void json_aivdm_dump(const struct ais_t *, const char *, bool,
                      char *, size_t);
+int json_array_members(const char *, struct json_member_t *, int,
+                       const char **);
 void json_att_dump(const struct gps_data_t *, char *, size_t,
                    const struct attitude_t *, const char *);
 void json_data_report(const gps_mask_t, struct gps_device_t *,
@@ -24,7 +39,11 @@ void json_data_report(const gps_mask_t, struct gps_device_t *,
 void json_device_dump(const struct gps_device_t *, char *, size_t);
 int json_device_read(const char *, struct devconfig_t *,
                      const char **);
+void json_lexer_dump(const struct gps_device_t *, char *, size_t);
+bool json_member_is(const struct json_member_t *, const char *);
 void json_noise_dump(const struct gps_data_t *, char *, size_t);
+int json_object_members(const char *, struct json_member_t *, int,
+                        const char **);
 void json_oscillator_dump(const struct gps_data_t *, char *, size_t);
 char *json_policy_to_watch(struct gps_policy_t *ccp,
                            char *outbuf, size_t outbuf_len);
@@ -33,13 +52,17 @@ int json_rtcm2_read(const char *, char *, size_t, struct rtcm2_t *,
                     const char **);
 int json_rtcm3_read(const char *, char *, size_t, struct rtcm3_t *,
                     const char **);
+uint64_t json_sat_id(const char *);
 char *json_stringify(char *, size_t, const char *);
+const char *json_value_end(const char *);
 void json_tpv_dump(const gps_mask_t, struct gps_device_t *,
                    const struct gps_policy_t *, char *, size_t);
 void json_sky_dump(const struct gps_device_t *, char *, size_t);
 void json_subframe_dump(const struct gps_data_t *, const bool scaled,
                         char buf[], size_t);
-void json_watch_dump(const struct gps_policy_t *, char *, size_t);
+void json_watch_dump(const struct gps_policy_t *,
+                     const struct ais_filter_t *,
+                     const struct watch_rate_t *, char *, size_t);
 int json_watch_read(const char *, struct gps_policy_t *,
                     const char **);
 void json_version_dump(char *, size_t);
@@ -33,6 +33,9 @@ extern "C" {
 #include <time.h>    // for time_t
 
 #include "gps.h"
+#ifdef GREIS_ENABLE
+#include "driver_greis.h"       // for GREIS_MSGS
+#endif  // GREIS_ENABLE
 #include "os_compat.h"
 #include "ppsthread.h"
 #include "timespec.h"
@@ -130,6 +133,11 @@ extern "C" {
 #define AIVDM_ENABLE
 #endif
 
+// the AIS vessel table, max_ais_vessels=0 turns it off
+#if defined(AIVDM_ENABLE) && defined(MAX_AIS_VESSELS) && 0 < MAX_AIS_VESSELS
+#define AIS_VESSELS_ENABLE
+#endif
+
 #ifdef EARTHMATE_ENABLE
 #define ZODIAC_ENABLE
 #endif
@@ -240,6 +248,7 @@ struct gps_lexer_t {
 #define RTCM2_PACKET            19
 #define RTCM3_PACKET            20
 #define JSON_PACKET             21
+#define MAX_PACKET_TYPE         21      // increment this as necessary
 // end of non GPS type packets, AIVDM is GPS type??
 #define PACKET_TYPES            221      // increment this as necessary
 
@@ -291,6 +300,22 @@ struct gps_lexer_t {
 #endif  // STASH_ENABLE
     bool chunked;             // true if NTRIP/1.1 and the HTTP stream is chunked.
     int chunk_remaining;      // Bytes remaining before end of this chunk.
+    /*
+     * How the lexer is doing, for tuning it to a receiver.  Only
+     * lexer_init() clears these.  See ?LEXER.
+     */
+#define LEXER_STATES            256     // more than packet_states.h has
+#define LEXER_READ_BINS         16      // 0, 1, 2-3, 4-7, ... 16K and up
+    struct {
+        unsigned long accepted[MAX_PACKET_TYPE + 1];    // by type
+        unsigned long bad[MAX_PACKET_TYPE + 1];         // by claimed type
+        unsigned long discarded;        // bytes not in a good packet
+        unsigned long resync;           // discarded since last good packet
+        unsigned long max_resync;       // most discarded between good ones
+        unsigned long pushbacks[LEXER_STATES];  // by state pushed back from
+        unsigned long reads[LEXER_READ_BINS];   // read() sizes, log2 bins
+        unsigned long overflows;        // inbuffer filled, no packet in it
+    } stats;
 };
 
 extern void lexer_init(struct gps_lexer_t *, struct gpsd_errout_t *);
@@ -300,6 +325,9 @@ extern void packet_parse(struct gps_lexer_t *);
 // packet_get()  deprecated Sep 2023, use packet_get1() instead
 extern ssize_t packet_get(int, struct gps_lexer_t *);
 extern int packet_sniff(struct gps_lexer_t *);
+extern const char *packet_type_name(int);
+extern const char *packet_state_name(unsigned);
+extern char *packet_stats_dump(const struct gps_lexer_t *, char *, size_t);
 
 // return the number of bytes waiting in inbuffer
 #define packet_buffered_input(lexer) ((lexer)->inbuffer + (lexer)->inbuflen - (lexer)->inbufptr)
@@ -364,15 +392,26 @@ struct gps_context_t {
                             const char *buf, const size_t len);
 };
 
-// state for resolving interleaved Type 24 packets
+/* state for resolving interleaved Type 24 packets
+ * Each 24A waits, hashed by MMSI, for the 24B from the same MMSI.
+ * max_type24_pending sizes the table. */
 struct ais_type24a_t {
-    unsigned int mmsi;
+    unsigned int mmsi;                  // zero when the slot is free
+    time_t stashed;                     // when the 24A arrived
     char shipname[AIS_SHIPNAME_MAXLEN+1];
 };
-#define MAX_TYPE24_INTERLEAVE   8       // max number of queued type 24s
-struct ais_type24_queue_t {
-    struct ais_type24a_t ships[MAX_TYPE24_INTERLEAVE];
-    int index;
+#ifndef MAX_TYPE24_PENDING
+#define MAX_TYPE24_PENDING      64      // max number of 24As awaiting a 24B
+#endif
+// slots a 24A or 24B looks at, from its MMSI's hash on
+#define TYPE24_PROBE    (8 < MAX_TYPE24_PENDING ? 8 : MAX_TYPE24_PENDING)
+// ITU-R M.1371 sends 24B within a minute of 24A, allow for a lost one
+#define AIS_TYPE24_AGE          120     // seconds
+struct ais_type24_table_t {
+    struct ais_type24a_t ships[MAX_TYPE24_PENDING];
+    unsigned long hits;                 // 24Bs merged with their 24A
+    unsigned long misses;               // 24Bs without a 24A
+    unsigned long evicted;              // 24As dropped for room, unmatched
 };
 
 // state for resolving AIVDM decodes
@@ -381,7 +420,6 @@ struct aivdm_context_t {
     int decoded_frags;     // for tracking AIDVM parts in a multipart sequence
     unsigned char bits[2048];
     size_t bitlen;         // how many valid bits
-    struct ais_type24_queue_t type24_queue;
 };
 
 #define MODE_NMEA       0
@@ -398,6 +436,10 @@ typedef enum {
     EVENT_REACTIVATE,
 } event_t;
 
+// configuration sequencer pacing, see gpsd_configure()
+#define CONFIG_STEP_GAP         (250 * NS_IN_MS)  // between plain steps
+#define CONFIG_ACK_WAIT         2       // seconds to wait for an ACK/NAK
+
 
 #define INTERNAL_SET(n) ((gps_mask_t)(1llu<<(SET_HIGH_BIT+(n))))
 #define RAW_IS          INTERNAL_SET(1)         // raw pseudoranges available
@@ -452,6 +494,20 @@ struct gps_type_t {
     ssize_t (*control_send)(struct gps_device_t *session,
                             char *buf, size_t buflen);
     double (*time_offset)(struct gps_device_t *session);
+    /* EVENT_CONFIGURE steps, 0 to config_steps - 1 in cfg_stage,
+     * paced by gpsd_configure() */
+    unsigned int config_steps;
+};
+
+/*
+ * A USB receiver hotplug can name by vendor:product, so gpsd can open
+ * it the right way at once instead of probing and hunting.
+ */
+struct device_profile_t {
+    unsigned short vendor;              // USB idVendor
+    unsigned short product;             // USB idProduct
+    const struct gps_type_t *driver;    // the only driver to probe
+    int speed;                          // baud to open at, 0 as found
 };
 
 /*
@@ -491,6 +547,7 @@ typedef enum {SOURCE_UNKNOWN,
               SOURCE_PPS,       // PPS-only device, such as /dev/ppsN
               SOURCE_PIPE,      // Unix FIFO; don't use blocking I/O
               SOURCE_ACM,       // potential GPS source, discoverable, no speed
+              SOURCE_FED,       // upstream gpsd, decoded epochs over TCP/IP
 } sourcetype_t;
 
 /*
@@ -546,6 +603,8 @@ struct ntrip_stream_t
     int bitrate;
 };
 
+struct fed_stream_t;    // forward declaration, private to net_federation.c
+
 
 // session object, encapsulates all global state
 struct gps_device_t {
@@ -553,9 +612,18 @@ struct gps_device_t {
     const struct gps_type_t *device_type;
     unsigned int driver_index;        // numeric index of current driver
     unsigned int drivers_identified;  // bitmask; what drivers have we seen?
-    unsigned int cfg_stage;           // configuration stage counter
-    unsigned int cfg_step;            // configuration step counter
+    unsigned int cfg_stage;           // next config step, UINT_MAX done
+    bool cfg_wait;                    // last config step awaits ACK/NAK
+    timespec_t cfg_due;               // when the next config step may go
     const struct gps_type_t *last_controller;
+    const struct device_profile_t *profile;     // from hotplug, or NULL
+    timespec_t attach_time;           // when added, zero after first fix
+    timespec_t first_fix;             // from attach to first fix, ?LEXER
+    // main loop scheduling, see gpsd_multipoll()
+    bool poll_pending;                // budget ran out, packets left
+    timespec_t ready_since;           // input waiting since, 0 if none
+    timespec_t qdelay;                // how long input last waited
+    timespec_t qdelay_max;            // the longest input waited
     struct gps_context_t        *context;
     sourcetype_t sourcetype;
     servicetype_t servicetype;
@@ -594,6 +662,8 @@ struct gps_device_t {
     char msgbuf[MAX_PACKET_LENGTH*4+1]; // command message buffer for sends
     size_t msgbuflen;
     int observed;                       // which packet type`s have we seen?
+    // PACKET_TYPEMASK()s routed beside the driver in control
+    int protocols;
     bool cycle_end_reliable;            // does driver signal REPORT_MASK
     int fixcnt;                         // count of fixes from this device
     int last_word_gal;                  // last subframe word from Galileo
@@ -678,6 +748,9 @@ struct gps_device_t {
             bool seen_el;               // true if seen EL message
             // true if seen a raw measurement message
             bool seen_raw;
+            // messages of each enum greis_msg since rate_start
+            unsigned long msg_count[GREIS_MSGS];
+            time_t rate_start;
         } greis;
 #endif  // GREIS_ENABLE
 #ifdef SIRF_ENABLE
@@ -848,6 +921,8 @@ struct gps_device_t {
         struct {
             struct aivdm_context_t context[AIVDM_CHANNELS];
             char ais_channel;
+            // Class B units alternate channels, so 24A and 24B share this
+            struct ais_type24_table_t type24;
         } aivdm;
 #endif  // AIVDM_ENABLE
     } driver;
@@ -879,6 +954,16 @@ struct gps_device_t {
     struct {
         bool reported;
     } dgpsip;
+    /*
+     * State of a federation link to an upstream gpsd, fed://.  Kept
+     * across activations, so retries back off.  stream is only
+     * allocated while connected.
+     */
+    struct {
+        time_t retry;                   // no reconnect before this
+        int backoff;                    // seconds, doubles on each failure
+        struct fed_stream_t *stream;    // decoder state
+    } fed;
 };
 
 extern ssize_t packet_get1(struct gps_device_t *);
@@ -928,6 +1013,8 @@ extern void rtcm3_unpack(const struct gps_context_t *,
 
 // here are the available GPS drivers
 extern const struct gps_type_t **gpsd_drivers;
+extern const struct device_profile_t *gpsd_device_profile(unsigned int,
+                                                          unsigned int);
 
 // gpsd library internal prototypes
 extern gps_mask_t generic_parse_input(struct gps_device_t *);
@@ -963,6 +1050,9 @@ extern void ntrip_report(struct gps_context_t *,
                          struct gps_device_t *,
                          struct gps_device_t *);
 
+extern socket_t fed_open(struct gps_device_t *);
+extern void fed_close(struct gps_device_t *);
+
 extern bool gpsd_set_raw(struct gps_device_t *);
 extern int gpsd_serial_isatty(const struct gps_device_t *);
 extern int gpsd_serial_open(struct gps_device_t *);
@@ -971,6 +1061,11 @@ extern ssize_t gpsd_serial_write(struct gps_device_t *,
                                  const char *, const size_t);
 extern bool gpsd_next_hunt_setting(struct gps_device_t *);
 extern int gpsd_switch_driver(struct gps_device_t *, char *);
+extern void gpsd_config_start(struct gps_device_t *);
+extern void gpsd_config_ack(struct gps_device_t *);
+extern void gpsd_configure(struct gps_device_t *, const timespec_t *);
+extern void gpsd_config_timeout(const struct gps_device_t *,
+                                const timespec_t *, timespec_t *);
 extern void gpsd_set_speed(struct gps_device_t *, speed_t, char, unsigned int);
 extern int gpsd_get_speed(const struct gps_device_t *);
 extern int gpsd_get_speed_old(const struct gps_device_t *);
@@ -1071,6 +1166,130 @@ int initialize_dbus_connection (void);
 void send_dbus_fix (struct gps_device_t* channel);
 #endif  // defined(DBUS_EXPORT_ENABLE)
 
+/* Per-client AIS report filter, set by the ais* keys of ?WATCH.
+ * Kept in the daemon, not in gps_policy_t, to leave the libgps ABI alone.
+ * Criteria left unset (count zero) do not filter.
+ */
+#define AIS_FILTER_MMSI_MAX     32
+#define AIS_FILTER_TYPE_MAX     27
+struct ais_filter_t
+{
+    bool active;                // at least one criterion set
+    int nbox;                   // 4 if box[] is set
+    double box[4];              // minlat, minlon, maxlat, maxlon, degrees
+    int ncircle;                // 3 if circle[] is set
+    double circle[3];           // lat, lon in degrees, radius in meters
+    int nmmsi;
+    unsigned int mmsi[AIS_FILTER_MMSI_MAX];     // sorted, for bsearch()
+    int ntype;
+    unsigned int type[AIS_FILTER_TYPE_MAX];
+    unsigned long typemask;     // bit N set: pass message type N
+    double interval;            // min seconds between positions, per MMSI
+};
+extern int json_ais_filter_read(const char *, struct ais_filter_t *,
+                                const char **);
+extern void json_ais_filter_dump(const struct ais_filter_t *,
+                                 char *, size_t);
+
+/* Per-client report shaping, set by the *interval, "latest", "delta",
+ * "keyframe" and "compress" keys of ?WATCH.  Kept in the daemon, like
+ * ais_filter_t.  A class with a zero interval is reported every epoch.
+ * ATT goes out with TPV, so it is never reported more often than TPV.
+ */
+enum watch_rate_class
+{
+    RATE_TPV,
+    RATE_SKY,
+    RATE_ATT,
+    RATE_IMU,
+    RATE_GST,
+    RATE_RAW,
+    RATE_CLASSES
+};
+struct watch_rate_t
+{
+    bool active;                        // an interval, or latest, set
+    bool latest;                        // skip while writes stall
+    double interval[RATE_CLASSES];      // min seconds between reports
+    bool delta;                         // delta encode TPV and SKY
+    int keyframe;                       // deltas between full reports
+    char compress[8];                   // "deflate", or empty
+};
+extern int json_watch_rate_read(const char *, struct watch_rate_t *,
+                                const char **);
+extern void json_watch_rate_dump(const struct watch_rate_t *,
+                                 char *, size_t);
+
+/* Per-client state of delta encoded TPV and SKY: a hash of every value
+ * last sent, so a report only carries the ones that changed since.
+ * Satellites are matched by PRN, gnssid, svid and sigid.
+ */
+#define DELTA_KEYFRAME          10      // default "keyframe"
+#define DELTA_KEYS_MAX          96      // most keys in a TPV or SKY
+struct delta_key_t
+{
+    char name[16];
+    uint32_t hash;
+};
+struct delta_sat_t
+{
+    uint64_t id;                        // from json_sat_id()
+    uint32_t hash;
+};
+struct delta_class_t
+{
+    const struct gps_device_t *device;  // of the base, NULL if none
+    int count;                          // deltas since the keyframe
+    int nkeys;
+    struct delta_key_t keys[DELTA_KEYS_MAX];
+};
+struct delta_t
+{
+    struct delta_class_t tpv;
+    struct delta_class_t sky;
+    int nsats;
+    struct delta_sat_t sats[MAXCHANNELS];
+};
+extern void json_delta_encode(struct delta_t *, const struct gps_device_t *,
+                              int, char *, size_t);
+
+// ais_vessels.c, latest known state of each vessel heard
+#define AIS_BODY_SIZE(member)   sizeof(((struct ais_t *)NULL)->member)
+#define AIS_BODY_MAX(a, b)      ((a) > (b) ? (a) : (b))
+// biggest of the position report bodies, types 1-4, 9, 11, 18, 19, 21, 27
+#define AIS_POSITION_BODY \
+    AIS_BODY_MAX(AIS_BODY_MAX(AIS_BODY_MAX(AIS_BODY_SIZE(type1), \
+                                           AIS_BODY_SIZE(type4)), \
+                              AIS_BODY_MAX(AIS_BODY_SIZE(type9), \
+                                           AIS_BODY_SIZE(type18))), \
+                 AIS_BODY_MAX(AIS_BODY_MAX(AIS_BODY_SIZE(type19), \
+                                           AIS_BODY_SIZE(type21)), \
+                              AIS_BODY_SIZE(type27)))
+// biggest of the static data bodies, types 5 and 24
+#define AIS_INFO_BODY \
+    AIS_BODY_MAX(AIS_BODY_SIZE(type5), AIS_BODY_SIZE(type24))
+
+/* A vessel keeps two messages, the latest position report and its
+ * static data.  Each is stored as its header and only the type's own
+ * member of the struct ais_t union, ais_vessel_message() rebuilds the
+ * struct ais_t.
+ */
+struct ais_vessel_t
+{
+    unsigned int mmsi;
+    timespec_t seen;            // when last heard from
+    unsigned char position_type;        // 0 if none
+    unsigned char position_repeat;
+    unsigned char info_type;            // 5 or 24, 0 if none
+    unsigned char info_repeat;
+    unsigned char position[AIS_POSITION_BODY];
+    unsigned char info[AIS_INFO_BODY];
+};
+extern void ais_vessel_update(const struct ais_t *, const timespec_t *);
+extern const struct ais_vessel_t *ais_vessel_next(int *, const timespec_t *);
+extern bool ais_vessel_message(const struct ais_vessel_t *, bool,
+                               struct ais_t *);
+
 // a BSD transplant
 int b64_ntop(unsigned char const *src, size_t srclength, char *target,
     size_t targsize);
@@ -1109,7 +1328,7 @@ extern gps_mask_t gpsd_poll(struct gps_device_t *);
 extern int gpsd_multipoll(const bool,
                           struct gps_device_t *,
                           void (*)(struct gps_device_t *, gps_mask_t),
-                          float reawake_time);
+                          float reawake_time, unsigned budget);
 extern void gpsd_wrap(struct gps_device_t *);
 extern bool gpsd_add_device(const char *device_name, bool flag_nowait);
 extern const char *gpsd_maskdump(gps_mask_t);
@@ -1122,7 +1341,13 @@ extern bool ubx_write(struct gps_device_t *, unsigned int, unsigned int,
 extern bool ais_binary_decode(const struct gpsd_errout_t *errout,
                               struct ais_t *ais,
                               const unsigned char *, size_t,
-                              struct ais_type24_queue_t *);
+                              struct ais_type24_table_t *);
+extern void ais_type24a_stash(const struct gpsd_errout_t *,
+                              struct ais_type24_table_t *,
+                              unsigned int, const char *);
+extern bool ais_type24a_match(const struct gpsd_errout_t *,
+                              struct ais_type24_table_t *,
+                              unsigned int, char *, size_t);
 
 void gpsd_labeled_report(const int, const int,
                          const char *, const char *, va_list);
@@ -38,6 +38,7 @@ extern int gps_dbus_mainloop(struct gps_data_t *, int,
 
 extern int json_ais_read(const char *, char *, size_t, struct ais_t *,
                          const char **);
+extern unsigned int json_ais_type(const char *);
 
 // debugging apparatus for the client library
 #define DEBUG_CALLS     1       // shallowest debug level
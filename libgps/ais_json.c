@@ -15,6 +15,7 @@ SPDX-License-Identifier: BSD-2-clause
 
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>               // for CHAR_BIT
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -25,17 +26,49 @@ SPDX-License-Identifier: BSD-2-clause
 #ifdef SOCKET_EXPORT_ENABLE
 #include "../include/libgps.h"
 
+// unpack "bitcount:hex", no more bits than fit in maxlen bytes
 static void lenhex_unpack(const char *from,
                           size_t * plen, char *to, size_t maxlen)
 {
     char *colon = strchr(from, ':');
+    int bitcount = atoi(from);
 
-    *plen = (size_t)atoi(from);
+    if (0 > bitcount) {
+        bitcount = 0;
+    }
+    *plen = (size_t)bitcount;
+    if (CHAR_BIT * maxlen < *plen) {
+        *plen = CHAR_BIT * maxlen;
+    }
     if (NULL != colon) {
         (void)gps_hexpack(colon + 1, (unsigned char *)to, maxlen);
     }
 }
 
+/* Return the AIS message type of the report in buf, 0 if it has none,
+ * without parsing it.  gpsd writes "type" ahead of any nested object,
+ * so the first one is the message type.
+ */
+unsigned int json_ais_type(const char *buf)
+{
+    const char *cp = strstr(buf, "\"type\":");
+    unsigned int type = 0;
+
+    if (NULL == cp) {
+        return 0;
+    }
+    for (cp += 7; '0' <= *cp && '9' >= *cp; cp++) {
+        type = type * 10 + (unsigned int)(*cp - '0');
+        if (AIS_TYPE_MAX < type) {
+            return 0;
+        }
+    }
+    if (',' != *cp &&
+        '}' != *cp) {
+        return 0;
+    }
+    return type;
+}
 
 int json_ais_read(const char *buf,
                   char *path, size_t pathlen, struct ais_t *ais,
@@ -43,6 +76,7 @@ int json_ais_read(const char *buf,
 {
     // collected but not actually used yet
     bool scaled;
+    unsigned int type = json_ais_type(buf);
 
 #define AIS_HEADER \
         {"class",          t_check,    .dflt.check = "AIS"}, \
@@ -75,16 +109,16 @@ int json_ais_read(const char *buf,
 
 #include "ais_json.i"           // JSON parser template structures
 
-#undef AIS_HEADER
-
     memset(ais, '\0', sizeof(struct ais_t));
 
-    if (NULL != strstr(buf, "\"type\":1,") ||
-        NULL != strstr(buf, "\"type\":2,") ||
-        NULL != strstr(buf, "\"type\":3,")) {
+    if (1 == type ||
+        2 == type ||
+        3 == type) {
+        JSON_AIS1_ATTRS;
         status = json_read_object(buf, json_ais1, endptr);
-    } else if (NULL != strstr(buf, "\"type\":4,") ||
-               NULL != strstr(buf, "\"type\":11,")) {
+    } else if (4 == type ||
+               11 == type) {
+        JSON_AIS4_ATTRS;
         status = json_read_object(buf, json_ais4, endptr);
         if (0 == status) {
             ais->type4.year = AIS_YEAR_NOT_AVAILABLE;
@@ -103,7 +137,8 @@ int json_ais_read(const char *buf,
                          &ais->type4.minute,
                          &ais->type4.second);
         }
-    } else if (strstr(buf, "\"type\":5,") != NULL) {
+    } else if (5 == type) {
+        JSON_AIS5_ATTRS;
         status = json_read_object(buf, json_ais5, endptr);
         if (status == 0) {
             ais->type5.month = AIS_MONTH_NOT_AVAILABLE;
@@ -116,10 +151,11 @@ int json_ais_read(const char *buf,
                          &ais->type5.hour,
                          &ais->type5.minute);
         }
-    } else if (strstr(buf, "\"type\":6,") != NULL) {
+    } else if (6 == type) {
         bool structured = false;
         if (strstr(buf, "\"dac\":1,") != NULL) {
             if (strstr(buf, "\"fid\":12,") != NULL) {
+                JSON_AIS6_FID12_ATTRS;
                 status = json_read_object(buf, json_ais6_fid12, endptr);
                 if (status == 0) {
                     ais->type6.dac1fid12.lmonth = AIS_MONTH_NOT_AVAILABLE;
@@ -144,14 +180,17 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":15,") != NULL) {
+                JSON_AIS6_FID15_ATTRS;
                 status = json_read_object(buf, json_ais6_fid15, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":16,") != NULL) {
+                JSON_AIS6_FID16_ATTRS;
                 status = json_read_object(buf, json_ais6_fid16, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":18,") != NULL) {
+                JSON_AIS6_FID18_ATTRS;
                 status = json_read_object(buf, json_ais6_fid18, endptr);
                 if (status == 0) {
                     ais->type6.dac1fid18.day = AIS_DAY_NOT_AVAILABLE;
@@ -166,6 +205,7 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":20,") != NULL) {
+                JSON_AIS6_FID20_ATTRS;
                 status = json_read_object(buf, json_ais6_fid20, endptr);
                 if (status == 0) {
                     ais->type6.dac1fid20.month = AIS_MONTH_NOT_AVAILABLE;
@@ -181,10 +221,12 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":25,") != NULL) {
+                JSON_AIS6_FID25_ATTRS;
                 status = json_read_object(buf, json_ais6_fid25, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":28,") != NULL) {
+                JSON_AIS6_FID28_ATTRS;
                 status = json_read_object(buf, json_ais6_fid28, endptr);
                 if (status == 0) {
                     ais->type6.dac1fid28.month = AIS_MONTH_NOT_AVAILABLE;
@@ -200,11 +242,13 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":30,") != NULL) {
+                JSON_AIS6_FID30_ATTRS;
                 status = json_read_object(buf, json_ais6_fid30, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":32,") != NULL ||
                      strstr(buf, "\"fid\":14,") != NULL) {
+                JSON_AIS6_FID32_ATTRS;
                 status = json_read_object(buf, json_ais6_fid32, endptr);
                 structured = true;
             }
@@ -212,12 +256,14 @@ int json_ais_read(const char *buf,
         else if (strstr(buf, "\"dac\":235,") != NULL ||
                  strstr(buf, "\"dac\":250,") != NULL) {
             if (strstr(buf, "\"fid\":10,") != NULL) {
+                JSON_AIS6_FID10_ATTRS;
                 status = json_read_object(buf, json_ais6_fid10, endptr);
                 structured = true;
             }
         }
         else if (strstr(buf, "\"dac\":200,") != NULL) {
             if (strstr(buf, "\"fid\":21,") != NULL) {
+                JSON_AIS6_FID21_ATTRS;
                 status = json_read_object(buf, json_ais6_fid21, endptr);
                 structured = true;
                 if (status == 0) {
@@ -233,6 +279,7 @@ int json_ais_read(const char *buf,
                 }
             }
             else if (strstr(buf, "\"fid\":22,") != NULL) {
+                JSON_AIS6_FID22_ATTRS;
                 status = json_read_object(buf, json_ais6_fid22, endptr);
                 structured = true;
                 if (status == 0) {
@@ -248,24 +295,28 @@ int json_ais_read(const char *buf,
                 }
             }
             else if (strstr(buf, "\"fid\":55,") != NULL) {
+                JSON_AIS6_FID55_ATTRS;
                 status = json_read_object(buf, json_ais6_fid55, endptr);
                 structured = true;
             }
         }
         if (!structured) {
+            JSON_AIS6_ATTRS;
             status = json_read_object(buf, json_ais6, endptr);
             if (status == 0)
                 lenhex_unpack(data, &ais->type6.bitcount,
                               ais->type6.bitdata, sizeof(ais->type6.bitdata));
         }
         ais->type6.structured = structured;
-    } else if (strstr(buf, "\"type\":7,") != NULL
-               || strstr(buf, "\"type\":13,") != NULL) {
+    } else if (7 == type
+               || 13 == type) {
+        JSON_AIS7_ATTRS;
         status = json_read_object(buf, json_ais7, endptr);
-    } else if (strstr(buf, "\"type\":8,") != NULL) {
+    } else if (8 == type) {
         bool structured = false;
         if (strstr(buf, "\"dac\":1,") != NULL) {
             if (strstr(buf, "\"fid\":11,") != NULL) {
+                JSON_AIS8_FID11_ATTRS;
                 status = json_read_object(buf, json_ais8_fid11, endptr);
                 if (status == 0) {
                     ais->type8.dac1fid11.day = AIS_DAY_NOT_AVAILABLE;
@@ -279,6 +330,7 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":13,") != NULL) {
+                JSON_AIS8_FID13_ATTRS;
                 status = json_read_object(buf, json_ais8_fid13, endptr);
                 if (status == 0) {
                     ais->type8.dac1fid13.fmonth = AIS_MONTH_NOT_AVAILABLE;
@@ -303,24 +355,29 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":15,") != NULL) {
+                JSON_AIS8_FID15_ATTRS;
                 status = json_read_object(buf, json_ais8_fid15, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":16,") != NULL) {
+                JSON_AIS8_FID16_ATTRS;
                 status = json_read_object(buf, json_ais8_fid16, endptr);
                 if (status == 0) {
                         structured = true;
                 }
             }
             else if (strstr(buf, "\"fid\":17,") != NULL) {
+                JSON_AIS8_FID17_ATTRS;
                 status = json_read_object(buf, json_ais8_fid17, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":19,") != NULL) {
+                JSON_AIS8_FID19_ATTRS;
                 status = json_read_object(buf, json_ais8_fid19, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":23,") != NULL) {
+                JSON_AIS8_FID23_ATTRS;
                 status = json_read_object(buf, json_ais8_fid23, endptr);
                 ais->type8.dac200fid23.start_year = AIS_YEAR_NOT_AVAILABLE;
                 ais->type8.dac200fid23.start_month = AIS_MONTH_NOT_AVAILABLE;
@@ -347,10 +404,12 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":24,") != NULL) {
+                JSON_AIS8_FID24_ATTRS;
                 status = json_read_object(buf, json_ais8_fid24, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":27,") != NULL) {
+                JSON_AIS8_FID27_ATTRS;
                 status = json_read_object(buf, json_ais8_fid27, endptr);
                 if (status == 0) {
                     ais->type8.dac1fid27.month = AIS_MONTH_NOT_AVAILABLE;
@@ -366,10 +425,12 @@ int json_ais_read(const char *buf,
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":29,") != NULL) {
+                JSON_AIS8_FID29_ATTRS;
                 status = json_read_object(buf, json_ais8_fid29, endptr);
                 structured = true;
             }
             else if (strstr(buf, "\"fid\":31,") != NULL) {
+                JSON_AIS8_FID31_ATTRS;
                 status = json_read_object(buf, json_ais8_fid31, endptr);
                 if (status == 0) {
                     ais->type8.dac1fid31.day = AIS_DAY_NOT_AVAILABLE;
@@ -386,63 +447,83 @@ int json_ais_read(const char *buf,
         else if (strstr(buf, "\"dac\":200,") != NULL &&
                  strstr(buf,"data")==NULL) {
             if (strstr(buf, "\"fid\":10,") != NULL) {
+                JSON_AIS8_FID10_ATTRS;
                 status = json_read_object(buf, json_ais8_fid10, endptr);
                 structured = true;
             }
             if (strstr(buf, "\"fid\":40,") != NULL) {
+                JSON_AIS8_FID40_ATTRS;
                 status = json_read_object(buf, json_ais8_fid40, endptr);
                 structured = true;
             }
         }
         if (!structured) {
+            JSON_AIS8_ATTRS;
             status = json_read_object(buf, json_ais8, endptr);
             if (status == 0)
                 lenhex_unpack(data, &ais->type8.bitcount,
                               ais->type8.bitdata, sizeof(ais->type8.bitdata));
         }
         ais->type8.structured = structured;
-    } else if (strstr(buf, "\"type\":9,") != NULL) {
+    } else if (9 == type) {
+        JSON_AIS9_ATTRS;
         status = json_read_object(buf, json_ais9, endptr);
-    } else if (strstr(buf, "\"type\":10,") != NULL) {
+    } else if (10 == type) {
+        JSON_AIS10_ATTRS;
         status = json_read_object(buf, json_ais10, endptr);
-    } else if (strstr(buf, "\"type\":12,") != NULL) {
+    } else if (12 == type) {
+        JSON_AIS12_ATTRS;
         status = json_read_object(buf, json_ais12, endptr);
-    } else if (strstr(buf, "\"type\":14,") != NULL) {
+    } else if (14 == type) {
+        JSON_AIS14_ATTRS;
         status = json_read_object(buf, json_ais14, endptr);
-    } else if (strstr(buf, "\"type\":15,") != NULL) {
+    } else if (15 == type) {
+        JSON_AIS15_ATTRS;
         status = json_read_object(buf, json_ais15, endptr);
-    } else if (strstr(buf, "\"type\":16,") != NULL) {
+    } else if (16 == type) {
+        JSON_AIS16_ATTRS;
         status = json_read_object(buf, json_ais16, endptr);
-    } else if (strstr(buf, "\"type\":17,") != NULL) {
+    } else if (17 == type) {
+        JSON_AIS17_ATTRS;
         status = json_read_object(buf, json_ais17, endptr);
         if (status == 0)
             lenhex_unpack(data, &ais->type17.bitcount,
                           ais->type17.bitdata, sizeof(ais->type17.bitdata));
-    } else if (strstr(buf, "\"type\":18,") != NULL) {
+    } else if (18 == type) {
+        JSON_AIS18_ATTRS;
         status = json_read_object(buf, json_ais18, endptr);
-    } else if (strstr(buf, "\"type\":19,") != NULL) {
+    } else if (19 == type) {
+        JSON_AIS19_ATTRS;
         status = json_read_object(buf, json_ais19, endptr);
-    } else if (strstr(buf, "\"type\":20,") != NULL) {
+    } else if (20 == type) {
+        JSON_AIS20_ATTRS;
         status = json_read_object(buf, json_ais20, endptr);
-    } else if (strstr(buf, "\"type\":21,") != NULL) {
+    } else if (21 == type) {
+        JSON_AIS21_ATTRS;
         status = json_read_object(buf, json_ais21, endptr);
-    } else if (strstr(buf, "\"type\":22,") != NULL) {
+    } else if (22 == type) {
+        JSON_AIS22_ATTRS;
         status = json_read_object(buf, json_ais22, endptr);
-    } else if (strstr(buf, "\"type\":23,") != NULL) {
+    } else if (23 == type) {
+        JSON_AIS23_ATTRS;
         status = json_read_object(buf, json_ais23, endptr);
-    } else if (strstr(buf, "\"type\":24,") != NULL) {
+    } else if (24 == type) {
+        JSON_AIS24_ATTRS;
         status = json_read_object(buf, json_ais24, endptr);
-    } else if (strstr(buf, "\"type\":25,") != NULL) {
+    } else if (25 == type) {
+        JSON_AIS25_ATTRS;
         status = json_read_object(buf, json_ais25, endptr);
         if (status == 0)
             lenhex_unpack(data, &ais->type25.bitcount,
                           ais->type25.bitdata, sizeof(ais->type25.bitdata));
-    } else if (strstr(buf, "\"type\":26,") != NULL) {
+    } else if (26 == type) {
+        JSON_AIS26_ATTRS;
         status = json_read_object(buf, json_ais26, endptr);
         if (status == 0)
             lenhex_unpack(data, &ais->type26.bitcount,
                           ais->type26.bitdata, sizeof(ais->type26.bitdata));
-    } else if (strstr(buf, "\"type\":27,") != NULL) {
+    } else if (27 == type) {
+        JSON_AIS27_ATTRS;
         status = json_read_object(buf, json_ais27, endptr);
     } else {
         if (NULL != endptr) {
@@ -452,6 +533,10 @@ int json_ais_read(const char *buf,
     }
     return status;
 }
+
+// the _ATTRS macros from ais_json.i expand it where they are used
+#undef AIS_HEADER
+
 #endif  // SOCKET_EXPORT_ENABLE
 
 // vim: set expandtab shiftwidth=4
@@ -17,6 +17,7 @@
 #include "../include/gps.h"
 #include "../include/gpsdclient.h"
 #include "../include/os_compat.h"
+#include "../include/strfuncs.h"
 
 static struct exportmethod_t exportmethods[] = {
 #if defined(DBUS_EXPORT_ENABLE)
@@ -258,6 +259,20 @@ void gpsd_source_spec(const char *arg, struct fixsource_t *source)
         return;
     }
 
+    if (str_starts_with(source->spec, GPSD_LOCAL_SOCKET)) {
+        /* unix:/path/to/socket[:device]
+         * the local data socket, the path can not contain a colon */
+        source->server = source->spec;
+        colon1 = strchr(source->spec + sizeof(GPSD_LOCAL_SOCKET) - 1, ':');
+        if (NULL != colon1) {
+            *colon1 = '\0';
+            if ('\0' != colon1[1]) {
+                source->device = colon1 + 1;
+            }
+        }
+        return;
+    }
+
     server = source->spec;
     skipto = server;
     if ('[' == *skipto &&
@@ -669,6 +669,79 @@ time_t mkgmtime(struct tm * t)
     return (result);
 }
 
+#if !defined(USE_QT) && defined(HAVE_STRPTIME)
+/* Fast path for iso8601_to_timespec(), for the format gpsd writes:
+ * exactly "YYYY-MM-DDTHH:MM:SS", then maybe '.' and up to 15 digits.
+ * Fills tm and usec as strptime() and strtod() would.  n / 10^k, both
+ * exact doubles, rounds the same as strtod() does the decimal string.
+ * Return: true when done, false to leave it to strptime() and strtod().
+ */
+static bool iso8601_fast(const char *isotime, struct tm *tm, double *usec)
+{
+    static const char pattern[] = "dddd-dd-ddTdd:dd:dd";
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+        1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    int field[6] = {0};         // year, month, mday, hour, min, sec
+    int nfield = 0;
+    const char *cp;
+    int i;
+
+    for (i = 0; '\0' != pattern[i]; i++) {
+        char ch = isotime[i];
+
+        if ('d' != pattern[i]) {
+            if (pattern[i] != ch) {
+                return false;
+            }
+            nfield++;
+            continue;
+        }
+        if ('0' > ch ||
+            '9' < ch) {
+            return false;
+        }
+        field[nfield] = field[nfield] * 10 + (ch - '0');
+    }
+    if (1 > field[1] || 12 < field[1] ||
+        1 > field[2] || 31 < field[2] ||
+        23 < field[3] ||
+        59 < field[4] ||
+        59 < field[5]) {
+        // odd, but maybe strptime() knows better
+        return false;
+    }
+
+    cp = isotime + i;
+    if ('.' == *cp) {
+        unsigned long long frac = 0;
+        int ndigits = 0;
+
+        for (cp++; '0' <= *cp && '9' >= *cp; cp++) {
+            if (15 <= ndigits) {
+                return false;
+            }
+            frac = frac * 10 + (unsigned)(*cp - '0');
+            ndigits++;
+        }
+        if ('e' == *cp ||
+            'E' == *cp) {
+            // maybe an exponent, strtod() knows
+            return false;
+        }
+        *usec = (double)frac / pow10[ndigits];
+    }
+
+    tm->tm_year = field[0] - 1900;
+    tm->tm_mon = field[1] - 1;
+    tm->tm_mday = field[2];
+    tm->tm_hour = field[3];
+    tm->tm_min = field[4];
+    tm->tm_sec = field[5];
+    return true;
+}
+#endif  // !USE_QT && HAVE_STRPTIME
+
 // ISO8601 UTC to Unix timespec, no leapsecond correction.
 timespec_t iso8601_to_timespec(const char *isotime)
 {
@@ -693,7 +766,7 @@ timespec_t iso8601_to_timespec(const char *isotime)
     memset(&tm,0,sizeof(tm));
 
 #ifdef HAVE_STRPTIME
-    {
+    if (!iso8601_fast(isotime, &tm, &usec)) {
         char *dp = NULL;
         dp = strptime(isotime, "%Y-%m-%dT%H:%M:%S", &tm);
         if (NULL != dp &&
@@ -825,13 +898,63 @@ timespec_t iso8601_to_timespec(const char *isotime)
     return ret;
 }
 
+/* Render sec, 0 to 253402300799, as "YYYY-MM-DDTHH:MM:SS" plus NUL,
+ * what strftime("%Y-%m-%dT%H:%M:%S") of gmtime_r() gives, without
+ * either.  Days to civil date after Howard Hinnant's days_from_civil
+ * inverse, on 400 year eras starting March 1st.
+ */
+static void iso8601_prefix(time_t sec, char *out)
+{
+    long days = (long)(sec / 86400);
+    long daysec = (long)(sec % 86400);
+    long era, doe, yoe, doy, mp;
+    long year, month, mday;
+
+    days += 719468;             // shift epoch to 0000-03-01
+    era = days / 146097;
+    doe = days - era * 146097;                  // [0, 146096]
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;                   // March is 0
+    mday = doy - (153 * mp + 2) / 5 + 1;
+    month = 10 > mp ? mp + 3 : mp - 9;
+    year = yoe + era * 400 + (2 >= month);
+
+    out[0] = (char)('0' + year / 1000);
+    out[1] = (char)('0' + year / 100 % 10);
+    out[2] = (char)('0' + year / 10 % 10);
+    out[3] = (char)('0' + year % 10);
+    out[4] = '-';
+    out[5] = (char)('0' + month / 10);
+    out[6] = (char)('0' + month % 10);
+    out[7] = '-';
+    out[8] = (char)('0' + mday / 10);
+    out[9] = (char)('0' + mday % 10);
+    out[10] = 'T';
+    out[11] = (char)('0' + daysec / 36000);
+    out[12] = (char)('0' + daysec / 3600 % 10);
+    out[13] = ':';
+    out[14] = (char)('0' + daysec % 3600 / 600);
+    out[15] = (char)('0' + daysec % 3600 / 60 % 10);
+    out[16] = ':';
+    out[17] = (char)('0' + daysec % 60 / 10);
+    out[18] = (char)('0' + daysec % 10);
+    out[19] = '\0';
+}
+
 /* Convert POSIX timespec to ISO8601 UTC, put result in isotime.
  * no timezone adjustment
  * Return: pointer to isotime.
  * example: 2007-12-11T23:38:51.033Z */
 char *timespec_to_iso8601(timespec_t fixtime, char isotime[], size_t len)
 {
-    struct tm when;
+#ifdef THREAD_LOCAL
+    // most calls come many times in the same second, keep its date/time
+    static THREAD_LOCAL time_t cache_sec = -1;
+    static THREAD_LOCAL char cache_prefix[20];
+#else
+    char cache_prefix[20];
+#endif
     char timestr[30];
     long fracsec;
 
@@ -853,11 +976,13 @@ char *timespec_to_iso8601(timespec_t fixtime, char isotime[], size_t len)
     }
 #endif
 
-#ifdef HAVE_GMTIME_R
-    (void)gmtime_r(&fixtime.tv_sec, &when);
+#ifdef THREAD_LOCAL
+    if (cache_sec != fixtime.tv_sec) {
+        iso8601_prefix(fixtime.tv_sec, cache_prefix);
+        cache_sec = fixtime.tv_sec;
+    }
 #else
-    // Fallback to try with gmtime_s - primarily for Windows
-    (void)gmtime_s(&when, &fixtime.tv_sec);
+    iso8601_prefix(fixtime.tv_sec, cache_prefix);
 #endif
 
     /*
@@ -867,8 +992,15 @@ char *timespec_to_iso8601(timespec_t fixtime, char isotime[], size_t len)
      */
     fracsec = (fixtime.tv_nsec + 500000) / 1000000;
 
-    (void)strftime(timestr, sizeof(timestr), "%Y-%m-%dT%H:%M:%S", &when);
-    (void)snprintf(isotime, len, "%s.%03ldZ",timestr, fracsec);
+    // same as snprintf("%s.%03ldZ"), fracsec is 0 to 999
+    memcpy(timestr, cache_prefix, 19);
+    timestr[19] = '.';
+    timestr[20] = (char)('0' + fracsec / 100);
+    timestr[21] = (char)('0' + fracsec / 10 % 10);
+    timestr[22] = (char)('0' + fracsec % 10);
+    timestr[23] = 'Z';
+    timestr[24] = '\0';
+    (void)strlcpy(isotime, timestr, len);
 
     return isotime;
 }
@@ -68,10 +68,28 @@ PERMISSIONS
 #include <math.h>       // for HUGE_VAL
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>     // for uint64_t
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Vector instructions for the structural scan, see json_scan().
+#if defined(__GNUC__)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_SCAN_AVX2
+#define JSON_SCAN_BLOCK 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_SCAN_SSE2
+#define JSON_SCAN_BLOCK 16
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define JSON_SCAN_NEON
+#define JSON_SCAN_BLOCK 16
+#endif
+#endif  // __GNUC__
+
 #include "../include/compiler.h"   // for FALLTHROUGH
 #include "../include/os_compat.h"
 #include "../include/json.h"
@@ -107,7 +125,14 @@ static void json_trace(int errlevel, const char *fmt, ...)
     }
 }
 
-#define json_debug_trace(args) (void) json_trace args
+/* Test the level before the call, there is a trace for every token
+ * and every attribute name compared, and tracing is usually off. */
+#define json_debug_trace(args) \
+    do { \
+        if (0 < debuglevel) { \
+            (void)json_trace args; \
+        } \
+    } while (0)
 
 static char *json_target_address(const struct json_attr_t *cursor,
                                  const struct json_array_t
@@ -178,11 +203,188 @@ static char *json_target_address(const struct json_attr_t *cursor,
     return targetaddr;
 }
 
+/* Structural scanning.  Attribute names, string values and bare
+ * tokens are found a whole span at a time, then copied with one
+ * memcpy(), rather than a trip round the state machine per character.
+ *
+ * A span of a string (or attribute name) ends at '"', '\\' or NUL.
+ * A bare token ends at ',', '}', white space or NUL.  Where the CPU has
+ * vector instructions a block of bytes is tested at once, while a whole
+ * block fits before limit, the input's NUL.  The rest is tested a byte
+ * at a time, nothing past the NUL is read.
+ */
+#define JSON_SCAN_STRING        false
+#define JSON_SCAN_TOKEN         true
+
+static inline bool json_scan_stop(char ch, bool token)
+{
+    if (token) {
+        return ('\0' == ch ||
+                ',' == ch ||
+                '}' == ch ||
+                isspace((unsigned char)ch));
+    }
+    return ('\0' == ch ||
+            '"' == ch ||
+            '\\' == ch);
+}
+
+#ifdef JSON_SCAN_BLOCK
+#ifdef JSON_SCAN_NEON
+#define JSON_SCAN_BITS  4       // mask bits per byte
+#else
+#define JSON_SCAN_BITS  1
+#endif
+
+/* Return a mask with the bits of the bytes in the block at cp that may
+ * end the span set.  For tokens, all bytes up to ' ' are candidates,
+ * json_scan() sorts out white space from other control characters.
+ */
+static inline uint64_t json_scan_mask(const char *cp, bool token)
+{
+#if defined(JSON_SCAN_AVX2)
+    __m256i v = _mm256_loadu_si256((const __m256i *)cp);
+    __m256i m;
+
+    if (token) {
+        m = _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}')));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(
+                _mm256_min_epu8(v, _mm256_set1_epi8(' ')), v));
+    } else {
+        m = _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    }
+    return (uint32_t)_mm256_movemask_epi8(m);
+#elif defined(JSON_SCAN_SSE2)
+    __m128i v = _mm_loadu_si128((const __m128i *)cp);
+    __m128i m;
+
+    if (token) {
+        m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('}')));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(
+                _mm_min_epu8(v, _mm_set1_epi8(' ')), v));
+    } else {
+        m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    }
+    return (unsigned)_mm_movemask_epi8(m);
+#elif defined(JSON_SCAN_NEON)
+    uint8x16_t v = vld1q_u8((const uint8_t *)cp);
+    uint8x16_t m;
+
+    if (token) {
+        m = vorrq_u8(vceqq_u8(v, vdupq_n_u8(',')),
+                     vceqq_u8(v, vdupq_n_u8('}')));
+        m = vorrq_u8(m, vcleq_u8(v, vdupq_n_u8(' ')));
+    } else {
+        m = vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')),
+                     vceqq_u8(v, vdupq_n_u8('\\')));
+        m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8(0)));
+    }
+    // no movemask on NEON, narrow each byte to a nibble instead
+    return vget_lane_u64(vreinterpret_u64_u8(
+               vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+#endif
+}
+#endif  // JSON_SCAN_BLOCK
+
+// return pointer to the first character that ends the span at cp
+static const char *json_scan(const char *cp, const char *limit, bool token)
+{
+#ifdef JSON_SCAN_BLOCK
+    while (JSON_SCAN_BLOCK <= limit - cp) {
+        uint64_t mask = json_scan_mask(cp, token);
+
+        if (0 == mask) {
+            cp += JSON_SCAN_BLOCK;
+            continue;
+        }
+        cp += __builtin_ctzll(mask) / JSON_SCAN_BITS;
+        if (json_scan_stop(*cp, token)) {
+            return cp;
+        }
+        // a control character inside a token, keep going
+        cp++;
+    }
+#else
+    (void)limit;
+#endif  // JSON_SCAN_BLOCK
+    while (!json_scan_stop(*cp, token)) {
+        cp++;
+    }
+    return cp;
+}
+
+/* Skip a balanced array or object value, starting at its opening
+ * bracket.  Return pointer to the matching close bracket, or NULL
+ * if the input ends first.  Used for compound values of ignored
+ * attributes, so newer peers can send keys we know nothing about.
+ */
+static const char *json_skip_compound(const char *cp)
+{
+    int depth = 0;
+    bool in_string = false;
+
+    for (; '\0' != *cp; cp++) {
+        if (in_string) {
+            if ('\\' == *cp) {
+                if ('\0' == *++cp) {
+                    break;
+                }
+            } else if ('"' == *cp) {
+                in_string = false;
+            }
+            continue;
+        }
+        switch (*cp) {
+        case '"':
+            in_string = true;
+            break;
+        case '[':
+        case '{':
+            depth++;
+            break;
+        case ']':
+        case '}':
+            if (0 == --depth) {
+                return cp;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return NULL;
+}
+
+
+/* Key order prediction for arrays of objects.  The elements of an
+ * array nearly always have their keys in the same order, so the
+ * attribute matched by the n-th key of one element is tried first for
+ * the n-th key of the next, before searching the attribute table.
+ */
+#define JSON_PREDICT_KEYS       32
+struct json_predict_t {
+    const struct json_attr_t *cursor[JSON_PREDICT_KEYS];
+};
+
+static int json_internal_read_array(const char *cp,
+                                    const struct json_array_t *arr,
+                                    const char *limit, const char **end);
 
+// limit is the NUL ending the input
 static int json_internal_read_object(const char *cp,
                                      const struct json_attr_t *attrs,
                                      const struct json_array_t *parent,
                                      int offset,
+                                     struct json_predict_t *predict,
+                                     const char *limit,
                                      const char **end)
 {
     enum
@@ -202,15 +404,27 @@ static int json_internal_read_object(const char *cp,
     unsigned int u;
     const struct json_enum_t *mp;
     char *lptr;
+    char *element = NULL;       // the struct, in an array of structs
+    int nkey = 0;               // keys seen so far
 
     if (NULL != end) {
         *end = NULL;    // give it a well-defined value on parse failure
     }
+    if (NULL != parent &&
+        t_structobject == parent->element_type) {
+        // members are at fixed offsets in here, no need to ask each time
+        element = parent->arr.objects.base +
+                  offset * parent->arr.objects.stride;
+    }
 
     // stuff fields with defaults in case they're omitted in the JSON input
     for (cursor = attrs; cursor->attribute != NULL; cursor++)
         if (!cursor->nodefault) {
-            lptr = json_target_address(cursor, parent, offset);
+            if (NULL != element) {
+                lptr = element + cursor->addr.offset;
+            } else {
+                lptr = json_target_address(cursor, parent, offset);
+            }
             if (NULL != lptr)
                 switch (cursor->type) {
                 case t_byte:
@@ -321,10 +535,37 @@ static int json_internal_read_object(const char *cp,
                 // don't update end here, leave at attribute start
                 return JSON_ERR_NULLPTR;
             }
-            if (*cp == '"') {
-                *pattr++ = '\0';
-                json_debug_trace((1, "Collected attribute name %s\n",
-                                  attrbuf));
+            {
+                // names have no escapes, a backslash is just a character
+                const char *stop = cp;
+
+                do {
+                    stop = json_scan(stop, limit, JSON_SCAN_STRING);
+                } while ('\\' == *stop && '\0' != *++stop);
+                if ((stop - cp) + (pattr - attrbuf) > JSON_ATTR_MAX - 1) {
+                    json_debug_trace((1, "Attribute name too long.\n"));
+                    // don't update end here, leave at attribute start
+                    return JSON_ERR_ATTRLEN;
+                }
+                memcpy(pattr, cp, stop - cp);
+                pattr += stop - cp;
+                if ('"' != *stop) {
+                    // input ends inside the name
+                    cp = stop - 1;
+                    break;
+                }
+                cp = stop;
+            }
+            *pattr++ = '\0';
+            json_debug_trace((1, "Collected attribute name %s\n",
+                              attrbuf));
+            if (NULL != predict &&
+                JSON_PREDICT_KEYS > nkey &&
+                NULL != predict->cursor[nkey] &&
+                0 == strcmp(predict->cursor[nkey]->attribute, attrbuf)) {
+                // same key here in the previous element
+                cursor = predict->cursor[nkey];
+            } else {
                 for (cursor = attrs; cursor->attribute != NULL; cursor++) {
                     json_debug_trace((2, "Checking against %s\n",
                                       cursor->attribute));
@@ -336,40 +577,53 @@ static int json_internal_read_object(const char *cp,
                         break;
                     }
                 }
-                if (NULL == cursor->attribute) {
-                    json_debug_trace((1,
-                                      "Unknown attribute name '%s'"
-                                      " (attributes begin with '%s').\n",
-                                      attrbuf, attrs->attribute));
-                    // don't update end here, leave at attribute start
-                    return JSON_ERR_BADATTR;
-                }
-                state = await_value;
-                if (cursor->type == t_string) {
-                    maxlen = (int)cursor->len - 1;
-                } else if (cursor->type == t_check) {
-                    maxlen = (int)strnlen(cursor->dflt.check, JSON_VAL_MAX);
-                } else if (cursor->type == t_time ||
-                           cursor->type == t_ignore) {
-                    maxlen = JSON_VAL_MAX;
-                } else if (NULL != cursor->map) {
-                    maxlen = (int)sizeof(valbuf) - 1;
+                if (NULL != predict &&
+                    JSON_PREDICT_KEYS > nkey &&
+                    NULL != cursor->attribute) {
+                    predict->cursor[nkey] = cursor;
                 }
-                pval = valbuf;
-            } else if (pattr >= attrbuf + JSON_ATTR_MAX - 1) {
-                json_debug_trace((1, "Attribute name too long.\n"));
+            }
+            nkey++;
+            if (NULL == cursor->attribute) {
+                json_debug_trace((1,
+                                  "Unknown attribute name '%s'"
+                                  " (attributes begin with '%s').\n",
+                                  attrbuf, attrs->attribute));
                 // don't update end here, leave at attribute start
-                return JSON_ERR_ATTRLEN;
-            } else {
-                *pattr++ = *cp;
+                return JSON_ERR_BADATTR;
+            }
+            state = await_value;
+            if (cursor->type == t_string) {
+                maxlen = (int)cursor->len - 1;
+            } else if (cursor->type == t_check) {
+                maxlen = (int)strnlen(cursor->dflt.check, JSON_VAL_MAX);
+            } else if (cursor->type == t_time ||
+                       cursor->type == t_ignore) {
+                maxlen = JSON_VAL_MAX;
+            } else if (NULL != cursor->map) {
+                maxlen = (int)sizeof(valbuf) - 1;
             }
+            pval = valbuf;
             break;
         case await_value:
             if (isspace((unsigned char) *cp) ||
                 *cp == ':') {
                 continue;
             }
-            if (*cp == '[') {
+            if (cursor->type == t_ignore &&
+                (*cp == '[' || *cp == '{')) {
+                const char *close = json_skip_compound(cp);
+
+                if (NULL == close) {
+                    json_debug_trace((1, "Unterminated ignored value.\n"));
+                    if (NULL != end) {
+                        *end = cp;
+                    }
+                    return JSON_ERR_BADTRAIL;
+                }
+                cp = close;
+                state = post_element;
+            } else if (*cp == '[') {
                 if (cursor->type != t_array) {
                     json_debug_trace((1,
                                       "Saw [ when not expecting array.\n"));
@@ -378,7 +632,9 @@ static int json_internal_read_object(const char *cp,
                     }
                     return JSON_ERR_NOARRAY;
                 }
-                substatus = json_read_array(cp, &cursor->addr.array, &cp);
+                substatus = json_internal_read_array(cp,
+                                                     &cursor->addr.array,
+                                                     limit, &cp);
                 if (substatus != 0) {
                     return substatus;
                 }
@@ -406,19 +662,30 @@ static int json_internal_read_object(const char *cp,
                 // don't update end here, leave at value start
                 return JSON_ERR_NULLPTR;
             }
+            {
+                const char *stop = json_scan(cp, limit, JSON_SCAN_STRING);
+                int room = JSON_VAL_MAX < maxlen ? JSON_VAL_MAX : maxlen;
+
+                // an escape may have left pval at room + 1, that's OK
+                if (stop > cp &&
+                    (stop - cp) + (pval - valbuf) > room) {
+                    json_debug_trace((1, "String value too long.\n"));
+                    // don't update end here, leave at value start
+                    return JSON_ERR_STRLONG;
+                }
+                memcpy(pval, cp, stop - cp);
+                pval += stop - cp;
+                cp = stop;
+            }
             if (*cp == '\\') {
                 state = in_escape;
             } else if (*cp == '"') {
                 *pval++ = '\0';
                 json_debug_trace((1, "Collected string value %s\n", valbuf));
                 state = post_val;
-            } else if (pval > valbuf + JSON_VAL_MAX - 1 ||
-                       pval > valbuf + maxlen - 1) {
-                json_debug_trace((1, "String value too long.\n"));
-                // don't update end here, leave at value start
-                return JSON_ERR_STRLONG;
             } else {
-                *pval++ = *cp;
+                // input ends inside the string
+                --cp;
             }
             break;
         case in_escape:
@@ -479,22 +746,30 @@ static int json_internal_read_object(const char *cp,
                 // don't update end here, leave at value start
                 return JSON_ERR_NULLPTR;
             }
-            if (isspace((unsigned char) *cp) ||
-                *cp == ',' ||
-                *cp == '}') {
-                *pval = '\0';
-                json_debug_trace((1, "Collected token value %s.\n", valbuf));
-                state = post_val;
-                if (*cp == '}' ||
-                    *cp == ',') {
-                    --cp;
+            {
+                const char *stop = json_scan(cp, limit, JSON_SCAN_TOKEN);
+
+                if (stop > cp &&
+                    (stop - cp) + (pval - valbuf) > JSON_VAL_MAX) {
+                    json_debug_trace((1, "Token value too long.\n"));
+                    // don't update end here, leave at value start
+                    return JSON_ERR_TOKLONG;
                 }
-            } else if (pval > valbuf + JSON_VAL_MAX - 1) {
-                json_debug_trace((1, "Token value too long.\n"));
-                // don't update end here, leave at value start
-                return JSON_ERR_TOKLONG;
-            } else {
-                *pval++ = *cp;
+                memcpy(pval, cp, stop - cp);
+                pval += stop - cp;
+                cp = stop;
+            }
+            if ('\0' == *cp) {
+                // input ends inside the token
+                --cp;
+                break;
+            }
+            *pval = '\0';
+            json_debug_trace((1, "Collected token value %s.\n", valbuf));
+            state = post_val;
+            if (*cp == '}' ||
+                *cp == ',') {
+                --cp;
             }
             break;
             // coverity[unterminated_case]
@@ -586,6 +861,8 @@ static int json_internal_read_object(const char *cp,
             }
             if (cursor->type == t_check) {
                 lptr = cursor->dflt.check;
+            } else if (NULL != element) {
+                lptr = element + cursor->addr.offset;
             } else {
                 lptr = json_target_address(cursor, parent, offset);
             }
@@ -741,11 +1018,13 @@ static int json_internal_read_object(const char *cp,
     return 0;
 }
 
-int json_read_array(const char *cp, const struct json_array_t *arr,
-                    const char **end)
+static int json_internal_read_array(const char *cp,
+                                    const struct json_array_t *arr,
+                                    const char *limit, const char **end)
 {
     int substatus, offset, arrcount;
     char *tp;
+    struct json_predict_t predict;
 
     if (NULL != end)
         *end = NULL;    // give it a well-defined value on parse failure
@@ -763,6 +1042,7 @@ int json_read_array(const char *cp, const struct json_array_t *arr,
 
     tp = arr->arr.strings.store;
     arrcount = 0;
+    memset(&predict, 0, sizeof(predict));
 
     // Check for empty array
     while (isspace((unsigned char)*cp)) {
@@ -809,7 +1089,7 @@ int json_read_array(const char *cp, const struct json_array_t *arr,
         case t_structobject:
             substatus =
                 json_internal_read_object(cp, arr->arr.objects.subtype, arr,
-                                          offset, &cp);
+                                          offset, &predict, limit, &cp);
             if (substatus != 0) {
                 if (NULL != end) {
                     *end = cp;
@@ -958,13 +1238,20 @@ int json_read_array(const char *cp, const struct json_array_t *arr,
     return 0;
 }
 
+int json_read_array(const char *cp, const struct json_array_t *arr,
+                    const char **end)
+{
+    return json_internal_read_array(cp, arr, cp + strlen(cp), end);
+}
+
 int json_read_object(const char *cp, const struct json_attr_t *attrs,
                      const char **end)
 {
     int st;
 
     json_debug_trace((1, "json_read_object() sees '%s'\n", cp));
-    st = json_internal_read_object(cp, attrs, NULL, 0, end);
+    st = json_internal_read_object(cp, attrs, NULL, 0, NULL,
+                                   cp + strlen(cp), end);
     return st;
 }
 
@@ -956,6 +956,13 @@ def generate(spec):
             report += "    char %s[JSON_VAL_MAX+1];\n" % attr
             outboard.append(attr)
 
+    print(report)
+
+    # The parse controls go in a macro, to be expanded in the branch
+    # that uses them.  Every initializer refers to the target struct,
+    # so it is built at run time, and building all of them for every
+    # message cost more than the parse itself.
+    report = ""
     structname = spec["structname"]
     # If there are structarrays describing array subobjects, we need
     # to make a separate parse control initializer for each one.  The
@@ -1019,9 +1026,9 @@ def generate(spec):
                 report += leader + ".dflt.%s = %s},\n" % (itype, default)
     report += """\
         {NULL}
-    };
-"""
-    print(report)
+    }"""
+    print("#define %s_ATTRS \\\n%s\n"
+          % (initname.upper(), " \\\n".join(report.split("\n"))))
 
 
 if __name__ == '__main__':
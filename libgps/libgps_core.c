@@ -66,6 +66,8 @@ void libgps_trace(int errlevel, const char *fmt, ...)
  *     GPSD_FILE_LOCAL "local file"       - to read to local file
  *        port is file name to open
  *     GPSD_SHARED_MEMORY "shared memory" - to connect to local chared memory
+ *     GPSD_LOCAL_SOCKET "unix:/path"     - to connect to the local
+ *                                          data socket at /path
  *
  * Return: 0 osnuccess
  *         less than zero on failure
@@ -387,6 +389,41 @@ int gps_stream(struct gps_data_t *gpsdata, watch_t flags,
     return status;
 }
 
+/* Unpack only the AIS message types in typemask, AIS_TYPE_BIT()s or'ed
+ * together, 0 for all of them.  Other AIS messages are stepped over
+ * without being parsed, and leave AIS_SET clear.
+ *
+ * Return: 0 -- success
+ * Return: negative -- fail, not open
+ */
+int gps_ais_filter(struct gps_data_t *gpsdata, unsigned long typemask)
+{
+    if (NULL == PRIVATE(gpsdata)) {
+        return -1;
+    }
+    PRIVATE(gpsdata)->ais_types = typemask;
+    return 0;
+}
+
+/* Call hook, NULL for none, from gps_read() after each AIS message of
+ * type is unpacked into gpsdata->ais.  A hook does not change the
+ * gps_ais_filter() mask; a type filtered out is never seen.
+ *
+ * Return: 0 -- success
+ * Return: negative -- fail, not open or no such type
+ */
+int gps_ais_hook(struct gps_data_t *gpsdata, unsigned int type,
+                 void (*hook)(struct gps_data_t *))
+{
+    if (NULL == PRIVATE(gpsdata) ||
+        1 > type ||
+        AIS_TYPE_MAX < type) {
+        return -1;
+    }
+    PRIVATE(gpsdata)->ais_hooks[type] = hook;
+    return 0;
+}
+
 // return the contents of the client data buffer
 const char *gps_data(const struct gps_data_t *gpsdata CONDITIONALLY_UNUSED)
 {
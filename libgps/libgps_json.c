@@ -21,6 +21,7 @@ PERMISSIONS
 
 #include "../include/gpsd_config.h"   // must be before all includes
 
+#include <ctype.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -278,6 +279,7 @@ static int json_raw_read(const char *buf, struct gps_data_t *gpsdata,
     if (0 != status) {
         return status;
     }
+    gpsdata->raw.nmeas = (unsigned)measurements;
     gpsdata->set |= RAW_SET;
     if (0 == isfinite(mtime_s) ||
         0 == isfinite(mtime_ns)) {
@@ -789,6 +791,300 @@ int json_oscillator_read(const char *buf, struct gps_data_t *gpsdata,
 #define PASS(n) (((n) == 0) || ((n) == JSON_ERR_BADATTR))
 #define FILTER(n) ((n) == JSON_ERR_BADATTR ? 0 : n)
 
+/* return the end of the JSON object that starts at buf, past any
+ * trailing whitespace, as json_read_object() does
+ */
+static const char *json_object_end(const char *buf)
+{
+    const char *cp = strchr(buf, '{');
+
+    if (NULL == cp) {
+        return buf + strlen(buf);
+    }
+    cp = json_value_end(cp);
+    while (isspace((unsigned char)*cp)) {
+        cp++;
+    }
+    return cp;
+}
+
+// keys of a delta encoded report that are not report keys
+static bool delta_special(const struct json_member_t *member)
+{
+    return json_member_is(member, "class") ||
+           json_member_is(member, "device") ||
+           json_member_is(member, "delta") ||
+           json_member_is(member, "unset") ||
+           json_member_is(member, "satellites") ||
+           json_member_is(member, "gone");
+}
+
+// find the key of member among members, -1 if not there
+static int delta_find(const struct json_member_t *members, int n,
+                      const struct json_member_t *member)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (members[i].keylen == member->keylen &&
+            0 == strncmp(members[i].key, member->key, member->keylen)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// true if both objects have the same "device", or neither has one
+static bool delta_same_device(const struct json_member_t *a, int na,
+                              const struct json_member_t *b, int nb)
+{
+    const struct json_member_t device = {"device", 6, NULL, 0};
+    int i = delta_find(a, na, &device);
+    int j = delta_find(b, nb, &device);
+
+    if (0 > i ||
+        0 > j) {
+        return i == j;
+    }
+    return a[i].valuelen == b[j].valuelen &&
+           0 == strncmp(a[i].value, b[j].value, a[i].valuelen);
+}
+
+// true if the "unset" array value lists the key of member
+static bool delta_unset(const struct json_member_t *unset,
+                        const struct json_member_t *member)
+{
+    const char *cp;
+
+    if (NULL == unset) {
+        return false;
+    }
+    for (cp = unset->value; cp < unset->value + unset->valuelen; cp++) {
+        if ('"' == *cp &&
+            0 == strncmp(cp + 1, member->key, member->keylen) &&
+            '"' == cp[member->keylen + 1]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void delta_write(char *out, size_t outlen, bool *first,
+                        const char *text, size_t len)
+{
+    size_t used = strnlen(out, outlen);
+
+    if (!*first &&
+        used + 1 < outlen) {
+        out[used++] = ',';
+    }
+    if (used + len < outlen) {
+        memcpy(out + used, text, len);
+        used += len;
+    }
+    out[used] = '\0';
+    *first = false;
+}
+
+// write the satellites of base, updated by delta, as a "satellites" key
+static void delta_sats(char *out, size_t outlen, bool *first,
+                       const struct json_member_t *base,
+                       const struct json_member_t *delta,
+                       const struct json_member_t *gone)
+{
+    struct json_member_t bsats[MAXCHANNELS], dsats[MAXCHANNELS];
+    struct json_member_t gsats[MAXCHANNELS];
+    uint64_t dids[MAXCHANNELS];
+    bool used[MAXCHANNELS];
+    bool firstsat = true;
+    int nb = 0, nd = 0, ng = 0;
+    int i, j;
+
+    if (NULL != base) {
+        nb = json_array_members(base->value, bsats, MAXCHANNELS, NULL);
+    }
+    if (NULL != delta) {
+        nd = json_array_members(delta->value, dsats, MAXCHANNELS, NULL);
+    }
+    if (NULL != gone) {
+        ng = json_array_members(gone->value, gsats, MAXCHANNELS, NULL);
+    }
+    nb = 0 > nb ? 0 : nb;
+    nd = 0 > nd ? 0 : nd;
+    ng = 0 > ng ? 0 : ng;
+    if (0 == nb + nd) {
+        return;
+    }
+    delta_write(out, outlen, first, "\"satellites\":[", 14);
+    for (j = 0; j < nd; j++) {
+        dids[j] = json_sat_id(dsats[j].value);
+        used[j] = false;
+    }
+    // the old ones, less the gone, with changes
+    for (i = 0; i < nb; i++) {
+        const struct json_member_t *sat = &bsats[i];
+        uint64_t id = json_sat_id(sat->value);
+
+        for (j = 0; j < ng; j++) {
+            if (json_sat_id(gsats[j].value) == id) {
+                break;
+            }
+        }
+        if (j < ng) {
+            continue;
+        }
+        for (j = 0; j < nd; j++) {
+            if (!used[j] &&
+                dids[j] == id) {
+                sat = &dsats[j];
+                used[j] = true;
+                break;
+            }
+        }
+        delta_write(out, outlen, &firstsat, sat->value, sat->valuelen);
+    }
+    // then the new ones
+    for (j = 0; j < nd; j++) {
+        if (!used[j]) {
+            delta_write(out, outlen, &firstsat, dsats[j].value,
+                        dsats[j].valuelen);
+        }
+    }
+    (void)strlcat(out, "]", outlen);
+}
+
+/* Rebuild the full TPV or SKY that the delta encoded report in buf
+ * stands for into out, using base, the last full one.  For a keyframe,
+ * "delta":false, that is buf less the marker.  Return false if buf is
+ * not delta encoded.
+ */
+static bool json_delta_merge(const char *buf, const char *base,
+                             char *out, size_t outlen)
+{
+    struct json_member_t dmembers[DELTA_KEYS_MAX + 6];
+    struct json_member_t bmembers[DELTA_KEYS_MAX];
+    const struct json_member_t *unset = NULL, *gone = NULL;
+    const struct json_member_t *bsats = NULL, *dsats = NULL;
+    bool keyframe = false;
+    bool first = true;
+    int nd, nb = 0;
+    int i;
+
+    nd = json_object_members(buf, dmembers, ROWS(dmembers), NULL);
+    // the marker comes right after the class and device
+    for (i = 0; i < nd && i < 3; i++) {
+        if (json_member_is(&dmembers[i], "delta")) {
+            break;
+        }
+    }
+    if (i == nd ||
+        3 == i) {
+        return false;
+    }
+    keyframe = str_starts_with(dmembers[i].value, "false");
+
+    for (i = 0; i < nd; i++) {
+        if (json_member_is(&dmembers[i], "unset")) {
+            unset = &dmembers[i];
+        } else if (json_member_is(&dmembers[i], "gone")) {
+            gone = &dmembers[i];
+        } else if (json_member_is(&dmembers[i], "satellites")) {
+            dsats = &dmembers[i];
+        }
+    }
+    if (!keyframe) {
+        nb = json_object_members(base, bmembers, ROWS(bmembers), NULL);
+        if (0 > nb ||
+            !delta_same_device(bmembers, nb, dmembers, nd)) {
+            // nothing to build on
+            nb = 0;
+        }
+    }
+
+    out[0] = '\0';
+    (void)strlcat(out, "{", outlen);
+    // class and device first, as gpsd sends them
+    for (i = 0; i < nd; i++) {
+        if (json_member_is(&dmembers[i], "class") ||
+            json_member_is(&dmembers[i], "device")) {
+            delta_write(out, outlen, &first, dmembers[i].key - 1,
+                        (size_t)(dmembers[i].value + dmembers[i].valuelen -
+                                 dmembers[i].key + 1));
+        }
+    }
+    // the old keys, less the unset, with changes
+    for (i = 0; i < nb; i++) {
+        const struct json_member_t *member = &bmembers[i];
+        int d;
+
+        if (json_member_is(member, "satellites")) {
+            bsats = member;
+            delta_sats(out, outlen, &first, bsats, dsats, gone);
+            continue;
+        }
+        if (delta_special(member) ||
+            delta_unset(unset, member)) {
+            continue;
+        }
+        d = delta_find(dmembers, nd, member);
+        if (0 <= d) {
+            member = &dmembers[d];
+        }
+        delta_write(out, outlen, &first, member->key - 1,
+                    (size_t)(member->value + member->valuelen -
+                             member->key + 1));
+    }
+    // then the new ones
+    for (i = 0; i < nd; i++) {
+        if (delta_special(&dmembers[i]) ||
+            0 <= delta_find(bmembers, nb, &dmembers[i])) {
+            continue;
+        }
+        delta_write(out, outlen, &first, dmembers[i].key - 1,
+                    (size_t)(dmembers[i].value + dmembers[i].valuelen -
+                             dmembers[i].key + 1));
+    }
+    if (NULL == bsats) {
+        delta_sats(out, outlen, &first, NULL, dsats, NULL);
+    }
+    (void)strlcat(out, "}", outlen);
+    return true;
+}
+
+/* If buf is a delta encoded TPV or SKY, rebuild the full report on
+ * base, the last one, keep it as the new base, and return it, with
+ * *end set past the object in buf.  Otherwise return buf.
+ */
+static const char *json_delta_apply(const char *buf,
+                                    struct privdata_t *priv, bool sky,
+                                    const char **end)
+{
+    char *base;
+    size_t baselen;
+
+    if (NULL == priv) {
+        return buf;
+    }
+    if (sky) {
+        base = priv->delta_sky;
+        baselen = sizeof(priv->delta_sky);
+    } else {
+        base = priv->delta_tpv;
+        baselen = sizeof(priv->delta_tpv);
+    }
+    if (
+        NULL == strstr(buf, "\"delta\":") ||
+        !json_delta_merge(buf, base, priv->delta_scratch,
+                          sizeof(priv->delta_scratch))) {
+        return buf;
+    }
+    (void)strlcpy(base, priv->delta_scratch, baselen);
+    if (NULL != end) {
+        *end = json_object_end(buf);
+    }
+    return base;
+}
+
 // the only entry point - unpack a JSON object into gpsdata_t substructures
 int libgps_json_unpack(const char *buf,
                        struct gps_data_t *gpsdata, const char **end)
@@ -801,7 +1097,10 @@ int libgps_json_unpack(const char *buf,
     }
 
     if (str_starts_with(classtag, "\"class\":\"TPV\"")) {
-        status = json_tpv_read(buf, gpsdata, end);
+        const char *report = json_delta_apply(buf, gpsdata->privdata,
+                                              false, end);
+
+        status = json_tpv_read(report, gpsdata, report == buf ? end : NULL);
         gpsdata->set = STATUS_SET;
         if (0 != gpsdata->fix.time.tv_sec) {
             gpsdata->set |= TIME_SET;
@@ -890,7 +1189,10 @@ int libgps_json_unpack(const char *buf,
         return FILTER(status);
     }
     if (str_starts_with(classtag, "\"class\":\"SKY\"")) {
-        status = json_sky_read(buf, gpsdata, end);
+        const char *report = json_delta_apply(buf, gpsdata->privdata,
+                                              true, end);
+
+        status = json_sky_read(report, gpsdata, report == buf ? end : NULL);
         return FILTER(status);
     }
     if (str_starts_with(classtag, "\"class\":\"ATT\"")) {
@@ -959,12 +1261,30 @@ int libgps_json_unpack(const char *buf,
     }
 #ifdef AIVDM_ENABLE
     if (str_starts_with(classtag, "\"class\":\"AIS\"")) {
+        struct privdata_t *priv = gpsdata->privdata;
+        unsigned int type = json_ais_type(buf);
+
+        if (NULL != priv &&
+            0 != priv->ais_types &&
+            0 == (priv->ais_types & AIS_TYPE_BIT(type))) {
+            /* Not a type the client asked for, step over it unparsed.
+             * The union keeps the last message, but is not reported. */
+            gpsdata->set &= ~UNION_SET;
+            if (NULL != end) {
+                *end = json_object_end(buf);
+            }
+            return 0;
+        }
         status = json_ais_read(buf,
                                gpsdata->dev.path, sizeof(gpsdata->dev.path),
                                &gpsdata->ais, end);
         if (PASS(status)) {
             gpsdata->set &= ~UNION_SET;
             gpsdata->set |= AIS_SET;
+            if (NULL != priv &&
+                NULL != priv->ais_hooks[type]) {
+                priv->ais_hooks[type](gpsdata);
+            }
         }
         return FILTER(status);
     }
@@ -31,6 +31,10 @@
     #endif  // HAVE_WINSOCK2_H
 #endif  // USE_QT
 
+#ifdef HAVE_ZLIB
+    #include <zlib.h>
+#endif  // HAVE_ZLIB
+
 #include "../include/gps.h"
 #include "../include/gpsd.h"          // FIXME: clients chould not use gpsd.h!
 #include "../include/libgps.h"
@@ -98,7 +102,31 @@ int gps_sock_open(const char *host, const char *port,
         }
     }
 #else  // USE_QT
-    {
+    if (str_starts_with(host, GPSD_LOCAL_SOCKET)) {
+        // local data socket, one report per message
+        gps_fd_t sock;
+        const char *path = host + sizeof(GPSD_LOCAL_SOCKET) - 1;
+
+        sock = netlib_localsocket(path, SOCK_SEQPACKET);
+        if (0 > sock) {
+            gpsdata->gps_fd = PLACEHOLDING_FD;
+            libgps_debug_trace((DEBUG_CALLS,
+                               "netlib_localsocket(%s) returns error %d\n",
+                               path, sock));
+            return -1;
+        }
+        gpsdata->gps_fd = sock;
+        libgps_debug_trace((DEBUG_CALLS,
+            "netlib_localsocket() returns socket on fd %d\n",
+            gpsdata->gps_fd));
+        gpsdata->privdata =
+            (struct privdata_t *)calloc(1, sizeof(struct privdata_t));
+        if (NULL == gpsdata->privdata) {
+            return -1;
+        }
+        PRIVATE(gpsdata)->seqpacket = true;
+        return 0;
+    } else {
         gps_fd_t sock;
 #ifdef HAVE_WINSOCK2_H
         if (need_init) {
@@ -151,9 +179,86 @@ bool gps_sock_waiting(const struct gps_data_t *gpsdata, int timeout)
 #endif  // USE_QT
 }
 
+#ifdef HAVE_ZLIB
+// a compressed stream from the daemon, see "compress" in ?WATCH
+struct sock_inflate_t
+{
+    z_stream zs;
+    size_t pending;                     // bytes in in[] not inflated yet
+    unsigned char in[GPS_JSON_RESPONSE_MAX * 2];
+};
+
+/* inflate what is pending into the free end of the buffer
+ *
+ * Returns: the number of bytes added, -1 if the stream is corrupt
+ */
+static ssize_t sock_inflate(struct gps_data_t *gpsdata)
+{
+    struct privdata_t *priv = PRIVATE(gpsdata);
+    struct sock_inflate_t *inf = priv->inflate;
+    size_t room = sizeof(priv->buffer) - (size_t)priv->waiting;
+    int status;
+
+    if (0 == inf->pending ||
+        0 == room) {
+        return 0;
+    }
+    inf->zs.next_in = inf->in;
+    inf->zs.avail_in = (uInt)inf->pending;
+    inf->zs.next_out = (Bytef *)priv->buffer + priv->waiting;
+    inf->zs.avail_out = (uInt)room;
+    status = inflate(&inf->zs, Z_SYNC_FLUSH);
+    if (Z_OK != status &&
+        Z_BUF_ERROR != status) {
+        libgps_debug_trace((DEBUG_CALLS, "inflate() returns %d\n", status));
+        return -1;
+    }
+    inf->pending = inf->zs.avail_in;
+    memmove(inf->in, inf->zs.next_in, inf->pending);
+    return (ssize_t)(room - inf->zs.avail_out);
+}
+
+/* the daemon compresses all after its WATCH reply, starting with what
+ * is still in the buffer
+ *
+ * Returns: true on success
+ */
+static bool sock_inflate_start(struct gps_data_t *gpsdata)
+{
+    struct privdata_t *priv = PRIVATE(gpsdata);
+    struct sock_inflate_t *inf =
+        (struct sock_inflate_t *)calloc(1, sizeof(struct sock_inflate_t));
+    ssize_t got;
+
+    if (NULL == inf) {
+        return false;
+    }
+    if (Z_OK != inflateInit(&inf->zs)) {
+        free(inf);
+        return false;
+    }
+    priv->inflate = inf;
+    inf->pending = (size_t)priv->waiting;
+    memcpy(inf->in, priv->buffer, inf->pending);
+    priv->waiting = 0;
+    got = sock_inflate(gpsdata);
+    if (0 > got) {
+        return false;
+    }
+    priv->waiting = got;
+    return true;
+}
+#endif  // HAVE_ZLIB
+
 // close a gpsd connection
 int gps_sock_close(struct gps_data_t *gpsdata)
 {
+#ifdef HAVE_ZLIB
+    if (NULL != PRIVATE(gpsdata)->inflate) {
+        (void)inflateEnd(&PRIVATE(gpsdata)->inflate->zs);
+        free(PRIVATE(gpsdata)->inflate);
+    }
+#endif  // HAVE_ZLIB
     free(PRIVATE(gpsdata));
     gpsdata->privdata = NULL;
 #ifdef USE_QT
@@ -177,6 +282,45 @@ int gps_sock_close(struct gps_data_t *gpsdata)
 #endif  // USE_QT
 }
 
+#ifndef USE_QT
+/* read one message from the local SOCK_SEQPACKET data socket
+ *
+ * The daemon sends each report as one message, so there is no
+ * line scanning, and nothing is ever left over for the next call.
+ */
+static int gps_seqpacket_read(struct gps_data_t *gpsdata, char *message,
+                              int message_len)
+{
+    ssize_t status;
+    int unpacked;
+
+    status = recv(gpsdata->gps_fd, PRIVATE(gpsdata)->buffer,
+                  sizeof(PRIVATE(gpsdata)->buffer) - 1, 0);
+    if (0 > status) {
+        if (EINTR == errno ||
+            EAGAIN == errno ||
+            EWOULDBLOCK == errno) {
+            return 0;
+        }
+        return -1;
+    }
+    if (0 == status ||
+        (ssize_t)sizeof(PRIVATE(gpsdata)->buffer) - 1 <= status) {
+        // disconnect, or a message that may have been truncated
+        return -1;
+    }
+    PRIVATE(gpsdata)->buffer[status] = '\0';
+    if (NULL != message) {
+        strlcpy(message, PRIVATE(gpsdata)->buffer, message_len);
+    }
+    (void)clock_gettime(CLOCK_REALTIME, &gpsdata->online);
+    unpacked = gps_unpack(PRIVATE(gpsdata)->buffer, gpsdata);
+    gpsdata->set |= PACKET_SET;
+
+    return (0 == unpacked) ? (int)status : unpacked;
+}
+#endif  // USE_QT
+
 // wait for and read data being streamed from the daemon
 int gps_sock_read(struct gps_data_t *gpsdata, char *message, int message_len)
 {
@@ -184,10 +328,33 @@ int gps_sock_read(struct gps_data_t *gpsdata, char *message, int message_len)
     ssize_t response_length;
     int status = -1;
     char *eptr;
+    char *dest;
+    size_t room;
+#ifdef HAVE_ZLIB
+    bool compressing;
+#endif  // HAVE_ZLIB
 
     errno = 0;
     gpsdata->set &= ~PACKET_SET;
 
+#ifndef USE_QT
+    if (PRIVATE(gpsdata)->seqpacket) {
+        return gps_seqpacket_read(gpsdata, message, message_len);
+    }
+#endif  // USE_QT
+
+#ifdef HAVE_ZLIB
+    if (NULL != PRIVATE(gpsdata)->inflate) {
+        // what the buffer had no room for last time
+        ssize_t got = sock_inflate(gpsdata);
+
+        if (0 > got) {
+            return -1;
+        }
+        PRIVATE(gpsdata)->waiting += got;
+    }
+#endif  // HAVE_ZLIB
+
     // scan to find end of message (\n), or end of buffer
     eol = PRIVATE(gpsdata)->buffer;
     eptr = eol + PRIVATE(gpsdata)->waiting;
@@ -203,17 +370,24 @@ int gps_sock_read(struct gps_data_t *gpsdata, char *message, int message_len)
             // buffer is full but still didn't get a message
             return -1;
         }
+        dest = PRIVATE(gpsdata)->buffer + PRIVATE(gpsdata)->waiting;
+        room = sizeof(PRIVATE(gpsdata)->buffer) - PRIVATE(gpsdata)->waiting;
+#ifdef HAVE_ZLIB
+        if (NULL != PRIVATE(gpsdata)->inflate) {
+            // compressed, read behind what is pending
+            struct sock_inflate_t *inf = PRIVATE(gpsdata)->inflate;
+
+            dest = (char *)inf->in + inf->pending;
+            room = sizeof(inf->in) - inf->pending;
+        }
+#endif  // HAVE_ZLIB
 
 #ifdef USE_QT
         status =
-            ((QTcpSocket *)(gpsdata->gps_fd))->read(PRIVATE(gpsdata)->buffer +
-                 PRIVATE(gpsdata)->waiting,
-                 sizeof(PRIVATE(gpsdata)->buffer) - PRIVATE(gpsdata)->waiting);
+            ((QTcpSocket *)(gpsdata->gps_fd))->read(dest, room);
 #else   // USE_QT
         // read data: return -1 if no data waiting or buffered, 0 otherwise
-        status = (int)recv(gpsdata->gps_fd,
-               PRIVATE(gpsdata)->buffer + PRIVATE(gpsdata)->waiting,
-               sizeof(PRIVATE(gpsdata)->buffer) - PRIVATE(gpsdata)->waiting, 0);
+        status = (int)recv(gpsdata->gps_fd, dest, room, 0);
 #endif  // USE_QT
 
 #ifdef HAVE_WINSOCK2_H
@@ -318,6 +492,17 @@ int gps_sock_read(struct gps_data_t *gpsdata, char *message, int message_len)
         }
 #endif  // USE_QT
 
+#ifdef HAVE_ZLIB
+        if (NULL != PRIVATE(gpsdata)->inflate) {
+            // it goes into the buffer as it inflates
+            PRIVATE(gpsdata)->inflate->pending += status;
+            status = (int)sock_inflate(gpsdata);
+            if (0 > status) {
+                return -1;
+            }
+        }
+#endif  // HAVE_ZLIB
+
         // if we just received data from the socket, it's in the buffer
         PRIVATE(gpsdata)->waiting += status;
 
@@ -337,6 +522,13 @@ int gps_sock_read(struct gps_data_t *gpsdata, char *message, int message_len)
 
     // eol now points to trailing \n in a full message
     *eol = '\0';
+#ifdef HAVE_ZLIB
+    // all after the WATCH reply that says so is compressed
+    compressing = str_starts_with(PRIVATE(gpsdata)->buffer,
+                                  "{\"class\":\"WATCH\"") &&
+                  NULL != strstr(PRIVATE(gpsdata)->buffer,
+                                 "\"compress\":\"deflate\"");
+#endif  // HAVE_ZLIB
     if (NULL != message) {
         strlcpy(message, PRIVATE(gpsdata)->buffer, message_len);
     }
@@ -374,6 +566,13 @@ int gps_sock_read(struct gps_data_t *gpsdata, char *message, int message_len)
                 PRIVATE(gpsdata)->buffer + response_length,
                 PRIVATE(gpsdata)->waiting);
     }
+#ifdef HAVE_ZLIB
+    if (compressing &&
+        NULL == PRIVATE(gpsdata)->inflate &&
+        !sock_inflate_start(gpsdata)) {
+        return -1;
+    }
+#endif  // HAVE_ZLIB
     gpsdata->set |= PACKET_SET;
 
     return (0 == status) ? (int)response_length : status;
@@ -525,6 +724,11 @@ int gps_sock_stream(struct gps_data_t *gpsdata, watch_t flags,
         if (flags & WATCH_PPS) {
             (void)strlcat(buf, ",\"pps\":true", sizeof(buf));
         }
+#ifdef HAVE_ZLIB
+        if (flags & WATCH_DEFLATE) {
+            (void)strlcat(buf, ",\"compress\":\"deflate\"", sizeof(buf));
+        }
+#endif  // HAVE_ZLIB
         if (flags & WATCH_DEVICE) {
             str_appendf(buf, sizeof(buf), ",\"device\":\"%s\"", d);
         }
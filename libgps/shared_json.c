@@ -18,8 +18,11 @@ PERMISSIONS
 #include "../include/gpsd_config.h"  // must be before all includes
 
 #ifdef SOCKET_EXPORT_ENABLE
+#include <ctype.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../include/gpsd.h"
 #include "../include/gps_json.h"
@@ -168,6 +171,208 @@ char *json_policy_to_watch(struct gps_policy_t *ccp,
     return outbuf;
 }
 
+/* Return the end of the JSON value at buf, after any leading space:
+ * one past its closing quote, bracket or brace, or past the last
+ * character of a number or literal.  buf if there is no value there.
+ * Only skips, does not validate.
+ */
+const char *json_value_end(const char *buf)
+{
+    const char *cp = buf;
+    int depth = 0;
+    bool instring = false;
+
+    while (isspace((unsigned char)*cp)) {
+        cp++;
+    }
+    if ('"' != *cp &&
+        '{' != *cp &&
+        '[' != *cp) {
+        // number, true, false or null
+        while ('\0' != *cp &&
+               ',' != *cp &&
+               '}' != *cp &&
+               ']' != *cp &&
+               !isspace((unsigned char)*cp)) {
+            cp++;
+        }
+        return cp;
+    }
+    for (; '\0' != *cp; cp++) {
+        if (instring) {
+            if ('\\' == *cp &&
+                '\0' != cp[1]) {
+                cp++;
+            } else if ('"' == *cp) {
+                instring = false;
+                if (0 == depth) {
+                    return cp + 1;
+                }
+            }
+            continue;
+        }
+        if ('"' == *cp) {
+            instring = true;
+        } else if ('{' == *cp ||
+                   '[' == *cp) {
+            depth++;
+        } else if (('}' == *cp ||
+                    ']' == *cp) &&
+                   0 == --depth) {
+            return cp + 1;
+        }
+    }
+    return cp;
+}
+
+/* Split the JSON object at buf into its members, as spans of buf, at
+ * most max of them.  Set *end, if not NULL, past the closing brace.
+ * Return the number of members, or -1 if buf does not hold an object
+ * or it has more than max.  Keys with escapes are not supported, gpsd
+ * does not send any.
+ */
+int json_object_members(const char *buf, struct json_member_t *members,
+                        int max, const char **end)
+{
+    const char *cp = buf;
+    int n = 0;
+
+    while (isspace((unsigned char)*cp)) {
+        cp++;
+    }
+    if ('{' != *cp++) {
+        return -1;
+    }
+    for (;;) {
+        const char *key;
+
+        while (isspace((unsigned char)*cp) ||
+               ',' == *cp) {
+            cp++;
+        }
+        if ('}' == *cp) {
+            cp++;
+            break;
+        }
+        if ('"' != *cp ||
+            max <= n) {
+            return -1;
+        }
+        key = ++cp;
+        while ('"' != *cp) {
+            if ('\0' == *cp) {
+                return -1;
+            }
+            cp++;
+        }
+        members[n].key = key;
+        members[n].keylen = (size_t)(cp - key);
+        cp++;
+        while (isspace((unsigned char)*cp)) {
+            cp++;
+        }
+        if (':' != *cp++) {
+            return -1;
+        }
+        while (isspace((unsigned char)*cp)) {
+            cp++;
+        }
+        members[n].value = cp;
+        cp = json_value_end(cp);
+        if (cp == members[n].value) {
+            return -1;
+        }
+        members[n].valuelen = (size_t)(cp - members[n].value);
+        n++;
+    }
+    if (NULL != end) {
+        *end = cp;
+    }
+    return n;
+}
+
+/* Split the JSON array at buf into its elements, as spans of buf in
+ * the value members of elements, keys NULL, at most max of them.  Set
+ * *end, if not NULL, past the closing bracket.  Return the number of
+ * elements, or -1 if buf does not hold an array or it has more than max.
+ */
+int json_array_members(const char *buf, struct json_member_t *elements,
+                       int max, const char **end)
+{
+    const char *cp = buf;
+    int n = 0;
+
+    while (isspace((unsigned char)*cp)) {
+        cp++;
+    }
+    if ('[' != *cp++) {
+        return -1;
+    }
+    for (;;) {
+        while (isspace((unsigned char)*cp) ||
+               ',' == *cp) {
+            cp++;
+        }
+        if (']' == *cp) {
+            cp++;
+            break;
+        }
+        if ('\0' == *cp ||
+            max <= n) {
+            return -1;
+        }
+        elements[n].key = NULL;
+        elements[n].keylen = 0;
+        elements[n].value = cp;
+        cp = json_value_end(cp);
+        if (cp == elements[n].value) {
+            return -1;
+        }
+        elements[n].valuelen = (size_t)(cp - elements[n].value);
+        n++;
+    }
+    if (NULL != end) {
+        *end = cp;
+    }
+    return n;
+}
+
+// true if member is the key named name
+bool json_member_is(const struct json_member_t *member, const char *name)
+{
+    return 0 == strncmp(member->key, name, member->keylen) &&
+           '\0' == name[member->keylen];
+}
+
+/* Identify the SKY satellite object at buf by its PRN, gnssid, svid
+ * and sigid, missing ones taken as 0.  Return the four packed, 16 bits
+ * each, PRN on top, so no two satellites gpsd can report share an id.
+ * Return 0 if buf is not an object.
+ */
+uint64_t json_sat_id(const char *buf)
+{
+    struct json_member_t members[JSON_SAT_MEMBERS_MAX];
+    int n = json_object_members(buf, members, JSON_SAT_MEMBERS_MAX, NULL);
+    uint64_t prn = 0, gnssid = 0, svid = 0, sigid = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        uint64_t value = strtoull(members[i].value, NULL, 10);
+
+        if (json_member_is(&members[i], "PRN")) {
+            prn = value;
+        } else if (json_member_is(&members[i], "gnssid")) {
+            gnssid = value;
+        } else if (json_member_is(&members[i], "svid")) {
+            svid = value;
+        } else if (json_member_is(&members[i], "sigid")) {
+            sigid = value;
+        }
+    }
+    return ((prn & 0xffff) << 48) | ((gnssid & 0xffff) << 32) |
+           ((svid & 0xffff) << 16) | (sigid & 0xffff);
+}
+
 #endif  // SOCKET_EXPORT_ENABLE
 
 // vim: set expandtab shiftwidth=4
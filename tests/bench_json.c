@@ -0,0 +1,253 @@
+/* bench_json.c - time the libgps JSON reader on big SKY and RAW reports
+ *
+ * Builds reports the way gpsd writes them, the largest a client can
+ * get, and times libgps_json_unpack() on each.  With -a, also reads a
+ * log of AIS JSON, one report per line, and reports messages/s for
+ * all of it and for a client that wants position reports only.  Not a
+ * regression test, the numbers depend on the machine; use it to
+ * compare builds.
+ *
+ * This file is Copyright by the GPSD project
+ * SPDX-License-Identifier: BSD-2-clause
+ */
+
+#include "../include/gpsd_config.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/compiler.h"
+#include "../include/gps.h"
+#include "../include/gps_json.h"
+#include "../include/os_compat.h"      // for strlcpy()
+#include "../include/strfuncs.h"
+#include "../include/timespec.h"
+
+// a SKY with nsat satellites, keys in gpsd's order
+static void build_sky(char *buf, size_t len, int nsat)
+{
+    int i;
+
+    (void)strlcpy(buf, "{\"class\":\"SKY\",\"device\":\"/dev/ttyACM0\","
+                  "\"time\":\"2024-05-01T12:34:56.000Z\",\"xdop\":0.52,"
+                  "\"ydop\":0.61,\"vdop\":0.93,\"tdop\":0.64,\"hdop\":0.80,"
+                  "\"gdop\":1.39,\"pdop\":1.23,\"nSat\":", len);
+    str_appendf(buf, len, "%d,\"uSat\":%d,\"satellites\":[", nsat, nsat / 2);
+    for (i = 0; i < nsat; i++) {
+        str_appendf(buf, len,
+                    "%s{\"PRN\":%d,\"el\":%.1f,\"az\":%.1f,\"ss\":%.1f,"
+                    "\"used\":%s,\"gnssid\":%d,\"svid\":%d,\"sigid\":%d,"
+                    "\"health\":1}",
+                    0 == i ? "" : ",", 1 + i % 200, 5.0 + i % 85,
+                    (double)(i * 7 % 360), 20.0 + i % 30,
+                    0 == i % 2 ? "true" : "false", i % 7, 1 + i % 36,
+                    i % 3);
+    }
+    (void)strlcat(buf, "]}\r\n", len);
+}
+
+// a RAW with nmeas measurements, keys in gpsd's order
+static void build_raw(char *buf, size_t len, int nmeas)
+{
+    int i;
+
+    (void)strlcpy(buf, "{\"class\":\"RAW\",\"device\":\"/dev/ttyACM0\","
+                  "\"time\":1714566896,\"nsec\":0,\"rawdata\":[", len);
+    for (i = 0; i < nmeas; i++) {
+        str_appendf(buf, len,
+                    "%s{\"gnssid\":%d,\"svid\":%d,\"snr\":%d,"
+                    "\"obs\":\"C1C\",\"lli\":0,\"locktime\":%d,"
+                    "\"sigid\":%d,\"pseudorange\":%f,"
+                    "\"carrierphase\":%f,\"doppler\":%f}",
+                    0 == i ? "" : ",", i % 7, 1 + i % 36, 30 + i % 20,
+                    64500 + i, i % 3, 21345678.123456 + i * 1001.5,
+                    112233445.678 + i * 3.25, -1234.567 + i);
+    }
+    (void)strlcat(buf, "]}\r\n", len);
+}
+
+static struct gps_data_t gpsdata;
+
+// return nanoseconds per libgps_json_unpack() of buf
+static double time_unpack(const char *buf, int iterations)
+{
+    struct timespec start, stop, diff;
+    int i;
+
+    // once untimed, and to check it parses at all
+    if (0 != libgps_json_unpack(buf, &gpsdata, NULL)) {
+        (void)fprintf(stderr, "bench_json: report does not parse\n");
+        exit(EXIT_FAILURE);
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        (void)libgps_json_unpack(buf, &gpsdata, NULL);
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &stop);
+    TS_SUB(&diff, &stop, &start);
+    return TSTONS(&diff) * 1e9 / iterations;
+}
+
+static void report(const char *name, const char *buf, int iterations)
+{
+    double ns = time_unpack(buf, iterations);
+    size_t len = strlen(buf);
+
+    (void)printf("%-6s %6zu bytes %10.0f ns/report %8.1f MB/s\n",
+                 name, len, ns, len * 1e3 / ns);
+}
+
+#ifdef AIVDM_ENABLE
+static unsigned long hooked;
+
+static void count_hook(struct gps_data_t *gpsdata UNUSED)
+{
+    hooked++;
+}
+
+// return nanoseconds per AIS report in the nlines of lines
+static double time_ais(char **lines, int nlines, int iterations)
+{
+    struct timespec start, stop, diff;
+    int i, j;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < nlines; j++) {
+            (void)libgps_json_unpack(lines[j], &gpsdata, NULL);
+        }
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &stop);
+    TS_SUB(&diff, &stop, &start);
+    return TSTONS(&diff) * 1e9 / ((double)iterations * nlines);
+}
+
+// time the AIS JSON log in path, all of it, then position reports only
+static void report_ais(const char *path, int iterations)
+{
+    static char *lines[10000];
+    char line[GPS_JSON_RESPONSE_MAX];
+    int nlines = 0;
+    double ns;
+    FILE *fp = fopen(path, "r");
+    unsigned int type;
+
+    if (NULL == fp) {
+        (void)fprintf(stderr, "bench_json: can't open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    while (NULL != fgets(line, sizeof(line), fp) &&
+           (int)(sizeof(lines) / sizeof(lines[0])) > nlines) {
+        if (NULL != strstr(line, "\"class\":\"AIS\"")) {
+            lines[nlines++] = strdup(line);
+        }
+    }
+    (void)fclose(fp);
+    if (0 == nlines) {
+        (void)fprintf(stderr, "bench_json: no AIS in %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    // a few passes over a long log is plenty
+    iterations = iterations / nlines + 1;
+
+    gpsdata.privdata = calloc(1, sizeof(struct privdata_t));
+    if (NULL == gpsdata.privdata) {
+        exit(EXIT_FAILURE);
+    }
+    ns = time_ais(lines, nlines, iterations);
+    (void)printf("AIS    %6d lines %10.0f ns/report %8.0f msgs/s all\n",
+                 nlines, ns, 1e9 / ns);
+
+    (void)gps_ais_filter(&gpsdata, AIS_TYPE_BIT(1) | AIS_TYPE_BIT(2) |
+                         AIS_TYPE_BIT(3) | AIS_TYPE_BIT(18) |
+                         AIS_TYPE_BIT(19));
+    for (type = 1; type <= AIS_TYPE_MAX; type++) {
+        (void)gps_ais_hook(&gpsdata, type, count_hook);
+    }
+    hooked = 0;
+    ns = time_ais(lines, nlines, iterations);
+    (void)printf("AIS    %6d lines %10.0f ns/report %8.0f msgs/s "
+                 "positions, %lu hooked\n",
+                 nlines, ns, 1e9 / ns, hooked / iterations);
+}
+#endif  // AIVDM_ENABLE
+
+int main(int argc, char *argv[])
+{
+    static char buf[GPS_JSON_RESPONSE_MAX * 4];
+    const char *aislog = NULL;
+    int option;
+    int iterations = 20000;
+    int nsat = MAXCHANNELS;
+    int nmeas = MAXCHANNELS;
+
+    while (-1 != (option = getopt(argc, argv, "a:hi:r:s:V?"))) {
+        switch (option) {
+        case 'a':
+            aislog = optarg;
+            break;
+        case 'i':
+            iterations = atoi(optarg);
+            break;
+        case 'r':
+            nmeas = atoi(optarg);
+            break;
+        case 's':
+            nsat = atoi(optarg);
+            break;
+        case '?':
+            FALLTHROUGH
+        case 'h':
+            FALLTHROUGH
+        default:
+            (void)fprintf(stderr,
+                        "usage: %s [-a log] [-i iter] [-r meas] [-s sats] "
+                        "[-V]\n"
+                        "       -a log      also time AIS JSON from log\n"
+                        "       -i iter     reports to parse per kind\n"
+                        "       -r meas     RAW measurements\n"
+                        "       -s sats     SKY satellites\n"
+                        "       -V          Print version and exit\n",
+                        argv[0]);
+            exit(EXIT_FAILURE);
+        case 'V':
+            (void)fprintf(stderr, "%s: %s (revision %s)\n",
+                          argv[0], VERSION, REVISION);
+            exit(EXIT_SUCCESS);
+        }
+    }
+    if (0 >= iterations ||
+        0 > nsat || MAXCHANNELS < nsat ||
+        0 > nmeas || MAXCHANNELS < nmeas) {
+        (void)fprintf(stderr, "bench_json: out of range, max %d\n",
+                      MAXCHANNELS);
+        exit(EXIT_FAILURE);
+    }
+
+    (void)strlcpy(buf, "{\"class\":\"TPV\",\"device\":\"/dev/ttyACM0\","
+                  "\"mode\":3,\"time\":\"2024-05-01T12:34:56.000Z\","
+                  "\"ept\":0.005,\"lat\":44.068263,\"lon\":-121.314253,"
+                  "\"altHAE\":1128.900,\"altMSL\":1150.700,"
+                  "\"epx\":2.468,\"epy\":3.152,\"epv\":5.520,"
+                  "\"track\":123.4567,\"speed\":0.011,\"climb\":0.001,"
+                  "\"eps\":0.63,\"epc\":11.04}\r\n", sizeof(buf));
+    report("TPV", buf, iterations);
+    build_sky(buf, sizeof(buf), nsat);
+    report("SKY", buf, iterations);
+    build_raw(buf, sizeof(buf), nmeas);
+    report("RAW", buf, iterations);
+    if (NULL != aislog) {
+#ifdef AIVDM_ENABLE
+        report_ais(aislog, iterations);
+#else
+        (void)fprintf(stderr, "bench_json: no AIVDM support\n");
+#endif  // AIVDM_ENABLE
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+// vim: set expandtab shiftwidth=4
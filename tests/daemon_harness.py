@@ -0,0 +1,108 @@
+# This code runs compatibly under Python 2 and 3.x for x >= 2.
+# Preserve this property!
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Shared scaffolding for the tests that run a gpsd and talk to it.
+
+gps.fake does the heavy lifting: DaemonInstance runs the daemon,
+FakePTY is the device it reads.  The tests write sentences they make
+up as they go, rather than cycle a log, so Sentences stands in for
+the TestLoad a FakePTY expects.  Client is a gps client that keeps
+every object it reads, and when it read it.
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import os
+import socket
+import time
+
+import gps
+import gps.fake
+
+
+def nmea(body):
+    """Return body as an NMEA sentence, with checksum."""
+    csum = 0
+    for c in body:
+        csum ^= ord(c)
+    return ('$%s*%02X\r\n' % (body, csum)).encode('ascii')
+
+
+def rmc(epoch, date='010524', lat='4630.000'):
+    """Return a GPRMC sentence, epoch seconds after midnight."""
+    return nmea('GPRMC,%02d%02d%02d.00,A,%s,N,00715.000,E,0.5,45.0,'
+                '%s,,,A' % (epoch // 3600 % 24, epoch // 60 % 60,
+                            epoch % 60, lat, date))
+
+
+class Sentences(object):
+    """A test load with no log behind it, for gps.fake.FakePTY."""
+
+    def __init__(self, name='made up', sentences=None):
+        self.name = name
+        self.sentences = sentences or []
+        self.serial = None
+        self.delay = 0
+
+
+def fake_pty(load=None):
+    """Return a gps.fake.FakePTY, gpsd reads its byname."""
+    return gps.fake.FakePTY(load or Sentences())
+
+
+class Daemon(gps.fake.DaemonInstance):
+    """A gpsd on a port of its own that does not probe its devices."""
+
+    def __init__(self, program):
+        """Run program, the gpsd under test, on a free port."""
+        self.port = gps.fake.freeport()
+        tmpdir = os.environ.get('TMPDIR', '/tmp')
+        # a test may run more than one daemon
+        gps.fake.DaemonInstance.__init__(
+            self, '%s/gpsfake-%d-%d.sock' % (tmpdir, os.getpid(), self.port))
+        # spawn_sub() looks here first
+        os.environ['GPSD_HOME'] = os.path.dirname(os.path.abspath(program))
+
+    def start(self, devices, options=''):
+        """Start it reading devices, return when it is ready."""
+        self.spawn(' '.join(['-n', options] + devices), self.port,
+                   background=True)
+        self.wait_ready()
+
+
+class Client(gps.gps):
+    """A client of a Daemon, collecting (time read, object) pairs."""
+
+    def __init__(self, port, command=None):
+        """Connect, gpsd may not listen yet, then send command."""
+        deadline = time.time() + 5
+        while True:
+            try:
+                gps.gps.__init__(self, port=port)
+                break
+            except socket.error:
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.1)
+        self.objects = []
+        if command:
+            self.send(command)
+
+    def poll(self, timeout=0):
+        """Collect what is ready within timeout seconds."""
+        ready = self.waiting(timeout)
+        while ready:
+            if 0 > self.read():
+                return
+            if self.response.startswith('{'):
+                self.objects.append((time.time(), self.data))
+            ready = self.waiting(0)
+
+    def reports(self, cls):
+        """Return the objects of class cls read so far."""
+        return [o for _, o in self.objects if cls == o['class']]
+
+# vim: set expandtab shiftwidth=4
@@ -0,0 +1,132 @@
+#!/usr/bin/env python
+#
+# This code runs compatibly under Python 2 and 3.x for x >= 2.
+# Preserve this property!
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Test the ?WATCH AIS area filter and aisinterval on a large fleet.
+
+A gpsd, read-only so it sends no probes, reads made up AIVDM from a
+pty: a position from each of many vessels, half inside the client's
+aisbox, then static data (type 24 part A) from all, then positions
+again.  The client must get one position and the static data of each
+vessel inside, the second position held back by aisinterval, and
+nothing from the vessels outside.
+
+usage: test_ais_filter.py [path to gpsd]
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import sys
+import time
+
+from daemon_harness import Client, Daemon, fake_pty, nmea
+
+GPSD = sys.argv[1] if 1 < len(sys.argv) else 'gpsd/gpsd'
+VESSELS = 400           # inside the box, as many again outside
+FIRST = 230000000       # MMSI of the first
+BATCH = 20              # sentences written between client reads
+
+
+def aivdm(fields):
+    """Return (width, value) pairs as a !AIVDM sentence."""
+    bits = ''.join(format(value & ((1 << width) - 1), '0%db' % width)
+                   for width, value in fields)
+    fill = -len(bits) % 6
+    bits += '0' * fill
+    payload = ''
+    for i in range(0, len(bits), 6):
+        c = int(bits[i:i + 6], 2)
+        payload += chr(c + 48 if 40 > c else c + 56)
+    return b'!' + nmea('AIVDM,1,1,,A,%s,%d' % (payload, fill))[1:]
+
+
+def position(mmsi, lat, lon):
+    """Return a type 1 position report."""
+    return aivdm([(6, 1), (2, 0), (30, mmsi), (4, 0), (8, -128),
+                  (10, 0), (1, 0), (28, int(lon * 600000)),
+                  (27, int(lat * 600000)), (12, 3600), (9, 511),
+                  (6, 60), (2, 0), (3, 0), (1, 0), (19, 0)])
+
+
+def static(mmsi):
+    """Return a type 24 part A, its shipname from mmsi."""
+    name = 'V%d' % mmsi
+    chars = [(6, ord(c) & 0x3f) for c in name.ljust(20, '@')]
+    return aivdm([(6, 24), (2, 0), (30, mmsi), (2, 0)] + chars + [(8, 0)])
+
+
+def fleet():
+    """Return (mmsi, lat, lon, inside) of each vessel."""
+    vessels = []
+    for i in range(VESSELS):
+        vessels.append((FIRST + 2 * i, 45.0 + i / 1000.0, 7.0, True))
+        vessels.append((FIRST + 2 * i + 1, 55.0 + i / 1000.0, 7.0, False))
+    return vessels
+
+
+def send(device, client, sentences):
+    """Write sentences to the pty, letting the client read in between."""
+    for i in range(0, len(sentences), BATCH):
+        for sentence in sentences[i:i + BATCH]:
+            device.write(sentence)
+        client.poll(0.02)
+
+
+def main():
+    """Run it."""
+    errors = 0
+    device = fake_pty()
+    vessels = fleet()
+
+    daemon = Daemon(GPSD)
+    daemon.start([device.byname])
+    try:
+        # input is flushed while gpsd settles the port, so feed a
+        # position until a watcher sees it decoded
+        watcher = Client(daemon.port, '?WATCH={"enable":true,"json":true};')
+        deadline = time.time() + 10
+        while time.time() < deadline and not watcher.reports('AIS'):
+            device.write(position(FIRST - 1, 0.0, 0.0))
+            watcher.poll(0.2)
+        if not watcher.reports('AIS'):
+            print('ais_filter: gpsd decoded no AIS')
+            sys.exit(1)
+        watcher.close()
+
+        client = Client(daemon.port,
+                        '?WATCH={"enable":true,"json":true,"split24":true,'
+                        '"aisbox":[40,0,50,10],"aisinterval":600};')
+        time.sleep(0.5)
+        send(device, client, [position(m, lat, lon)
+                              for m, lat, lon, _ in vessels])
+        send(device, client, [static(m) for m, _, _, _ in vessels])
+        send(device, client, [position(m, lat, lon)
+                              for m, lat, lon, _ in vessels])
+        client.poll(1)
+
+        reports = client.reports('AIS')
+        for mmsi, _, _, inside in vessels:
+            types = [r['type'] for r in reports if mmsi == r['mmsi']]
+            want = [1, 24] if inside else []
+            if want != types:
+                print('ais_filter: vessel %d, %s, sent %s, want %s'
+                      % (mmsi, 'inside' if inside else 'outside',
+                         types, want))
+                errors += 1
+    finally:
+        daemon.kill()
+
+    if errors:
+        print('test_ais_filter.py: %d errors' % errors)
+        sys.exit(1)
+    sys.exit(0)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4
@@ -0,0 +1,126 @@
+#!/usr/bin/env python
+#
+# This code runs compatibly under Python 2 and 3.x for x >= 2.
+# Preserve this property!
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Test ?AIS, the daemon's snapshot of the AIS vessels it has heard.
+
+A gpsd, read-only so it sends no probes, reads test/sample.aivdm from
+a pty before any client connects.
+A late client then asks ?AIS, and checks it gets each vessel once,
+closed by an AISSNAP object, and that its WATCH AIS filters apply.
+
+usage: test_ais_snapshot.py [path to gpsd] [AIVDM sample]
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import sys
+import time
+
+import gps.fake
+from daemon_harness import Client, Daemon, fake_pty
+
+GPSD = sys.argv[1] if 1 < len(sys.argv) else 'gpsd/gpsd'
+SAMPLE = sys.argv[2] if 2 < len(sys.argv) else 'test/sample.aivdm'
+# senders in the sample: type 1, type 5, and type 5 twice
+MMSI = 371798000
+MMSI5 = 351759000
+MMSI55 = 271010059
+
+
+def snapshot(client, command, timeout=5):
+    """Send command then ?AIS, return the AIS objects and AISSNAP."""
+    client.objects = []
+    client.send(command + '?AIS;')
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        client.poll(0.05)
+        snap = client.reports('AISSNAP')
+        if snap:
+            # live reports carry a device, snapshot ones do not
+            return ([r for r in client.reports('AIS')
+                     if 'device' not in r], snap[0])
+    return [], None
+
+
+def main():
+    """Run it."""
+    errors = 0
+    load = gps.fake.TestLoad(SAMPLE)
+    device = fake_pty(load)
+
+    daemon = Daemon(GPSD)
+    daemon.start([device.byname])
+    try:
+        # input is flushed while gpsd settles the port, so feed the
+        # first sentence until a watcher sees it decoded
+        watcher = Client(daemon.port, '?WATCH={"enable":true,"json":true};')
+        deadline = time.time() + 10
+        while time.time() < deadline and not watcher.reports('AIS'):
+            device.write(load.sentences[0])
+            watcher.poll(0.2)
+        watcher.close()
+        for sentence in load.sentences:
+            device.write(sentence)
+            time.sleep(0.002)
+        time.sleep(1)
+
+        client = Client(daemon.port)
+        reports, snap = snapshot(client, '')
+        mmsis = set(r['mmsi'] for r in reports)
+        if snap is None:
+            print('ais: no AISSNAP')
+            errors += 1
+        elif snap['vessels'] != len(mmsis) or 10 > len(mmsis):
+            print('ais: AISSNAP says %d vessels, %d sent'
+                  % (snap['vessels'], len(mmsis)))
+            errors += 1
+        for mmsi in mmsis:
+            kinds = [r['type'] for r in reports if mmsi == r['mmsi']]
+            static = [t for t in kinds if t in (5, 24)]
+            if 1 < len(static) or len(kinds) - len(static) > 1:
+                print('ais: vessel %d sent as %s' % (mmsi, kinds))
+                errors += 1
+        for mmsi, want in ((MMSI, [1]), (MMSI5, [5]), (MMSI55, [5])):
+            got = [r['type'] for r in reports if mmsi == r['mmsi']]
+            if want != got:
+                print('ais: vessel %d sent as %s, want %s'
+                      % (mmsi, got, want))
+                errors += 1
+        if ['EVER DIADEM'] != [r['shipname'] for r in reports
+                               if MMSI5 == r['mmsi']]:
+            print('ais: vessel %d lost its name' % MMSI5)
+            errors += 1
+
+        reports, snap = snapshot(
+            client, '?WATCH={"aismmsi":[%d]};' % MMSI)
+        if (snap is None or 1 != snap['vessels'] or
+                set([MMSI]) != set(r['mmsi'] for r in reports)):
+            print('ais: aismmsi filter, got %s'
+                  % [(r['mmsi'], r['type']) for r in reports])
+            errors += 1
+
+        reports, snap = snapshot(
+            client, '?WATCH={"aismmsi":[],"aistype":[5]};')
+        if (snap is None or 2 > len(reports) or
+                set([5]) != set(r['type'] for r in reports)):
+            print('ais: aistype filter, got types %s'
+                  % sorted(set(r['type'] for r in reports)))
+            errors += 1
+    finally:
+        daemon.kill()
+
+    if errors:
+        print('test_ais_snapshot.py: %d errors' % errors)
+        sys.exit(1)
+    sys.exit(0)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4
@@ -0,0 +1,308 @@
+/*
+ * tests for the daemon's AIS vessel table, gpsd/ais_vessels.c: storing
+ * and rebuilding messages, merging type 5 and type 24 static data,
+ * hash collisions, aging and eviction.
+ *
+ * This file is Copyright by the GPSD project
+ * SPDX-License-Identifier: BSD-2-clause
+ */
+
+#include "../include/gpsd_config.h"   // must be before all includes
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/gpsd.h"
+#include "../include/compiler.h"
+#include "../include/strfuncs.h"
+
+#ifdef AIS_VESSELS_ENABLE
+
+static int failures;
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            (void)printf("test_ais_vessels: " __VA_ARGS__);     \
+            (void)printf("\n");                                 \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+static timespec_t at(time_t sec)
+{
+    timespec_t ts = {1700000000 + sec, 0};
+
+    return ts;
+}
+
+static const struct ais_vessel_t *find(unsigned int mmsi, time_t sec)
+{
+    timespec_t now = at(sec);
+    int cursor = 0;
+    const struct ais_vessel_t *vessel;
+
+    while (NULL != (vessel = ais_vessel_next(&cursor, &now))) {
+        if (mmsi == vessel->mmsi) {
+            return vessel;
+        }
+    }
+    return NULL;
+}
+
+static int mmsi_compare(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+
+    return (x > y) - (x < y);
+}
+
+// count the live vessels, and how many of them repeat an MMSI
+static int count(time_t sec, int *dups)
+{
+    static unsigned int mmsi[MAX_AIS_VESSELS];
+    timespec_t now = at(sec);
+    int cursor = 0;
+    int n = 0;
+    int i;
+    const struct ais_vessel_t *vessel;
+
+    while (NULL != (vessel = ais_vessel_next(&cursor, &now)) &&
+           MAX_AIS_VESSELS > n) {
+        mmsi[n++] = vessel->mmsi;
+    }
+    qsort(mmsi, n, sizeof(mmsi[0]), mmsi_compare);
+    *dups = 0;
+    for (i = 1; i < n; i++) {
+        if (mmsi[i - 1] == mmsi[i]) {
+            (*dups)++;
+        }
+    }
+    return n;
+}
+
+static void update(const struct ais_t *ais, time_t sec)
+{
+    timespec_t now = at(sec);
+
+    ais_vessel_update(ais, &now);
+}
+
+static void position(unsigned int mmsi, time_t sec)
+{
+    struct ais_t ais;
+
+    memset(&ais, 0, sizeof(ais));
+    ais.type = 1;
+    ais.mmsi = mmsi;
+    ais.type1.lat = 37 * 600000;
+    ais.type1.lon = -122 * 600000;
+    ais.type1.speed = 123;
+    ais.type1.heading = AIS_HEADING_NOT_AVAILABLE;
+    update(&ais, sec);
+}
+
+static void type5(unsigned int mmsi, const char *shipname,
+                  const char *callsign, unsigned int to_bow, time_t sec)
+{
+    struct ais_t ais;
+
+    memset(&ais, 0, sizeof(ais));
+    ais.type = 5;
+    ais.mmsi = mmsi;
+    ais.type5.imo = 9000001;
+    (void)strlcpy(ais.type5.shipname, shipname, sizeof(ais.type5.shipname));
+    (void)strlcpy(ais.type5.callsign, callsign, sizeof(ais.type5.callsign));
+    (void)strlcpy(ais.type5.destination, "OAKLAND",
+                  sizeof(ais.type5.destination));
+    ais.type5.shiptype = 70;
+    ais.type5.to_bow = to_bow;
+    ais.type5.to_stern = 0 < to_bow ? 50 : 0;
+    update(&ais, sec);
+}
+
+static void type24a(unsigned int mmsi, const char *shipname, time_t sec)
+{
+    struct ais_t ais;
+
+    memset(&ais, 0, sizeof(ais));
+    ais.type = 24;
+    ais.mmsi = mmsi;
+    ais.type24.part = part_a;
+    (void)strlcpy(ais.type24.shipname, shipname,
+                  sizeof(ais.type24.shipname));
+    update(&ais, sec);
+}
+
+static void type24b(unsigned int mmsi, const char *callsign,
+                    unsigned int to_bow, time_t sec)
+{
+    struct ais_t ais;
+
+    memset(&ais, 0, sizeof(ais));
+    ais.type = 24;
+    ais.mmsi = mmsi;
+    ais.type24.part = part_b;
+    ais.type24.shiptype = 37;
+    (void)strlcpy(ais.type24.vendorid, "ABC", sizeof(ais.type24.vendorid));
+    (void)strlcpy(ais.type24.callsign, callsign,
+                  sizeof(ais.type24.callsign));
+    ais.type24.dim.to_bow = to_bow;
+    update(&ais, sec);
+}
+
+static void test_store(void)
+{
+    const struct ais_vessel_t *vessel;
+    struct ais_t ais;
+
+    position(111000001, 0);
+    vessel = find(111000001, 0);
+    CHECK(NULL != vessel, "position report not stored");
+    if (NULL == vessel) {
+        return;
+    }
+    CHECK(ais_vessel_message(vessel, false, &ais) &&
+          1 == ais.type && 111000001 == ais.mmsi &&
+          37 * 600000 == ais.type1.lat && 123 == ais.type1.speed &&
+          AIS_HEADING_NOT_AVAILABLE == ais.type1.heading,
+          "type 1 not rebuilt");
+    CHECK(!ais_vessel_message(vessel, true, &ais) && 0 == ais.type,
+          "static data without a type 5 or 24");
+}
+
+static void test_merge(void)
+{
+    const struct ais_vessel_t *vessel;
+    struct ais_t ais;
+
+    // type 5, then newer type 24 parts: stays a type 5
+    type5(111000002, "FIVE", "F5", 100, 0);
+    type24a(111000002, "", 1);
+    type24b(111000002, "NEWCALL", 0, 2);
+    vessel = find(111000002, 2);
+    CHECK(NULL != vessel &&
+          ais_vessel_message(vessel, true, &ais) &&
+          5 == ais.type &&
+          0 == strcmp(ais.type5.shipname, "FIVE") &&
+          0 == strcmp(ais.type5.callsign, "NEWCALL") &&
+          0 == strcmp(ais.type5.destination, "OAKLAND") &&
+          100 == ais.type5.to_bow && 37 == ais.type5.shiptype &&
+          9000001 == ais.type5.imo,
+          "type 24 after type 5 not folded in field by field");
+
+    // part B before part A, then a part B with no callsign
+    type24b(111000003, "CALL3", 30, 0);
+    type24a(111000003, "TWENTYFOUR", 1);
+    type24b(111000003, "", 31, 2);
+    vessel = find(111000003, 2);
+    CHECK(NULL != vessel &&
+          ais_vessel_message(vessel, true, &ais) &&
+          24 == ais.type && both == ais.type24.part &&
+          0 == strcmp(ais.type24.shipname, "TWENTYFOUR") &&
+          0 == strcmp(ais.type24.callsign, "CALL3") &&
+          0 == strcmp(ais.type24.vendorid, "ABC") &&
+          31 == ais.type24.dim.to_bow,
+          "type 24 parts B, A, B not merged");
+
+    // type 24, then a type 5 missing name and dimensions
+    type24a(111000004, "TWENTYFOUR", 0);
+    type24b(111000004, "CALL4", 40, 1);
+    type5(111000004, "", "", 0, 2);
+    vessel = find(111000004, 2);
+    CHECK(NULL != vessel &&
+          ais_vessel_message(vessel, true, &ais) &&
+          5 == ais.type &&
+          0 == strcmp(ais.type5.shipname, "TWENTYFOUR") &&
+          0 == strcmp(ais.type5.callsign, "CALL4") &&
+          40 == ais.type5.to_bow &&
+          0 == strcmp(ais.type5.destination, "OAKLAND"),
+          "type 5 after type 24 wiped known fields");
+}
+
+/* Many vessels, in runs of four with the same home slot (the hash
+ * keeps the low bits distinct, so MMSIs 2 * MAX_AIS_VESSELS apart
+ * collide), then age out every other one and check the survivors are
+ * still found, not added twice.
+ */
+#define COLLIDING(i) \
+    (200000000 + (i) % 150 + (i) / 150 * 2 * MAX_AIS_VESSELS)
+static void test_collisions(void)
+{
+    int n, dups;
+    unsigned int i;
+
+    for (i = 0; i < 600; i++) {
+        position(COLLIDING(i), 0);
+    }
+    n = count(0, &dups);
+    CHECK(600 + 4 == n, "%d vessels, want %d", n, 600 + 4);
+
+    /* Well past AIS_VESSEL_AGE, refresh the odd ones.  Each update
+     * sweeps two vessels, so the first pass removes most of the stale
+     * ones and the second pass has to find the odd ones again.
+     */
+    for (i = 1; i < 600; i += 2) {
+        position(COLLIDING(i), 1000);
+    }
+    for (i = 1; i < 600; i += 2) {
+        position(COLLIDING(i), 1000);
+    }
+    n = count(1000, &dups);
+    CHECK(300 == n, "%d vessels after aging, want 300", n);
+    CHECK(0 == dups, "%d vessels added twice after aging", dups);
+    CHECK(NULL == find(200000000, 1000), "stale vessel still reported");
+    CHECK(NULL == find(111000002, 1000), "stale vessel still reported");
+    for (i = 1; i < 600; i += 2) {
+        CHECK(NULL != find(COLLIDING(i), 1000),
+              "vessel %u lost after aging", COLLIDING(i));
+    }
+}
+
+// a full table drops the vessel heard from longest ago
+static void test_evict(void)
+{
+    int n, dups;
+    unsigned int i;
+
+    for (i = 0; i <= MAX_AIS_VESSELS; i++) {
+        position(300000000 + i, 2000 + i / 100);
+    }
+    n = count(2000 + MAX_AIS_VESSELS / 100, &dups);
+    CHECK(MAX_AIS_VESSELS == n, "%d vessels, want %d", n, MAX_AIS_VESSELS);
+    CHECK(0 == dups, "%d vessels added twice", dups);
+    CHECK(NULL == find(300000000, 2000 + MAX_AIS_VESSELS / 100),
+          "oldest vessel not evicted from a full table");
+    CHECK(NULL != find(300000000 + MAX_AIS_VESSELS,
+                       2000 + MAX_AIS_VESSELS / 100),
+          "newest vessel not added to a full table");
+}
+
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    test_store();
+    test_merge();
+    test_collisions();
+    test_evict();
+
+    if (0 < failures) {
+        (void)printf("test_ais_vessels: %d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+#else  // AIS_VESSELS_ENABLE
+
+int main(int argc UNUSED, char *argv[] UNUSED)
+{
+    (void)printf("test_ais_vessels: vessel table not built\n");
+    return 0;
+}
+
+#endif  // AIS_VESSELS_ENABLE
+
+// vim: set expandtab shiftwidth=4
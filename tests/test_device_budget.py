@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+#
+# This code runs compatibly under Python 2 and 3.x for x >= 2.
+# Preserve this property!
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Test that one busy device can not starve another in the daemon.
+
+A gpsd, read-only so it sends no probes, reads two ptys.  One gets
+NMEA as fast as the pty takes it, far more packets per main loop pass
+than DEVICE_BUDGET lets through; the other gets a fix ten times a
+second.  A client watching only the slow device checks each of its
+fixes comes through, and soon, then ?LEXER shows both devices with
+their qdelay.
+
+usage: test_device_budget.py [path to gpsd]
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import select
+import sys
+import threading
+import time
+
+from daemon_harness import Client, Daemon, fake_pty, rmc
+
+GPSD = sys.argv[1] if 1 < len(sys.argv) else 'gpsd/gpsd'
+FIXES = 20              # fixes sent to the slow device
+STEP = 0.1              # seconds between them
+LATENCY = 1.0           # most seconds a fix may take to come through
+
+
+def firehose(device, stop):
+    """Write NMEA to device as fast as it takes it, until stop is set."""
+    # a different second in each, so no two look like the same epoch
+    blob = b''.join(rmc(i, '010524') for i in range(1000))
+    while not stop.is_set():
+        _, ready, _ = select.select([], [device.fd], [], 0.1)
+        if ready:
+            device.write(blob[:4096])
+            blob = blob[4096:] + blob[:4096]
+
+
+def main():
+    """Run it."""
+    errors = 0
+    busy = fake_pty()
+    slow = fake_pty()
+    stop = threading.Event()
+    flood = threading.Thread(target=firehose, args=(busy, stop))
+
+    daemon = Daemon(GPSD)
+    daemon.start([busy.byname, slow.byname])
+    try:
+        # input is flushed while gpsd settles the port, so feed fixes
+        # until a watcher sees one decoded
+        watcher = Client(daemon.port, '?WATCH={"enable":true,"json":true,'
+                                      '"device":"%s"};' % slow.byname)
+        epoch = 3600
+        deadline = time.time() + 10
+        while time.time() < deadline and not watcher.reports('TPV'):
+            slow.write(rmc(epoch, '020524'))
+            epoch += 1
+            watcher.poll(0.2)
+        if not watcher.reports('TPV'):
+            print('device_budget: gpsd decoded no fix')
+            sys.exit(1)
+
+        flood.start()
+        time.sleep(0.5)
+        watcher.objects = []
+        sent = {}
+        for _ in range(FIXES):
+            slow.write(rmc(epoch, '020524'))
+            sent['T%02d:%02d:%02d' % (epoch // 3600 % 24, epoch // 60 % 60,
+                                      epoch % 60)] = time.time()
+            epoch += 1
+            watcher.poll(STEP)
+        watcher.poll(LATENCY)
+
+        late = 0
+        seen = 0
+        for when, tpv in watcher.objects:
+            key = tpv.get('time', '')[10:19]
+            if 'TPV' == tpv['class'] and key in sent:
+                seen += 1
+                if when - sent[key] > LATENCY:
+                    late += 1
+        if FIXES - 1 > seen:
+            print('device_budget: %d of %d slow fixes reported'
+                  % (seen, FIXES))
+            errors += 1
+        if late:
+            print('device_budget: %d slow fixes over %.1fs late'
+                  % (late, LATENCY))
+            errors += 1
+
+        # a client watching both devices sees both in ?LEXER
+        lexer = Client(daemon.port, '?WATCH={"enable":true};?LEXER;')
+        deadline = time.time() + 5
+        while time.time() < deadline and 2 > len(lexer.reports('LEXER')):
+            lexer.poll(0.1)
+        stop.set()
+        found = dict((o['path'], o) for o in lexer.reports('LEXER'))
+        for path in (busy.byname, slow.byname):
+            if path not in found or 'qdelay' not in found[path]:
+                print('device_budget: no qdelay for %s in %s'
+                      % (path, sorted(found)))
+                errors += 1
+        if busy.byname in found:
+            busy_packets = found[busy.byname]['accepted'].get('NMEA', 0)
+            slow_packets = found.get(slow.byname, {}).get(
+                'accepted', {}).get('NMEA', 0)
+            if busy_packets < 10 * slow_packets:
+                print('device_budget: busy device sent only %d packets, '
+                      'slow %d' % (busy_packets, slow_packets))
+                errors += 1
+    finally:
+        stop.set()
+        if flood.is_alive():
+            flood.join()
+        daemon.kill()
+
+    if errors:
+        print('test_device_budget.py: %d errors' % errors)
+        sys.exit(1)
+    sys.exit(0)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4
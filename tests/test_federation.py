@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+#
+# This code runs compatibly under Python 2 and 3.x for x >= 2.
+# Preserve this property!
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Test fed://, one gpsd taking decoded epochs from another.
+
+An upstream gpsd reads NMEA from a pty, a downstream gpsd federates
+it.  Checks that every fix a client of the downstream sees is one the
+upstream reported, then restarts the upstream on the same pty and
+checks that the downstream reconnects.
+
+usage: test_federation.py [path to gpsd]
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import sys
+import time
+
+from daemon_harness import Client, Daemon, fake_pty, nmea
+
+GPSD = sys.argv[1] if 1 < len(sys.argv) else 'gpsd/gpsd'
+WATCH = '?WATCH={"enable":true,"json":true};'
+
+
+def epoch(i):
+    """Return the NMEA for epoch i, one second each."""
+    t = '1200%02d.00' % (i % 60)
+    lat = '4404.%04d' % (1000 + i)
+    return (nmea('GPGGA,%s,%s,N,12118.8500,W,1,08,0.9,545.4,M,46.9,M,,'
+                 % (t, lat)) +
+            nmea('GPRMC,%s,A,%s,N,12118.8500,W,000.5,054.7,191124,'
+                 '020.3,E' % (t, lat)) +
+            nmea('GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1'))
+
+
+def fixes(client):
+    """Return the time and latitude of each TPV the client read."""
+    return [(tpv['time'], round(tpv.get('lat', 0), 6))
+            for tpv in client.reports('TPV') if 'time' in tpv]
+
+
+def feed(device, first, count, clients):
+    """Write count epochs to the pty, while the clients listen."""
+    for i in range(first, first + count):
+        device.write(epoch(i))
+        time.sleep(0.1)
+        for client in clients:
+            client.poll()
+
+
+def main():
+    """Run it."""
+    errors = 0
+    device = fake_pty()
+
+    upstream = Daemon(GPSD)
+    upstream.start([device.byname])
+    downstream = Daemon(GPSD)
+    downstream.start(['fed://127.0.0.1:%d:%s' % (upstream.port,
+                                                 device.byname)])
+    try:
+        up = Client(upstream.port, WATCH)
+        down = Client(downstream.port, WATCH)
+        time.sleep(1)
+        feed(device, 0, 20, [up, down])
+        up.poll(0.5)
+        down.poll(0.5)
+        if 10 > len(fixes(down)):
+            print('federation: %d fixes downstream, want 10 or more'
+                  % len(fixes(down)))
+            errors += 1
+        stray = [f for f in fixes(down) if f not in fixes(up)]
+        if stray:
+            print('federation: fixes not seen upstream: %s' % stray)
+            errors += 1
+
+        # the downstream has to find the new upstream on its own
+        upstream.kill()
+        time.sleep(0.5)
+        upstream.start([device.byname])
+        seen = len(fixes(down))
+        deadline = time.time() + 15
+        i = 20
+        while len(fixes(down)) <= seen and time.time() < deadline:
+            feed(device, i, 1, [down])
+            i += 1
+        if len(fixes(down)) <= seen:
+            print('federation: no fixes after the upstream restarted')
+            errors += 1
+    finally:
+        downstream.kill()
+        upstream.kill()
+
+    if errors:
+        print('test_federation.py: %d errors' % errors)
+        sys.exit(1)
+    sys.exit(0)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4
@@ -7,6 +7,7 @@
 #include "../include/gpsd_config.h"
 
 #include <getopt.h>
+#include <math.h>                 // for isfinite()
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -477,6 +478,64 @@ static const struct json_attr_t json_attrs_25[] = {
 
 
 char str32[] = "\f\n\r\t\v";
+
+// Case 37: Ignore array and object values of unknown keys
+
+static char *json_str37 =
+    "{\"class\":\"WATCH\",\"enable\":true,\"aisbox\":[1.5,2,3,4],"
+    "\"nest\":{\"a\":[\"]\",{\"b\":\"}\\\"\"}]},\"json\":true}";
+
+// Case 38: Rebuild delta encoded TPV and SKY on their keyframes
+
+static const char *json_str38a =
+    "{\"class\":\"TPV\",\"device\":\"GPS#1\",\"delta\":false,\"mode\":3,"
+    "\"time\":\"2024-05-01T12:34:56.000Z\",\"lat\":46.5,\"lon\":7.25,"
+    "\"speed\":0.5,\"climb\":0.1}";
+static const char *json_str38b =
+    "{\"class\":\"TPV\",\"device\":\"GPS#1\",\"delta\":true,"
+    "\"time\":\"2024-05-01T12:34:57.000Z\",\"lat\":46.75,"
+    "\"unset\":[\"climb\"]}";
+static const char *json_str38c =
+    "{\"class\":\"SKY\",\"device\":\"GPS#1\",\"delta\":false,\"hdop\":0.9,"
+    "\"nSat\":3,\"uSat\":2,"
+    "\"satellites\":[{\"PRN\":1,\"ss\":40,\"used\":true},"
+    "{\"PRN\":2,\"ss\":35,\"used\":true},"
+    "{\"PRN\":3,\"ss\":20,\"used\":false}]}";
+static const char *json_str38d =
+    "{\"class\":\"SKY\",\"device\":\"GPS#1\",\"delta\":true,"
+    "\"satellites\":[{\"PRN\":2,\"ss\":33,\"used\":true},"
+    "{\"PRN\":4,\"ss\":25,\"used\":false}],"
+    "\"gone\":[{\"PRN\":1,\"gnssid\":0,\"svid\":0,\"sigid\":0}]}";
+
+// Case 39: Read the per-class report intervals of ?WATCH
+
+static const char *json_str39 =
+    "{\"class\":\"WATCH\",\"enable\":true,\"json\":true,"
+    "\"tpvinterval\":1.5,\"gstinterval\":10,\"latest\":true}";
+
+// Case 40: Bad intervals and settings clear them all
+
+static const char *json_str40a =
+    "{\"class\":\"WATCH\",\"tpvinterval\":2,\"skyinterval\":-1}";
+static const char *json_str40b =
+    "{\"class\":\"WATCH\",\"tpvinterval\":2,\"delta\":true,"
+    "\"keyframe\":0}";
+static const char *json_str40c =
+    "{\"class\":\"WATCH\",\"tpvinterval\":2,\"compress\":\"lzma\"}";
+
+// Case 41: Delta SKY satellites with PRN over 255 and sigid over 15
+
+static const char *json_str41a =
+    "{\"class\":\"SKY\",\"device\":\"GPS#1\",\"delta\":false,\"nSat\":3,"
+    "\"satellites\":["
+    "{\"PRN\":300,\"gnssid\":3,\"svid\":20,\"sigid\":0,\"ss\":30},"
+    "{\"PRN\":300,\"gnssid\":3,\"svid\":20,\"sigid\":16,\"ss\":31},"
+    "{\"PRN\":44,\"gnssid\":3,\"svid\":20,\"sigid\":0,\"ss\":32}]}";
+static const char *json_str41b =
+    "{\"class\":\"SKY\",\"device\":\"GPS#1\",\"delta\":true,\"nSat\":2,"
+    "\"satellites\":["
+    "{\"PRN\":300,\"gnssid\":3,\"svid\":20,\"sigid\":16,\"ss\":45}],"
+    "\"gone\":[{\"PRN\":44,\"gnssid\":3,\"svid\":20,\"sigid\":0}]}";
 // *INDENT-ON*
 
 static void jsontest(int i)
@@ -487,6 +546,7 @@ static void jsontest(int i)
     char *pbuf;
     struct timespec expected_ts;
     double d;
+    struct watch_rate_t rates;
 
     if (0 < debug) {
         (void)fprintf(stderr, "Running test #%d.\n", i);
@@ -897,7 +957,111 @@ static void jsontest(int i)
         }
         break;
 
-#define MAXTEST 36
+    case 37:
+        enable = json = false;
+        status = json_read_object(json_str37, json_attrs_19, NULL);
+        assert_case(status);
+        assert_boolean("enable", enable, true);
+        assert_boolean("json", json, true);
+        break;
+
+    case 38:
+        gpsdata.privdata = calloc(1, sizeof(struct privdata_t));
+        if (NULL == gpsdata.privdata) {
+            exit(EXIT_FAILURE);
+        }
+        status = libgps_json_unpack(json_str38a, &gpsdata, NULL);
+        assert_case(status);
+        status = libgps_json_unpack(json_str38b, &gpsdata, NULL);
+        assert_case(status);
+        assert_int("mode", "t_integer", gpsdata.fix.mode, 3);
+        assert_real("lat", gpsdata.fix.latitude, 46.75);
+        assert_real("lon", gpsdata.fix.longitude, 7.25);
+        assert_real("speed", gpsdata.fix.speed, 0.5);
+        assert_other("climb", 0 != isfinite(gpsdata.fix.climb), 0);
+
+        status = libgps_json_unpack(json_str38c, &gpsdata, NULL);
+        assert_case(status);
+        status = libgps_json_unpack(json_str38d, &gpsdata, NULL);
+        assert_case(status);
+        assert_real("hdop", gpsdata.dop.hdop, 0.9);
+        assert_int("satellites", "t_integer", gpsdata.satellites_visible, 3);
+        assert_int("PRN[0]", "t_short", gpsdata.skyview[0].PRN, 2);
+        assert_real("ss[0]", gpsdata.skyview[0].ss, 33);
+        assert_int("PRN[1]", "t_short", gpsdata.skyview[1].PRN, 3);
+        assert_int("PRN[2]", "t_short", gpsdata.skyview[2].PRN, 4);
+        free(gpsdata.privdata);
+        gpsdata.privdata = NULL;
+        break;
+
+    case 39:
+        status = json_watch_rate_read(json_str39, &rates, NULL);
+        assert_case(status);
+        assert_boolean("active", rates.active, true);
+        assert_boolean("latest", rates.latest, true);
+        assert_real("tpvinterval", rates.interval[RATE_TPV], 1.5);
+        assert_real("gstinterval", rates.interval[RATE_GST], 10);
+        assert_real("skyinterval", rates.interval[RATE_SKY], 0);
+        assert_boolean("delta", rates.delta, false);
+        assert_int("keyframe", "t_integer", rates.keyframe, DELTA_KEYFRAME);
+        buffer[0] = '\0';
+        json_watch_rate_dump(&rates, buffer, sizeof(buffer));
+        assert_string1("dump", buffer,
+                       ",\"tpvinterval\":1.500,\"gstinterval\":10.000,"
+                       "\"latest\":true");
+
+        // a WATCH without the keys turns them off
+        status = json_watch_rate_read(json_str37, &rates, NULL);
+        assert_case(status);
+        assert_boolean("active", rates.active, false);
+        assert_real("tpvinterval", rates.interval[RATE_TPV], 0);
+        break;
+
+    case 40:
+        status = json_watch_rate_read(json_str40a, &rates, NULL);
+        assert_int("status", "t_integer", status, JSON_ERR_MISC);
+        assert_boolean("active", rates.active, false);
+        assert_real("tpvinterval", rates.interval[RATE_TPV], 0);
+
+        status = json_watch_rate_read(json_str40b, &rates, NULL);
+        assert_int("status", "t_integer", status, JSON_ERR_MISC);
+        assert_boolean("delta", rates.delta, false);
+        assert_real("tpvinterval", rates.interval[RATE_TPV], 0);
+
+        status = json_watch_rate_read(json_str40c, &rates, NULL);
+        assert_int("status", "t_integer", status, JSON_ERR_MISC);
+        assert_string1("compress", rates.compress, "");
+        assert_real("tpvinterval", rates.interval[RATE_TPV], 0);
+        break;
+
+    case 41:
+        assert_other("PRN 300 is PRN 44",
+                     json_sat_id("{\"PRN\":300}") ==
+                     json_sat_id("{\"PRN\":44}"), 0);
+        assert_other("sigid 16 is sigid 0",
+                     json_sat_id("{\"PRN\":300,\"sigid\":16}") ==
+                     json_sat_id("{\"PRN\":300,\"sigid\":0}"), 0);
+
+        gpsdata.privdata = calloc(1, sizeof(struct privdata_t));
+        if (NULL == gpsdata.privdata) {
+            exit(EXIT_FAILURE);
+        }
+        status = libgps_json_unpack(json_str41a, &gpsdata, NULL);
+        assert_case(status);
+        status = libgps_json_unpack(json_str41b, &gpsdata, NULL);
+        assert_case(status);
+        assert_int("satellites", "t_integer", gpsdata.satellites_visible, 2);
+        assert_int("PRN[0]", "t_short", gpsdata.skyview[0].PRN, 300);
+        assert_int("sigid[0]", "t_ubyte", gpsdata.skyview[0].sigid, 0);
+        assert_real("ss[0]", gpsdata.skyview[0].ss, 30);
+        assert_int("PRN[1]", "t_short", gpsdata.skyview[1].PRN, 300);
+        assert_int("sigid[1]", "t_ubyte", gpsdata.skyview[1].sigid, 16);
+        assert_real("ss[1]", gpsdata.skyview[1].ss, 45);
+        free(gpsdata.privdata);
+        gpsdata.privdata = NULL;
+        break;
+
+#define MAXTEST 41
 
     default:
         (void)fputs("Unknown test number\n", stderr);
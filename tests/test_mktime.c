@@ -1,6 +1,6 @@
 /*
  * tests for mktime(), mkgmtime(), timespec_to_iso8601() and
- * iso8601_to_timespec().
+ * iso8601_to_timespec(), the last two also against plain libc versions.
  * mktime() is a libc function, why test it?
  *
  * This file is Copyright 2010 by the GPSD project
@@ -19,6 +19,7 @@
 
 #include "../include/gps.h"
 #include "../include/compiler.h"
+#include "../include/os_compat.h"         // for strlcpy()
 #include "../include/timespec.h"
 
 static struct
@@ -190,6 +191,198 @@ static struct
 
 };
 
+/* The fast timespec_to_iso8601() and iso8601_to_timespec() must give
+ * exactly what the straightforward libc versions below give. */
+
+// timespec_to_iso8601() as it was, gmtime_r(), strftime(), snprintf()
+static char *ref_to_iso8601(timespec_t fixtime, char isotime[], size_t len)
+{
+    struct tm when;
+    char timestr[20];
+    int fracsec;
+
+    if (0 > fixtime.tv_sec) {
+        strlcpy(isotime, "NaN", len);
+        return isotime;
+    }
+    if (999499999 < fixtime.tv_nsec) {
+        fixtime.tv_sec++;
+        fixtime.tv_nsec = 0;
+    }
+#if 4 < SIZEOF_TIME_T
+    if (253402300799LL < fixtime.tv_sec) {
+        fixtime.tv_sec = 253402300799LL;
+    }
+#endif
+    (void)gmtime_r(&fixtime.tv_sec, &when);
+    // 0 to 999, as int to keep -Wformat-truncation quiet
+    fracsec = (int)((fixtime.tv_nsec + 500000) / 1000000) % 1000;
+    (void)strftime(timestr, sizeof(timestr), "%Y-%m-%dT%H:%M:%S", &when);
+    (void)snprintf(isotime, len, "%s.%03dZ", timestr, fracsec);
+    return isotime;
+}
+
+#ifdef HAVE_STRPTIME
+// iso8601_to_timespec() as it was, strptime(), strtod()
+static timespec_t ref_to_timespec(const char *isotime)
+{
+    timespec_t ret;
+    double usec = 0;
+    struct tm tm;
+    char *dp;
+
+    memset(&tm, 0, sizeof(tm));
+    dp = strptime(isotime, "%Y-%m-%dT%H:%M:%S", &tm);
+    if (NULL != dp &&
+        '.' == *dp) {
+        usec = strtod(dp, NULL);
+    }
+    ret.tv_sec = mkgmtime(&tm);
+    ret.tv_nsec = usec * 1e9;
+#if 4 < SIZEOF_TIME_T
+    if (253402300799LL < ret.tv_sec) {
+        ret.tv_sec = 253402300799LL;
+    }
+#endif
+    return ret;
+}
+
+// strings that should, or should not, take the parser's fast path
+static const char *tests2[] = {
+    "2018-11-09T12:34:56",
+    "2018-11-09T12:34:56Z",
+    "2018-11-09T12:34:56.Z",
+    "2018-11-09T12:34:56.1Z",
+    "2018-11-09T12:34:56.123Z",
+    "2018-11-09T12:34:56.999999999Z",
+    "2018-11-09T12:34:56.123456789012345Z",
+    "2018-11-09T12:34:56.1234567890123456Z",
+    "2018-11-09T12:34:56.5e-1Z",
+    "2018-11-09T12:34:60.000Z",
+    "2018-02-31T00:00:00.000Z",
+    "2000-02-29T23:59:59.999Z",
+    "1970-01-01T00:00:00.000Z",
+    "9999-12-31T23:59:59.999Z",
+    "2018-11-09 12:34:56.000Z",
+    "2018-1-09T12:34:56.000Z",
+    " 2018-11-09T12:34:56.000Z",
+    "2018-13-09T12:34:56.000Z",
+    "2018-11-09T24:34:56.000Z",
+    "2018-11-09T12:34",
+    "NaN",
+    "",
+};
+#endif  // HAVE_STRPTIME
+
+// next of a fixed pseudo random sequence, so failures repeat
+static unsigned long long lcg_next(unsigned long long *state)
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 11;
+}
+
+// compare fast and reference ISO8601 conversions, return true on failure
+static bool test_iso8601_fast(void)
+{
+    static const long nsecs[] = {
+        0, 1, 499999, 500000, 999999, 123456789, 998500000,
+        999499999, 999500000, 999999999};
+    static const time_t bases[] = {
+        0, 68169600, 951696000, 951782400, 1230767999, 2147483647,
+#if 4 < SIZEOF_TIME_T
+        4107456000LL, 4107542400LL, 253402300799LL,
+#endif
+    };
+    unsigned long long state = 1;
+    char fast[40], ref[40];
+    bool failed = false;
+    timespec_t ts;
+    size_t len;
+    int i, j;
+
+    // every few seconds around month, leap day and century turns
+    for (i = 0; i < (int)(sizeof(bases) / sizeof(bases[0])); i++) {
+        for (j = -90000; j < 90000; j += 7) {
+            ts.tv_sec = bases[i] + j;
+            ts.tv_nsec = nsecs[(unsigned)(j + 90000) %
+                               (sizeof(nsecs) / sizeof(nsecs[0]))];
+            (void)timespec_to_iso8601(ts, fast, sizeof(fast));
+            (void)ref_to_iso8601(ts, ref, sizeof(ref));
+            if (0 != strcmp(fast, ref)) {
+                failed = true;
+                (void)printf("test_mktime: timespec_to_iso8601(%lld.%09ld) "
+                             "got %s, s/b %s\n", (long long)ts.tv_sec,
+                             ts.tv_nsec, fast, ref);
+            }
+        }
+    }
+
+    // all over the range, back and forth so the cache gets no rest
+    for (i = 0; i < 200000; i++) {
+#if 4 < SIZEOF_TIME_T
+        ts.tv_sec = (time_t)(lcg_next(&state) % 253402300900ULL);
+#else
+        ts.tv_sec = (time_t)(lcg_next(&state) % 2147483648ULL);
+#endif
+        ts.tv_nsec = (long)(lcg_next(&state) % 1000000000ULL);
+        (void)timespec_to_iso8601(ts, fast, sizeof(fast));
+        (void)ref_to_iso8601(ts, ref, sizeof(ref));
+        if (0 != strcmp(fast, ref)) {
+            failed = true;
+            (void)printf("test_mktime: timespec_to_iso8601(%lld.%09ld) "
+                         "got %s, s/b %s\n", (long long)ts.tv_sec,
+                         ts.tv_nsec, fast, ref);
+        }
+#ifdef HAVE_STRPTIME
+        {
+            timespec_t got = iso8601_to_timespec(ref);
+            timespec_t want = ref_to_timespec(ref);
+
+            if (got.tv_sec != want.tv_sec ||
+                got.tv_nsec != want.tv_nsec) {
+                failed = true;
+                (void)printf("test_mktime: iso8601_to_timespec(%s) "
+                             "got %lld.%09ld, s/b %lld.%09ld\n", ref,
+                             (long long)got.tv_sec, got.tv_nsec,
+                             (long long)want.tv_sec, want.tv_nsec);
+            }
+        }
+#endif  // HAVE_STRPTIME
+    }
+
+    // short buffers truncate like snprintf()
+    ts.tv_sec = 1541766896L;
+    ts.tv_nsec = 999412000L;
+    for (len = 0; len < 27; len++) {
+        memset(fast, 'x', sizeof(fast));
+        memset(ref, 'x', sizeof(ref));
+        (void)timespec_to_iso8601(ts, fast, len);
+        (void)ref_to_iso8601(ts, ref, len);
+        if (0 != memcmp(fast, ref, sizeof(fast))) {
+            failed = true;
+            (void)printf("test_mktime: timespec_to_iso8601() len %zu "
+                         "got %.30s, s/b %.30s\n", len, fast, ref);
+        }
+    }
+
+#ifdef HAVE_STRPTIME
+    for (i = 0; i < (int)(sizeof(tests2) / sizeof(tests2[0])); i++) {
+        timespec_t got = iso8601_to_timespec(tests2[i]);
+        timespec_t want = ref_to_timespec(tests2[i]);
+
+        if (got.tv_sec != want.tv_sec ||
+            got.tv_nsec != want.tv_nsec) {
+            failed = true;
+            (void)printf("test_mktime: iso8601_to_timespec(\"%s\") "
+                         "got %lld.%09ld, s/b %lld.%09ld\n", tests2[i],
+                         (long long)got.tv_sec, got.tv_nsec,
+                         (long long)want.tv_sec, want.tv_nsec);
+        }
+    }
+#endif  // HAVE_STRPTIME
+    return failed;
+}
+
 int main(int argc UNUSED, char *argv[] UNUSED)
 {
     int i;
@@ -266,6 +459,10 @@ int main(int argc UNUSED, char *argv[] UNUSED)
         }
     }
 
+    if (test_iso8601_fast()) {
+        failed = true;
+    }
+
     return (int)failed;
 }
 
@@ -326,6 +326,119 @@ static void runon_test(struct map *mp)
     (void)close(nullfd);
 }
 
+/* AIS type 24 pairing, drivers/driver_ais.c.  MMSIs MAX_TYPE24_PENDING
+ * apart hash to the same slot.
+ */
+#define TYPE24_MMSI(n)  (244000000U + (n) * MAX_TYPE24_PENDING)
+
+static char type24_log[BUFSIZ];
+
+static void type24_report(const char *buf)
+{
+    (void)strlcat(type24_log, buf, sizeof(type24_log));
+}
+
+static bool type24_match(struct ais_type24_table_t *table,
+                         const struct gpsd_errout_t *errout,
+                         unsigned int mmsi, const char *want)
+{
+    char shipname[AIS_SHIPNAME_MAXLEN + 1];
+
+    if (!ais_type24a_match(errout, table, mmsi, shipname,
+                           sizeof(shipname))) {
+        return NULL == want;
+    }
+    return NULL != want && 0 == strcmp(shipname, want);
+}
+
+static int type24_test(void)
+{
+    static struct ais_type24_table_t table;
+    struct gpsd_errout_t errout = {0};
+    char name[AIS_SHIPNAME_MAXLEN + 1];
+    const char *legend[5];
+    bool ok[5];
+    int failure = 0;
+    int i;
+
+    errout_reset(&errout);
+    errout.debug = LOG_INF;
+    errout.report = type24_report;
+
+    // a 24B before its 24A finds nothing, the 24B after it does
+    memset(&table, 0, sizeof(table));
+    legend[0] = "24B before its 24A";
+    ok[0] = type24_match(&table, &errout, 244000001, NULL);
+    ais_type24a_stash(&errout, &table, 244000001, "EARLY B");
+    ok[0] = ok[0] &&
+            type24_match(&table, &errout, 244000001, "EARLY B") &&
+            1 == table.misses && 1 == table.hits;
+
+    // 24As from several ships, their 24Bs in another order
+    memset(&table, 0, sizeof(table));
+    legend[1] = "Interleaved MMSIs";
+    ais_type24a_stash(&errout, &table, 244000011, "ONE");
+    ais_type24a_stash(&errout, &table, 244000012, "TWO");
+    ais_type24a_stash(&errout, &table, 244000013, "THREE");
+    ok[1] = type24_match(&table, &errout, 244000012, "TWO") &&
+            type24_match(&table, &errout, 244000013, "THREE") &&
+            type24_match(&table, &errout, 244000011, "ONE") &&
+            // a repeated 24B does not match again
+            type24_match(&table, &errout, 244000011, NULL);
+
+    // ships sharing a home slot, 24Bs in reverse order
+    memset(&table, 0, sizeof(table));
+    legend[2] = "Colliding MMSIs";
+    for (i = 0; i < 3; i++) {
+        (void)snprintf(name, sizeof(name), "SHIP %d", i);
+        ais_type24a_stash(&errout, &table, TYPE24_MMSI(i), name);
+    }
+    ok[2] = true;
+    for (i = 2; i >= 0; i--) {
+        (void)snprintf(name, sizeof(name), "SHIP %d", i);
+        ok[2] = ok[2] && type24_match(&table, &errout, TYPE24_MMSI(i), name);
+    }
+
+    /* One more colliding 24A than the probe window holds: the oldest
+     * is dropped, the log says so, the others still match.
+     */
+    memset(&table, 0, sizeof(table));
+    type24_log[0] = '\0';
+    legend[3] = "Probe window full";
+    for (i = 0; i <= TYPE24_PROBE; i++) {
+        (void)snprintf(name, sizeof(name), "SHIP %d", i);
+        ais_type24a_stash(&errout, &table, TYPE24_MMSI(i), name);
+    }
+    ok[3] = 1 == table.evicted &&
+            NULL != strstr(type24_log,
+                           "consider a larger max_type24_pending") &&
+            type24_match(&table, &errout, TYPE24_MMSI(0), NULL);
+    for (i = 1; i <= TYPE24_PROBE; i++) {
+        (void)snprintf(name, sizeof(name), "SHIP %d", i);
+        ok[3] = ok[3] && type24_match(&table, &errout, TYPE24_MMSI(i), name);
+    }
+
+    // the same 24A twice takes one slot, not two
+    memset(&table, 0, sizeof(table));
+    legend[4] = "Repeated 24A";
+    for (i = 0; i < TYPE24_PROBE; i++) {
+        ais_type24a_stash(&errout, &table, TYPE24_MMSI(0), "OLD NAME");
+    }
+    ais_type24a_stash(&errout, &table, TYPE24_MMSI(0), "NEW NAME");
+    ok[4] = 0 == table.evicted &&
+            type24_match(&table, &errout, TYPE24_MMSI(0), "NEW NAME");
+
+    for (i = 0; i < 5; i++) {
+        if (ok[i]) {
+            printf("%2d: %s test succeeded.\n", i + 1, legend[i]);
+        } else {
+            printf("%2d: %s test FAILED.\n", i + 1, legend[i]);
+            ++failure;
+        }
+    }
+    return failure;
+}
+
 static int property_check(void)
 {
     const struct gps_type_t **dp;
@@ -428,6 +541,8 @@ int main(int argc, char *argv[])
             failcount += packet_test(mp);
         (void)fputs("=== EOF with buffer nonempty test ===\n", stdout);
         runon_test(&runontests[0]);
+        (void)fputs("=== AIS type 24 pairing tests ===\n", stdout);
+        failcount += type24_test();
     }
     exit(failcount > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
@@ -0,0 +1,191 @@
+#!/usr/bin/env python
+#
+# This code runs compatibly under Python 2 and 3.x for x >= 2.
+# Preserve this property!
+#
+# This file is Copyright by the GPSD project
+# SPDX-License-Identifier: BSD-2-clause
+
+"""Test the per-class report intervals of ?WATCH in the daemon.
+
+A gpsd, read-only so it sends no probes, reads NMEA fixes from a pty,
+ten a second.  One client watches them all, another asks for TPV at
+most once a second, and checks gpsd drops the TPVs in between.
+
+A client of the local data socket asks for "latest" and reads as the
+reports come, so each epoch's TPV goes out while its SKY may be unread.
+It must get the TPVs all the same.
+
+Then a client asks for "latest" and stops reading while a flood of
+fixes comes in.  It must not be dropped, must get only a small part
+of the flood, in whole lines, and once it reads again, fresh fixes.
+
+usage: test_watch_rate.py [path to gpsd]
+"""
+
+from __future__ import absolute_import, print_function, division
+
+import json
+import os
+import select
+import socket
+import sys
+import time
+
+from daemon_harness import Client, Daemon, fake_pty, nmea, rmc
+
+GPSD = sys.argv[1] if 1 < len(sys.argv) else 'gpsd/gpsd'
+EPOCHS = 40             # fixes sent after the daemon is up
+STEP = 0.1              # seconds between them
+INTERVAL = 1.0          # "tpvinterval" of the decimated client
+FLOOD = 2000            # fixes sent while the "latest" client stalls
+DATA_SOCKET = '%s/gpsd-watch-rate-%d.sock' % (os.environ.get('TMPDIR', '/tmp'),
+                                              os.getpid())
+GSA = nmea('GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1')
+
+
+def time_of(epoch):
+    """Return the TPV time of day, hh:mm:ss, of the fix at epoch."""
+    return '%02d:%02d:%02d' % (epoch // 3600 % 24, epoch // 60 % 60,
+                               epoch % 60)
+
+
+def watch(port, options):
+    """Return a Client sent ?WATCH with options."""
+    return Client(port, '?WATCH=%s;' % json.dumps(options))
+
+
+def main():
+    """Run it."""
+    errors = 0
+    device = fake_pty()
+
+    daemon = Daemon(GPSD)
+    daemon.start([device.byname], '-U ' + DATA_SOCKET)
+    try:
+        # input is flushed while gpsd settles the port, so feed fixes
+        # until a watcher sees one decoded
+        every = watch(daemon.port, {"enable": True, "json": True})
+        epoch = 43200
+        deadline = time.time() + 10
+        while time.time() < deadline and not every.reports('TPV'):
+            device.write(rmc(epoch))
+            epoch += 1
+            every.poll(0.2)
+        if not every.reports('TPV'):
+            print('watch_rate: gpsd decoded no fix')
+            sys.exit(1)
+
+        slow = watch(daemon.port, {"enable": True, "json": True,
+                                   "tpvinterval": INTERVAL})
+        time.sleep(0.5)
+        every.poll()
+        slow.poll()
+        before = len(every.reports('TPV'))
+        reply = slow.reports('WATCH')
+        if not reply or INTERVAL != reply[-1].get('tpvinterval'):
+            print('watch_rate: WATCH reply lacks the interval: %s' % reply)
+            errors += 1
+
+        start = time.time()
+        for _ in range(EPOCHS):
+            device.write(rmc(epoch))
+            epoch += 1
+            time.sleep(STEP)
+            every.poll()
+            slow.poll()
+        elapsed = time.time() - start
+        time.sleep(0.5)
+        every.poll()
+        slow.poll()
+
+        seen = len(every.reports('TPV')) - before
+        kept = len(slow.reports('TPV'))
+        # one at start, then one per interval
+        most = int(elapsed / INTERVAL) + 2
+        if EPOCHS * 3 // 4 > seen:
+            print('watch_rate: %d of %d fixes reported' % (seen, EPOCHS))
+            errors += 1
+        if 1 > kept or most < kept:
+            print('watch_rate: %d TPV at tpvinterval %.1f over %.1fs, '
+                  'want 1 to %d' % (kept, INTERVAL, elapsed, most))
+            errors += 1
+        if not slow.reports('DEVICES'):
+            print('watch_rate: notices dropped with the TPVs')
+            errors += 1
+        slow.close()
+
+        local = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+        local.connect(DATA_SOCKET)
+        local.sendall(b'?WATCH={"enable":true,"json":true,"latest":true};')
+        time.sleep(0.5)
+        every.poll()
+        before = len(every.reports('TPV'))
+        local_tpv = 0
+        for _ in range(EPOCHS):
+            # SKY, then TPV
+            device.write(GSA + rmc(epoch))
+            epoch += 1
+            deadline = time.time() + STEP
+            while time.time() < deadline:
+                ready, _, _ = select.select([local], [], [],
+                                            deadline - time.time())
+                if ready:
+                    local_tpv += local.recv(65536).count(b'"TPV"')
+            every.poll()
+        every.poll(0.5)
+        seen = len(every.reports('TPV')) - before
+        if seen * 3 // 4 > local_tpv:
+            print('watch_rate: "latest" on the data socket got %d TPV, '
+                  'a plain watcher %d' % (local_tpv, seen))
+            errors += 1
+        local.close()
+
+        stalled = watch(daemon.port, {"enable": True, "json": True,
+                                      "latest": True})
+        # a small receive buffer, so the stall reaches gpsd soon
+        stalled.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+        time.sleep(0.5)
+        stalled.poll()
+        stalled.objects = []
+        for _ in range(FLOOD // 50):
+            for _ in range(50):
+                device.write(rmc(epoch))
+                epoch += 1
+            time.sleep(0.05)
+            every.poll()
+        every.poll(0.5)
+        # it reads all it was sent, then fixes after the flood come
+        while stalled.waiting(0.5):
+            stalled.poll()
+        flooded = len(stalled.reports('TPV'))
+        after = set()
+        fresh = []
+        deadline = time.time() + 10
+        while time.time() < deadline and not fresh:
+            after.add(time_of(epoch))
+            device.write(rmc(epoch))
+            epoch += 1
+            stalled.poll(0.2)
+            fresh = [tpv for tpv in stalled.reports('TPV')[flooded:]
+                     if tpv.get('time', '')[11:19] in after]
+        if FLOOD // 4 < flooded:
+            print('watch_rate: "latest" client got %d of %d flooded fixes'
+                  % (flooded, FLOOD))
+            errors += 1
+        if not fresh:
+            print('watch_rate: "latest" client got no fix after the flood')
+            errors += 1
+    finally:
+        daemon.kill()
+
+    if errors:
+        print('test_watch_rate.py: %d errors' % errors)
+        sys.exit(1)
+    sys.exit(0)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4